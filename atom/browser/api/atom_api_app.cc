@@ -34,9 +34,13 @@
 #include "base/files/file_util.h"
 #include "base/path_service.h"
 #include "base/strings/string_util.h"
+#include "base/sys_info.h"
 #include "brave/browser/brave_content_browser_client.h"
 #include "brave/common/workers/v8_worker_thread.h"
 #include "brave/common/workers/worker_bindings.h"
+#include "brave/common/workers/worker_channel.h"
+#include "brave/common/workers/worker_message.h"
+#include "brave/common/workers/worker_pool.h"
 #include "brightray/browser/brightray_paths.h"
 #include "chrome/browser/browser_process_impl.h"
 #include "chrome/common/chrome_paths.h"
@@ -51,6 +55,8 @@
 #include "content/public/browser/navigation_details.h"
 #include "content/public/browser/notification_service.h"
 #include "content/public/browser/render_frame_host.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/render_view_host.h"
 #include "content/public/common/content_switches.h"
 #include "extensions/features/features.h"
 #include "native_mate/dictionary.h"
@@ -507,7 +513,7 @@ int ImportIntoCertStore(
 
 }  // namespace
 
-App::App(v8::Isolate* isolate) {
+App::App(v8::Isolate* isolate) : next_worker_pool_id_(1) {
   static_cast<brave::BraveContentBrowserClient*>(
     brave::BraveContentBrowserClient::Get())->set_delegate(this);
   atom::Browser::Get()->AddObserver(this);
@@ -577,6 +583,10 @@ void App::OnQuit() {
   int exitCode = AtomBrowserMainParts::Get()->GetExitCode();
   Emit("quit", exitCode);
 
+  for (const auto& pool : worker_pools_)
+    pool.second->Stop();
+  worker_pools_.clear();
+
   content::WorkerThreadRegistry::Instance()->PostTaskToAllThreads(
     base::Bind(&brave::V8WorkerThread::Shutdown));
 
@@ -832,8 +842,11 @@ void App::SendMemoryPressureAlert() {
 void App::PostMessage(int worker_id,
                       v8::Local<v8::Value> message,
                       mate::Arguments* args) {
-  if (!brave::WorkerBindings::OnMessage(isolate(), worker_id, message))
-    args->ThrowError("Eror serializing message");
+  v8::Local<v8::Value> transfer_list;
+  args->GetNext(&transfer_list);
+  // Throws if |message| can't be cloned.
+  brave::WorkerBindings::OnMessage(isolate(), worker_id, message,
+                                   transfer_list);
 }
 
 void App::StopWorker(mate::Arguments* args) {
@@ -858,13 +871,135 @@ void App::StartWorker(mate::Arguments* args) {
   std::string worker_name = module_name + "_worker";
   args->GetNext(&worker_name);
 
+  base::FilePath code_cache_path;
+  args->GetNext(&code_cache_path);
+
   auto worker = new brave::V8WorkerThread(worker_name, module_name, this);
+  worker->set_code_cache_path(code_cache_path);
   int worker_id = -1;
   if (worker->Start())
     worker_id = worker->GetThreadId();
   args->Return(worker_id);
 }
 
+int App::StartWorkerPool(mate::Arguments* args) {
+  std::string module_name;
+  if (!args->GetNext(&module_name)) {
+    args->ThrowError("`module_name` is a required field");
+    return -1;
+  }
+
+  // A size of 0 starts one worker per core.
+  int size = 0;
+  args->GetNext(&size);
+  if (size < 0) {
+    args->ThrowError("`size` must not be negative");
+    return -1;
+  }
+  if (size == 0)
+    size = base::SysInfo::NumberOfProcessors();
+
+  int max_queue_depth = 0;
+  args->GetNext(&max_queue_depth);
+  if (max_queue_depth < 0) {
+    args->ThrowError("`maxQueueDepth` must not be negative");
+    return -1;
+  }
+
+  base::FilePath code_cache_path;
+  args->GetNext(&code_cache_path);
+
+  scoped_refptr<brave::WorkerPool> pool(new brave::WorkerPool(
+      module_name, size, max_queue_depth, this));
+  pool->set_code_cache_path(code_cache_path);
+  if (!pool->Start())
+    return -1;
+
+  int pool_id = next_worker_pool_id_++;
+  worker_pools_[pool_id] = pool;
+  return pool_id;
+}
+
+bool App::PostPoolMessage(int pool_id,
+                          v8::Local<v8::Value> message,
+                          mate::Arguments* args) {
+  auto it = worker_pools_.find(pool_id);
+  if (it == worker_pools_.end())
+    return false;
+
+  v8::Local<v8::Value> transfer_list;
+  args->GetNext(&transfer_list);
+  auto data = brave::WorkerMessage::Create(isolate(), message, transfer_list);
+  if (!data)
+    return false;
+  return it->second->PostMessage(std::move(data));
+}
+
+v8::Local<v8::Value> App::GetWorkerPoolStats(int pool_id) {
+  auto it = worker_pools_.find(pool_id);
+  if (it == worker_pools_.end())
+    return v8::Null(isolate());
+
+  brave::WorkerPool::Stats stats = it->second->GetStats();
+  auto dict = mate::Dictionary::CreateEmpty(isolate());
+  dict.Set("queued", static_cast<double>(stats.queued));
+  dict.Set("running", static_cast<double>(stats.running));
+  dict.Set("completed", static_cast<double>(stats.completed));
+  dict.Set("stolen", static_cast<double>(stats.stolen));
+  dict.Set("rejected", static_cast<double>(stats.rejected));
+  dict.Set("workers", static_cast<double>(stats.workers));
+  dict.Set("idleWorkers", static_cast<double>(stats.idle_workers));
+  return dict.GetHandle();
+}
+
+std::vector<int> App::GetWorkerPoolWorkers(int pool_id) {
+  std::vector<int> worker_ids;
+  auto it = worker_pools_.find(pool_id);
+  if (it == worker_pools_.end())
+    return worker_ids;
+
+  for (auto thread_id : it->second->GetWorkerIds())
+    worker_ids.push_back(static_cast<int>(thread_id));
+  return worker_ids;
+}
+
+void App::StopWorkerPool(int pool_id) {
+  auto it = worker_pools_.find(pool_id);
+  if (it == worker_pools_.end())
+    return;
+
+  it->second->Stop();
+  worker_pools_.erase(it);
+}
+
+int App::CreateMessageChannel(mate::Arguments* args) {
+  std::vector<brave::WorkerChannelRegistry::Endpoint> ends;
+  for (int i = 0; i < 2; ++i) {
+    int worker_id;
+    WebContents* web_contents = nullptr;
+    if (args->GetNext(&worker_id)) {
+      ends.push_back(
+          brave::WorkerChannelRegistry::Endpoint::ForWorker(worker_id));
+    } else if (args->GetNext(&web_contents) && web_contents &&
+               web_contents->web_contents()) {
+      content::WebContents* contents = web_contents->web_contents();
+      ends.push_back(brave::WorkerChannelRegistry::Endpoint::ForRenderer(
+          contents->GetRenderProcessHost()->GetID(),
+          contents->GetRenderViewHost()->GetRoutingID()));
+    } else {
+      args->ThrowError("A worker id or webContents is required for each end");
+      return -1;
+    }
+  }
+
+  return brave::WorkerChannelRegistry::GetInstance()->Connect(ends[0],
+                                                              ends[1]);
+}
+
+void App::CloseMessageChannel(int channel_id) {
+  brave::WorkerChannelRegistry::GetInstance()->Close(channel_id);
+}
+
 #if defined(USE_NSS_CERTS)
 void App::ImportCertificate(
     const base::DictionaryValue& options,
@@ -1027,6 +1162,13 @@ void App::BuildPrototype(
       .SetMethod("_postMessage", &App::PostMessage)
       .SetMethod("_startWorker", &App::StartWorker)
       .SetMethod("stopWorker", &App::StopWorker)
+      .SetMethod("_startWorkerPool", &App::StartWorkerPool)
+      .SetMethod("_postPoolMessage", &App::PostPoolMessage)
+      .SetMethod("_getWorkerPoolStats", &App::GetWorkerPoolStats)
+      .SetMethod("_getWorkerPoolWorkers", &App::GetWorkerPoolWorkers)
+      .SetMethod("_stopWorkerPool", &App::StopWorkerPool)
+      .SetMethod("_createMessageChannel", &App::CreateMessageChannel)
+      .SetMethod("closeMessageChannel", &App::CloseMessageChannel)
       .SetMethod("disableHardwareAcceleration",
                  &App::DisableHardwareAcceleration);
 }
@@ -5,13 +5,16 @@
 #ifndef ATOM_BROWSER_API_ATOM_API_APP_H_
 #define ATOM_BROWSER_API_ATOM_API_APP_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "atom/browser/api/event_emitter.h"
 #include "atom/browser/atom_browser_client.h"
 #include "atom/browser/browser_observer.h"
 #include "atom/common/native_mate_converters/callback.h"
+#include "base/memory/ref_counted.h"
 #include "chrome/browser/process_singleton.h"
 #include "content/public/browser/gpu_data_manager_observer.h"
 #include "content/public/browser/notification_observer.h"
@@ -28,6 +31,10 @@ namespace base {
 class FilePath;
 }
 
+namespace brave {
+class WorkerPool;
+}
+
 namespace mate {
 class Arguments;
 }  // namespace mate
@@ -140,6 +147,15 @@ class App : public AtomBrowserClient::Delegate,
                   mate::Arguments* args);
   void StartWorker(mate::Arguments* args);
   void StopWorker(mate::Arguments* args);
+  int StartWorkerPool(mate::Arguments* args);
+  bool PostPoolMessage(int pool_id,
+                       v8::Local<v8::Value> message,
+                       mate::Arguments* args);
+  v8::Local<v8::Value> GetWorkerPoolStats(int pool_id);
+  std::vector<int> GetWorkerPoolWorkers(int pool_id);
+  void StopWorkerPool(int pool_id);
+  int CreateMessageChannel(mate::Arguments* args);
+  void CloseMessageChannel(int channel_id);
 #if defined(USE_NSS_CERTS)
   void ImportCertificate(const base::DictionaryValue& options,
                          const net::CompletionCallback& callback);
@@ -157,6 +173,9 @@ class App : public AtomBrowserClient::Delegate,
 
   std::unique_ptr<ProcessSingleton> process_singleton_;
 
+  std::map<int, scoped_refptr<brave::WorkerPool>> worker_pools_;
+  int next_worker_pool_id_;
+
 #if defined(USE_NSS_CERTS)
   std::unique_ptr<CertificateManagerModel> certificate_manager_model_;
 #endif
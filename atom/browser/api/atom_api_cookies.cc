@@ -2,10 +2,14 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
-#include <memory>
-
 #include "atom/browser/api/atom_api_cookies.h"
 
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "atom/browser/atom_browser_context.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/gurl_converter.h"
@@ -64,41 +68,98 @@ namespace api {
 
 namespace {
 
-// Returns whether |domain| matches |filter|.
-bool MatchesDomain(std::string filter, const std::string& domain) {
-  // Add a leading '.' character to the filter domain if it doesn't exist.
-  if (net::cookie_util::DomainIsHostOnly(filter))
-    filter.insert(0, ".");
+// A cookie filter from JS, converted once so that matching it against the
+// cookies of a large jar doesn't go through base::Value or allocate.
+struct CookieFilter {
+  CookieFilter()
+      : has_name(false),
+        has_path(false),
+        has_secure(false),
+        secure(false),
+        has_session(false),
+        session(false) {}
+
+  GURL url;
+  bool has_name;
+  std::string name;
+  bool has_path;
+  std::string path;
+  bool has_secure;
+  bool secure;
+  bool has_session;
+  bool session;
+  // Domains without the leading '.', a cookie matches if its domain is one
+  // of them or a subdomain of one.
+  std::unordered_set<std::string> domains;
+};
 
-  std::string sub_domain(domain);
-  // Strip any leading '.' character from the input cookie domain.
-  if (!net::cookie_util::DomainIsHostOnly(sub_domain))
-    sub_domain = sub_domain.substr(1);
+void AddFilterDomain(std::string domain, CookieFilter* filter) {
+  if (!domain.empty() && domain[0] == '.')
+    domain.erase(0, 1);
+  filter->domains.insert(domain);
+}
+
+// |filter| is the dictionary passed to get() and removeMatching(), the
+// domain can also be an array of domains.
+std::unique_ptr<CookieFilter> ParseCookieFilter(
+    const base::DictionaryValue& filter) {
+  std::unique_ptr<CookieFilter> result(new CookieFilter);
+  std::string url;
+  if (filter.GetString("url", &url) && !url.empty())
+    result->url = GURL(url);
+  result->has_name = filter.GetString("name", &result->name);
+  result->has_path = filter.GetString("path", &result->path);
+  result->has_secure = filter.GetBoolean("secure", &result->secure);
+  result->has_session = filter.GetBoolean("session", &result->session);
+
+  std::string domain;
+  const base::ListValue* domains = nullptr;
+  if (filter.GetString("domain", &domain)) {
+    AddFilterDomain(domain, result.get());
+  } else if (filter.GetList("domain", &domains)) {
+    for (size_t i = 0; i < domains->GetSize(); ++i) {
+      if (domains->GetString(i, &domain))
+        AddFilterDomain(domain, result.get());
+    }
+    // An empty list matches nothing rather than everything.
+    if (result->domains.empty())
+      result->domains.insert(std::string());
+  }
+  return result;
+}
 
-  // Now check whether the domain argument is a subdomain of the filter domain.
-  for (sub_domain.insert(0, "."); sub_domain.length() >= filter.length();) {
-    if (sub_domain == filter)
+// Returns whether |domain| or one of its parent domains is in |domains|.
+// |scratch| is reused between calls to avoid allocating for every cookie.
+bool MatchesDomain(const std::unordered_set<std::string>& domains,
+                   const std::string& domain,
+                   std::string* scratch) {
+  size_t start = (!domain.empty() && domain[0] == '.') ? 1 : 0;
+  while (start < domain.size()) {
+    scratch->assign(domain, start, std::string::npos);
+    if (domains.count(*scratch))
       return true;
-    const size_t next_dot = sub_domain.find('.', 1);  // Skip over leading dot.
-    sub_domain.erase(0, next_dot);
+    size_t next_dot = domain.find('.', start);
+    if (next_dot == std::string::npos)
+      break;
+    start = next_dot + 1;
   }
   return false;
 }
 
 // Returns whether |cookie| matches |filter|.
-bool MatchesCookie(const base::DictionaryValue* filter,
-                   const net::CanonicalCookie& cookie) {
-  std::string str;
-  bool b;
-  if (filter->GetString("name", &str) && str != cookie.Name())
+bool MatchesCookie(const CookieFilter& filter,
+                   const net::CanonicalCookie& cookie,
+                   std::string* scratch) {
+  if (filter.has_name && filter.name != cookie.Name())
     return false;
-  if (filter->GetString("path", &str) && str != cookie.Path())
+  if (filter.has_path && filter.path != cookie.Path())
     return false;
-  if (filter->GetString("domain", &str) && !MatchesDomain(str, cookie.Domain()))
+  if (filter.has_secure && filter.secure != cookie.IsSecure())
     return false;
-  if (filter->GetBoolean("secure", &b) && b != cookie.IsSecure())
+  if (filter.has_session && filter.session == cookie.IsPersistent())
     return false;
-  if (filter->GetBoolean("session", &b) && b != !cookie.IsPersistent())
+  if (!filter.domains.empty() &&
+      !MatchesDomain(filter.domains, cookie.Domain(), scratch))
     return false;
   return true;
 }
@@ -114,13 +175,64 @@ void RunCallbackInUI(const base::Closure& callback) {
   BrowserThread::PostTask(BrowserThread::UI, FROM_HERE, callback);
 }
 
+// Collects the results of a batch of cookie operations on the IO thread.
+// Every operation holds a reference, the results are passed to the UI thread
+// once the last one is done.
+class CookieBatch : public base::RefCountedThreadSafe<CookieBatch> {
+ public:
+  explicit CookieBatch(const Cookies::BatchCallback& callback)
+      : callback_(callback),
+        count_(0) {}
+
+  void OnSet(int index, bool success) {
+    if (!success)
+      failed_.push_back(index);
+    else
+      count_++;
+  }
+
+  void OnDeleted(int num_deleted) {
+    count_ += num_deleted;
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<CookieBatch>;
+
+  ~CookieBatch() {
+    std::sort(failed_.begin(), failed_.end());
+    RunCallbackInUI(base::Bind(callback_,
+        failed_.empty() ? Cookies::SUCCESS : Cookies::FAILED,
+        count_, failed_));
+  }
+
+  Cookies::BatchCallback callback_;
+  int count_;
+  std::vector<int> failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(CookieBatch);
+};
+
+// Gets the cookies of |filter|'s url, or all cookies, and passes them to
+// |callback|.
+void GetCookiesForFilter(net::CookieStore* cookie_store,
+                         const CookieFilter& filter,
+                         const net::CookieStore::GetCookieListCallback&
+                             callback) {
+  // Empty url will match all url cookies.
+  if (filter.url.is_empty())
+    cookie_store->GetAllCookiesAsync(callback);
+  else
+    cookie_store->GetAllCookiesForURLAsync(filter.url, callback);
+}
+
 // Remove cookies from |list| not matching |filter|, and pass it to |callback|.
-void FilterCookies(std::unique_ptr<base::DictionaryValue> filter,
+void FilterCookies(std::unique_ptr<CookieFilter> filter,
                    const Cookies::GetCallback& callback,
                    const net::CookieList& list) {
   net::CookieList result;
+  std::string scratch;
   for (const auto& cookie : list) {
-    if (MatchesCookie(filter.get(), cookie))
+    if (MatchesCookie(*filter, cookie, &scratch))
       result.push_back(cookie);
   }
   RunCallbackInUI(base::Bind(callback, Cookies::SUCCESS, result));
@@ -128,20 +240,11 @@ void FilterCookies(std::unique_ptr<base::DictionaryValue> filter,
 
 // Receives cookies matching |filter| in IO thread.
 void GetCookiesOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
-                    std::unique_ptr<base::DictionaryValue> filter,
+                    std::unique_ptr<CookieFilter> filter,
                     const Cookies::GetCallback& callback) {
-  std::string url;
-  filter->GetString("url", &url);
-
-  auto filtered_callback =
-      base::Bind(FilterCookies, base::Passed(&filter), callback);
-
-  // Empty url will match all url cookies.
-  if (url.empty())
-    GetCookieStore(getter)->GetAllCookiesAsync(filtered_callback);
-  else
-    GetCookieStore(getter)->GetAllCookiesForURLAsync(GURL(url),
-        filtered_callback);
+  const CookieFilter& filter_ref = *filter;
+  GetCookiesForFilter(GetCookieStore(getter), filter_ref,
+      base::Bind(FilterCookies, base::Passed(&filter), callback));
 }
 
 // Removes cookie with |url| and |name| in IO thread.
@@ -152,16 +255,69 @@ void RemoveCookieOnIOThread(scoped_refptr<net::URLRequestContextGetter> getter,
       url, name, base::Bind(RunCallbackInUI, callback));
 }
 
+// Deletes the cookies of |list| named |name|, which are the cookies
+// DeleteCookieAsync would delete, but reports how many were deleted.
+void DeleteNamedCookies(scoped_refptr<net::URLRequestContextGetter> getter,
+                        const std::string& name,
+                        scoped_refptr<CookieBatch> batch,
+                        const net::CookieList& list) {
+  net::CookieStore* cookie_store = GetCookieStore(getter);
+  for (const auto& cookie : list) {
+    if (cookie.Name() == name) {
+      cookie_store->DeleteCanonicalCookieAsync(cookie,
+          base::Bind(&CookieBatch::OnDeleted, batch));
+    }
+  }
+}
+
+// Removes the cookies of |cookies|, pairs of url and name, in IO thread.
+void RemoveCookiesOnIO(
+    scoped_refptr<net::URLRequestContextGetter> getter,
+    const std::vector<std::pair<GURL, std::string>>& cookies,
+    scoped_refptr<CookieBatch> batch) {
+  net::CookieStore* cookie_store = GetCookieStore(getter);
+  for (const auto& cookie : cookies) {
+    cookie_store->GetAllCookiesForURLAsync(cookie.first,
+        base::Bind(DeleteNamedCookies, getter, cookie.second, batch));
+  }
+}
+
+// Deletes the cookies of |list| matching |filter|.
+void DeleteMatchingCookies(scoped_refptr<net::URLRequestContextGetter> getter,
+                           std::unique_ptr<CookieFilter> filter,
+                           scoped_refptr<CookieBatch> batch,
+                           const net::CookieList& list) {
+  net::CookieStore* cookie_store = GetCookieStore(getter);
+  std::string scratch;
+  for (const auto& cookie : list) {
+    if (MatchesCookie(*filter, cookie, &scratch)) {
+      cookie_store->DeleteCanonicalCookieAsync(cookie,
+          base::Bind(&CookieBatch::OnDeleted, batch));
+    }
+  }
+}
+
+// Removes the cookies matching |filter| in IO thread.
+void RemoveMatchingCookiesOnIO(
+    scoped_refptr<net::URLRequestContextGetter> getter,
+    std::unique_ptr<CookieFilter> filter,
+    scoped_refptr<CookieBatch> batch) {
+  const CookieFilter& filter_ref = *filter;
+  GetCookiesForFilter(GetCookieStore(getter), filter_ref,
+      base::Bind(DeleteMatchingCookies, getter, base::Passed(&filter),
+                 batch));
+}
+
 // Callback of SetCookie.
 void OnSetCookie(const Cookies::SetCallback& callback, bool success) {
   RunCallbackInUI(
       base::Bind(callback, success ? Cookies::SUCCESS : Cookies::FAILED));
 }
 
-// Sets cookie with |details| in IO thread.
-void SetCookieOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
-                   std::unique_ptr<base::DictionaryValue> details,
-                   const Cookies::SetCallback& callback) {
+// Sets cookie with |details| in |cookie_store|.
+void SetCookieWithDetails(net::CookieStore* cookie_store,
+                          const base::DictionaryValue* details,
+                          const base::Callback<void(bool)>& callback) {
   std::string url, name, value, domain, path;
   bool secure = false;
   bool http_only = false;
@@ -197,11 +353,35 @@ void SetCookieOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
         base::Time::FromDoubleT(last_access_date);
   }
 
-  GetCookieStore(getter)->SetCookieWithDetailsAsync(
+  cookie_store->SetCookieWithDetailsAsync(
       GURL(url), name, value, domain, path, creation_time,
       expiration_time, last_access_time, secure, http_only,
       net::CookieSameSite::DEFAULT_MODE, false,
-      net::COOKIE_PRIORITY_DEFAULT, base::Bind(OnSetCookie, callback));
+      net::COOKIE_PRIORITY_DEFAULT, callback);
+}
+
+// Sets cookie with |details| in IO thread.
+void SetCookieOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
+                   std::unique_ptr<base::DictionaryValue> details,
+                   const Cookies::SetCallback& callback) {
+  SetCookieWithDetails(GetCookieStore(getter), details.get(),
+                       base::Bind(OnSetCookie, callback));
+}
+
+// Sets the cookies of |list| in IO thread.
+void SetCookiesOnIO(scoped_refptr<net::URLRequestContextGetter> getter,
+                    std::unique_ptr<base::ListValue> list,
+                    scoped_refptr<CookieBatch> batch) {
+  net::CookieStore* cookie_store = GetCookieStore(getter);
+  for (size_t i = 0; i < list->GetSize(); ++i) {
+    const base::DictionaryValue* details = nullptr;
+    if (!list->GetDictionary(i, &details)) {
+      batch->OnSet(static_cast<int>(i), false);
+      continue;
+    }
+    SetCookieWithDetails(cookie_store, details,
+        base::Bind(&CookieBatch::OnSet, batch, static_cast<int>(i)));
+  }
 }
 
 }  // namespace
@@ -217,11 +397,11 @@ Cookies::~Cookies() {
 
 void Cookies::Get(const base::DictionaryValue& filter,
                   const GetCallback& callback) {
-  std::unique_ptr<base::DictionaryValue> copied(filter.CreateDeepCopy());
+  std::unique_ptr<CookieFilter> parsed(ParseCookieFilter(filter));
   auto getter = base::RetainedRef(request_context_getter_);
   content::BrowserThread::PostTask(
       BrowserThread::IO, FROM_HERE,
-      base::Bind(GetCookiesOnIO, getter, Passed(&copied), callback));
+      base::Bind(GetCookiesOnIO, getter, Passed(&parsed), callback));
 }
 
 void Cookies::Remove(const GURL& url, const std::string& name,
@@ -241,6 +421,44 @@ void Cookies::Set(const base::DictionaryValue& details,
       base::Bind(SetCookieOnIO, getter, Passed(&copied), callback));
 }
 
+void Cookies::SetMany(const base::ListValue& details,
+                      const BatchCallback& callback) {
+  std::unique_ptr<base::ListValue> copied(details.CreateDeepCopy());
+  auto getter = base::RetainedRef(request_context_getter_);
+  content::BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(SetCookiesOnIO, getter, Passed(&copied),
+                 make_scoped_refptr(new CookieBatch(callback))));
+}
+
+void Cookies::RemoveMany(const base::ListValue& cookies,
+                         const BatchCallback& callback) {
+  std::vector<std::pair<GURL, std::string>> parsed;
+  for (size_t i = 0; i < cookies.GetSize(); ++i) {
+    const base::DictionaryValue* cookie = nullptr;
+    std::string url, name;
+    if (cookies.GetDictionary(i, &cookie) &&
+        cookie->GetString("url", &url) &&
+        cookie->GetString("name", &name))
+      parsed.push_back(std::make_pair(GURL(url), name));
+  }
+  auto getter = base::RetainedRef(request_context_getter_);
+  content::BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(RemoveCookiesOnIO, getter, parsed,
+                 make_scoped_refptr(new CookieBatch(callback))));
+}
+
+void Cookies::RemoveMatching(const base::DictionaryValue& filter,
+                             const BatchCallback& callback) {
+  std::unique_ptr<CookieFilter> parsed(ParseCookieFilter(filter));
+  auto getter = base::RetainedRef(request_context_getter_);
+  content::BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(RemoveMatchingCookiesOnIO, getter, Passed(&parsed),
+                 make_scoped_refptr(new CookieBatch(callback))));
+}
+
 // static
 mate::Handle<Cookies> Cookies::Create(
     v8::Isolate* isolate,
@@ -255,7 +473,10 @@ void Cookies::BuildPrototype(v8::Isolate* isolate,
   mate::ObjectTemplateBuilder(isolate, prototype->PrototypeTemplate())
       .SetMethod("get", &Cookies::Get)
       .SetMethod("remove", &Cookies::Remove)
-      .SetMethod("set", &Cookies::Set);
+      .SetMethod("set", &Cookies::Set)
+      .SetMethod("setMany", &Cookies::SetMany)
+      .SetMethod("removeMany", &Cookies::RemoveMany)
+      .SetMethod("removeMatching", &Cookies::RemoveMatching);
 }
 
 }  // namespace api
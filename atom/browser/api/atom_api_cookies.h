@@ -6,6 +6,7 @@
 #define ATOM_BROWSER_API_ATOM_API_COOKIES_H_
 
 #include <string>
+#include <vector>
 
 #include "atom/browser/api/trackable_object.h"
 #include "base/callback.h"
@@ -14,6 +15,7 @@
 
 namespace base {
 class DictionaryValue;
+class ListValue;
 }
 
 namespace net {
@@ -35,6 +37,10 @@ class Cookies : public mate::TrackableObject<Cookies> {
 
   using GetCallback = base::Callback<void(Error, const net::CookieList&)>;
   using SetCallback = base::Callback<void(Error)>;
+  // Called with the number of cookies set or removed, and the indices of the
+  // cookies that could not be set.
+  using BatchCallback =
+      base::Callback<void(Error, int, const std::vector<int>&)>;
 
   static mate::Handle<Cookies> Create(v8::Isolate* isolate,
                                       AtomBrowserContext* browser_context);
@@ -52,6 +58,13 @@ class Cookies : public mate::TrackableObject<Cookies> {
               const base::Closure& callback);
   void Set(const base::DictionaryValue& details, const SetCallback& callback);
 
+  // Batched versions of set and remove, each runs in a single IO task.
+  void SetMany(const base::ListValue& details, const BatchCallback& callback);
+  void RemoveMany(const base::ListValue& cookies,
+                  const BatchCallback& callback);
+  void RemoveMatching(const base::DictionaryValue& filter,
+                      const BatchCallback& callback);
+
  private:
   net::URLRequestContextGetter* request_context_getter_;
 
@@ -34,6 +34,25 @@ struct Converter<DesktopMediaList::Source> {
   }
 };
 
+template<>
+struct Converter<NativeDesktopMediaList::RefreshStats> {
+  static v8::Local<v8::Value> ToV8(
+      v8::Isolate* isolate,
+      const NativeDesktopMediaList::RefreshStats& stats) {
+    mate::Dictionary dict(isolate, v8::Object::New(isolate));
+    dict.Set("sources", stats.sources);
+    dict.Set("captured", stats.captured);
+    dict.Set("unchanged", stats.unchanged);
+    dict.Set("cached", stats.cached);
+    dict.Set("scaled", stats.scaled);
+    dict.Set("captureTime", stats.capture_time.InMillisecondsF());
+    dict.Set("hashTime", stats.hash_time.InMillisecondsF());
+    dict.Set("scaleTime", stats.scale_time.InMillisecondsF());
+    dict.Set("totalTime", stats.total_time.InMillisecondsF());
+    return ConvertToV8(isolate, dict);
+  }
+};
+
 }  // namespace mate
 
 namespace atom {
@@ -94,10 +113,17 @@ void DesktopCapturer::OnSourceThumbnailChanged(int index) {
 }
 
 bool DesktopCapturer::OnRefreshFinished() {
-  Emit("finished", media_list_->GetSources());
+  Emit("finished", media_list_->GetSources(),
+       media_list_->last_refresh_stats());
   return false;
 }
 
+NativeDesktopMediaList::RefreshStats DesktopCapturer::GetRefreshStats() const {
+  if (!media_list_)
+    return NativeDesktopMediaList::RefreshStats();
+  return media_list_->last_refresh_stats();
+}
+
 // static
 mate::Handle<DesktopCapturer> DesktopCapturer::Create(v8::Isolate* isolate) {
   return mate::CreateHandle(isolate, new DesktopCapturer(isolate));
@@ -108,7 +134,8 @@ void DesktopCapturer::BuildPrototype(
     v8::Isolate* isolate, v8::Local<v8::FunctionTemplate> prototype) {
   prototype->SetClassName(mate::StringToV8(isolate, "DesktopCapturer"));
   mate::ObjectTemplateBuilder(isolate, prototype->PrototypeTemplate())
-      .SetMethod("startHandling", &DesktopCapturer::StartHandling);
+      .SetMethod("startHandling", &DesktopCapturer::StartHandling)
+      .SetMethod("getRefreshStats", &DesktopCapturer::GetRefreshStats);
 }
 
 }  // namespace api
@@ -122,6 +149,8 @@ void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
   v8::Isolate* isolate = context->GetIsolate();
   mate::Dictionary dict(isolate, exports);
   dict.Set("desktopCapturer", atom::api::DesktopCapturer::Create(isolate));
+  dict.Set("DesktopCapturer", atom::api::DesktopCapturer::GetConstructor(
+      isolate)->GetFunction());
 }
 
 }  // namespace
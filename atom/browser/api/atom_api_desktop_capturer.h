@@ -28,6 +28,9 @@ class DesktopCapturer: public mate::EventEmitter<DesktopCapturer>,
                      bool capture_screen,
                      const gfx::Size& thumbnail_size);
 
+  // What the last refresh of the sources cost.
+  NativeDesktopMediaList::RefreshStats GetRefreshStats() const;
+
  protected:
   explicit DesktopCapturer(v8::Isolate* isolate);
   ~DesktopCapturer() override;
@@ -41,7 +44,7 @@ class DesktopCapturer: public mate::EventEmitter<DesktopCapturer>,
   bool OnRefreshFinished() override;
 
  private:
-  std::unique_ptr<DesktopMediaList> media_list_;
+  std::unique_ptr<NativeDesktopMediaList> media_list_;
 
   DISALLOW_COPY_AND_ASSIGN(DesktopCapturer);
 };
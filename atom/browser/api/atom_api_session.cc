@@ -4,6 +4,7 @@
 
 #include "atom/browser/api/atom_api_session.h"
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -58,6 +59,7 @@
 #include "ui/base/l10n/l10n_util.h"
 
 #if BUILDFLAG(ENABLE_EXTENSIONS)
+#include "atom/browser/extensions/atom_browser_client_extensions_part.h"
 #include "brave/browser/api/brave_api_extension.h"
 #include "extensions/browser/extensions_browser_client.h"
 #endif
@@ -489,6 +491,46 @@ void Session::SetPermissionRequestHandler(v8::Local<v8::Value> val,
   permission_manager->SetPermissionRequestHandler(handler);
 }
 
+void Session::SetPermissionCacheTTL(double ttl) {
+  auto permission_manager = static_cast<brave::BravePermissionManager*>(
+      browser_context()->GetPermissionManager());
+  permission_manager->SetDecisionCacheTTL(
+      base::TimeDelta::FromMillisecondsD(std::max(ttl, 0.0)));
+}
+
+void Session::ClearPermissionCache(mate::Arguments* args) {
+  GURL requesting_origin;
+  args->GetNext(&requesting_origin);
+  auto permission_manager = static_cast<brave::BravePermissionManager*>(
+      browser_context()->GetPermissionManager());
+  permission_manager->ClearDecisionCache(requesting_origin);
+}
+
+v8::Local<v8::Value> Session::GetPermissionCacheStats(v8::Isolate* isolate) {
+  auto permission_manager = static_cast<brave::BravePermissionManager*>(
+      browser_context()->GetPermissionManager());
+  brave::BravePermissionManager::CacheStats stats =
+      permission_manager->GetDecisionCacheStats();
+  mate::Dictionary dict = mate::Dictionary::CreateEmpty(isolate);
+  dict.Set("hits", static_cast<double>(stats.hits));
+  dict.Set("misses", static_cast<double>(stats.misses));
+  dict.Set("size", static_cast<double>(stats.size));
+  return dict.GetHandle();
+}
+
+v8::Local<v8::Value> Session::GetContentSettingsUpdateStats(
+    v8::Isolate* isolate) {
+  mate::Dictionary dict = mate::Dictionary::CreateEmpty(isolate);
+#if BUILDFLAG(ENABLE_EXTENSIONS)
+  extensions::AtomBrowserClientExtensionsPart::ContentSettingsUpdateStats
+      stats = extensions::AtomBrowserClientExtensionsPart::
+          GetContentSettingsUpdateStats(browser_context());
+  dict.Set("fullUpdates", stats.full_updates);
+  dict.Set("deltas", stats.deltas);
+#endif
+  return dict.GetHandle();
+}
+
 void Session::ClearHostResolverCache(mate::Arguments* args) {
   base::Closure callback;
   args->GetNext(&callback);
@@ -634,6 +676,11 @@ void Session::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("setCertificateVerifyProc", &Session::SetCertVerifyProc)
       .SetMethod("setPermissionRequestHandler",
                  &Session::SetPermissionRequestHandler)
+      .SetMethod("setPermissionCacheTTL", &Session::SetPermissionCacheTTL)
+      .SetMethod("clearPermissionCache", &Session::ClearPermissionCache)
+      .SetMethod("getPermissionCacheStats", &Session::GetPermissionCacheStats)
+      .SetMethod("getContentSettingsUpdateStats",
+                 &Session::GetContentSettingsUpdateStats)
       .SetMethod("clearHostResolverCache", &Session::ClearHostResolverCache)
       .SetMethod("allowNTLMCredentialsForDomains",
                  &Session::AllowNTLMCredentialsForDomains)
@@ -72,6 +72,10 @@ class Session: public mate::TrackableObject<Session>,
   void SetCertVerifyProc(v8::Local<v8::Value> proc, mate::Arguments* args);
   void SetPermissionRequestHandler(v8::Local<v8::Value> val,
                                    mate::Arguments* args);
+  void SetPermissionCacheTTL(double ttl);
+  void ClearPermissionCache(mate::Arguments* args);
+  v8::Local<v8::Value> GetPermissionCacheStats(v8::Isolate* isolate);
+  v8::Local<v8::Value> GetContentSettingsUpdateStats(v8::Isolate* isolate);
   void ClearHostResolverCache(mate::Arguments* args);
   void AllowNTLMCredentialsForDomains(const std::string& domains);
   std::string Partition();
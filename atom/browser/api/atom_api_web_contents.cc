@@ -27,6 +27,7 @@
 #include "atom/browser/web_contents_preferences.h"
 #include "atom/common/api/api_messages.h"
 #include "atom/common/api/event_emitter_caller.h"
+#include "atom/common/api/serialized_value.h"
 #include "atom/common/color_util.h"
 #include "atom/common/mouse_util.h"
 #include "atom/common/native_mate_converters/blink_converter.h"
@@ -1219,6 +1220,10 @@ bool WebContents::OnMessageReceived(const IPC::Message& message) {
     IPC_MESSAGE_HANDLER(AtomViewHostMsg_Message, OnRendererMessage)
     IPC_MESSAGE_HANDLER_DELAY_REPLY(AtomViewHostMsg_Message_Sync,
                                     OnRendererMessageSync)
+    IPC_MESSAGE_HANDLER(AtomViewHostMsg_Message_Serialized,
+                        OnRendererSerializedMessage)
+    IPC_MESSAGE_HANDLER_DELAY_REPLY(AtomViewHostMsg_Message_Serialized_Sync,
+                                    OnRendererSerializedMessageSync)
     IPC_MESSAGE_HANDLER_CODE(ViewHostMsg_SetCursor, OnCursorChange,
       handled = false)
     IPC_MESSAGE_UNHANDLED(handled = false)
@@ -1968,6 +1973,20 @@ bool WebContents::SendIPCMessage(bool all_frames,
   return Send(new AtomViewMsg_Message(routing_id(), all_frames, channel, args));
 }
 
+bool WebContents::SendIPCSerialized(mate::Arguments* args,
+                                    bool all_frames,
+                                    const base::string16& channel,
+                                    v8::Local<v8::Value> message) {
+  v8::Local<v8::Value> transfer_list;
+  args->GetNext(&transfer_list);
+  atom::SerializedValue serialized;
+  if (!atom::SerializeValue(isolate(), message, transfer_list, &serialized))
+    return false;
+
+  return Send(new AtomViewMsg_Message_Serialized(
+      routing_id(), all_frames, channel, serialized));
+}
+
 void WebContents::SendInputEvent(v8::Isolate* isolate,
                                  v8::Local<v8::Value> input_event) {
   const auto view = web_contents()->GetRenderWidgetHostView();
@@ -2292,6 +2311,7 @@ void WebContents::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("_clone", &WebContents::Clone)
       .SetMethod("_send", &WebContents::SendIPCMessage)
       .SetMethod("_sendShared", &WebContents::SendIPCSharedMemory)
+      .SetMethod("_postMessage", &WebContents::SendIPCSerialized)
       .SetMethod("sendInputEvent", &WebContents::SendInputEvent)
       .SetMethod("startDrag", &WebContents::StartDrag)
       .SetMethod("setSize", &WebContents::SetSize)
@@ -2378,6 +2398,40 @@ void WebContents::OnRendererMessageSync(const base::string16& channel,
   EmitWithSender(base::UTF16ToUTF8(channel), web_contents(), message, args);
 }
 
+void WebContents::OnRendererSerializedMessage(
+    const base::string16& channel,
+    const atom::SerializedValue& message) {
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  v8::Local<v8::Value> value;
+  if (!atom::DeserializeValue(isolate(), message).ToLocal(&value))
+    return;
+
+  // webContents.emit('ipc-post-message', new Event(), channel, message);
+  Emit("ipc-post-message", channel, value);
+}
+
+void WebContents::OnRendererSerializedMessageSync(
+    const base::string16& channel,
+    const atom::SerializedValue& message,
+    IPC::Message* reply_msg) {
+  v8::Locker locker(isolate());
+  v8::HandleScope handle_scope(isolate());
+  v8::Local<v8::Value> value;
+  if (!atom::DeserializeValue(isolate(), message).ToLocal(&value)) {
+    // don't leave the renderer waiting
+    AtomViewHostMsg_Message_Serialized_Sync::WriteReplyParams(
+        reply_msg, atom::SerializedValue());
+    Send(reply_msg);
+    return;
+  }
+
+  // webContents.emit('ipc-post-message-sync', new Event(sender, message),
+  //                  channel, message);
+  EmitWithSender("ipc-post-message-sync", web_contents(), reply_msg,
+                 channel, value);
+}
+
 // static
 mate::Handle<WebContents> WebContents::FromTabID(v8::Isolate* isolate,
     int tab_id) {
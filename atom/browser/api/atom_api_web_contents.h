@@ -95,6 +95,7 @@ struct SetSizeParams {
 };
 
 class AtomBrowserContext;
+struct SerializedValue;
 
 namespace api {
 
@@ -254,6 +255,10 @@ class WebContents : public mate::TrackableObject<WebContents>,
                       const base::ListValue& args);
   bool SendIPCSharedMemory(const base::string16& channel,
                             base::SharedMemory* shared_memory);
+  bool SendIPCSerialized(mate::Arguments* args,
+                         bool all_frames,
+                         const base::string16& channel,
+                         v8::Local<v8::Value> message);
 
   // Send WebInputEvent to the page.
   void SendInputEvent(v8::Isolate* isolate, v8::Local<v8::Value> input_event);
@@ -504,6 +509,13 @@ class WebContents : public mate::TrackableObject<WebContents>,
                              const base::ListValue& args,
                              IPC::Message* message);
 
+  // Called when received a structured clone message from renderer.
+  void OnRendererSerializedMessage(const base::string16& channel,
+                                   const SerializedValue& message);
+  void OnRendererSerializedMessageSync(const base::string16& channel,
+                                       const SerializedValue& message,
+                                       IPC::Message* reply_msg);
+
   v8::Global<v8::Value> session_;
   v8::Global<v8::Value> devtools_web_contents_;
   v8::Global<v8::Value> debugger_;
@@ -4,6 +4,8 @@
 
 #include "atom/browser/api/atom_api_web_request.h"
 
+#include <vector>
+
 #include "atom/browser/atom_browser_context.h"
 #include "atom/browser/net/atom_network_delegate.h"
 #include "atom/common/native_mate_converters/callback.h"
@@ -58,12 +60,78 @@ struct Converter<net::URLFetcher::RequestType> {
   }
 };
 
+template<>
+struct Converter<atom::AtomNetworkDelegate::DeclarativeRule> {
+  static bool FromV8(v8::Isolate* isolate, v8::Local<v8::Value> val,
+                     atom::AtomNetworkDelegate::DeclarativeRule* out) {
+    mate::Dictionary dict;
+    if (!ConvertFromV8(isolate, val, &dict))
+      return false;
+
+    dict.Get("id", &out->id);
+    // Without patterns a rule applies to every URL, so a rule whose patterns
+    // don't parse must not be taken as one.
+    if (dict.Has("urls")) {
+      atom::URLPatterns patterns;
+      if (!dict.Get("urls", &patterns))
+        return false;
+      out->url_patterns = atom::URLPatternMatcher(patterns);
+    }
+    dict.Get("cancel", &out->cancel);
+    dict.Get("redirectURL", &out->redirect_url);
+
+    base::DictionaryValue headers;
+    if (dict.Get("requestHeaders", &headers)) {
+      for (base::DictionaryValue::Iterator it(headers); !it.IsAtEnd();
+           it.Advance()) {
+        std::string value;
+        if (it.value().GetAsString(&value))
+          out->set_request_headers[it.key()] = value;
+      }
+    }
+    dict.Get("removeRequestHeaders", &out->remove_request_headers);
+
+    // A rule has to decide something.
+    return out->cancel || out->redirect_url.is_valid() ||
+           !out->set_request_headers.empty() ||
+           !out->remove_request_headers.empty();
+  }
+};
+
 }  // namespace mate
 
 namespace atom {
 
 namespace api {
 
+namespace {
+
+AtomNetworkDelegate* GetNetworkDelegate(
+    const scoped_refptr<net::URLRequestContextGetter>& getter) {
+  return static_cast<AtomNetworkDelegate*>(
+      getter->GetURLRequestContext()->network_delegate());
+}
+
+void SetRulesOnIOThread(
+    const scoped_refptr<net::URLRequestContextGetter>& getter,
+    const std::vector<AtomNetworkDelegate::DeclarativeRule>& rules) {
+  GetNetworkDelegate(getter)->SetDeclarativeRulesInIO(rules);
+}
+
+void GetRuleHitsOnIOThread(
+    const scoped_refptr<net::URLRequestContextGetter>& getter,
+    const AtomNetworkDelegate::RuleHitsCallback& callback) {
+  GetNetworkDelegate(getter)->GetDeclarativeRuleHitsInIO(callback);
+}
+
+void RunRuleHitsCallback(
+    const base::Callback<void(const base::DictionaryValue&)>& callback,
+    std::unique_ptr<base::DictionaryValue> hits) {
+  callback.Run(*hits);
+}
+
+}  // namespace
+
 WebRequest::WebRequest(v8::Isolate* isolate,
                        AtomBrowserContext* browser_context)
     : browser_context_(browser_context) {
@@ -161,20 +229,35 @@ void WebRequest::SetResponseListener(mate::Arguments* args) {
 template<typename Listener, typename Method, typename Event>
 void WebRequest::SetListenerOnIOThread(
     const scoped_refptr<net::URLRequestContextGetter>& getter,
-    Method method, Event type, URLPatterns patterns, Listener listener) {
+    Method method, Event type, URLPatterns patterns,
+    const AtomNetworkDelegate::ListenerOptions& options,
+    Listener listener) {
   auto delegate = static_cast<AtomNetworkDelegate*>(
       getter->GetURLRequestContext()->network_delegate());
   BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
                             base::Bind(method, base::Unretained(delegate),
-                            type, patterns, listener));
+                            type, patterns, options, listener));
 }
 
 template<typename Listener, typename Method, typename Event>
 void WebRequest::SetListener(Method method, Event type, mate::Arguments* args) {
-  // { urls }.
+  // { urls, fields, batchInterval }.
   URLPatterns patterns;
+  AtomNetworkDelegate::ListenerOptions options;
   mate::Dictionary dict;
-  args->GetNext(&dict) && dict.Get("urls", &patterns);
+  if (args->GetNext(&dict)) {
+    dict.Get("urls", &patterns);
+    std::vector<std::string> fields;
+    if (dict.Get("fields", &fields) &&
+        !AtomNetworkDelegate::ParseDetailsFields(fields, &options.fields)) {
+      args->ThrowError("Unknown field in filter.fields");
+      return;
+    }
+    int batch_interval = 0;
+    if (dict.Get("batchInterval", &batch_interval) && batch_interval > 0)
+      options.batch_interval =
+          base::TimeDelta::FromMilliseconds(batch_interval);
+  }
 
   // Function or null.
   v8::Local<v8::Value> value;
@@ -190,7 +273,38 @@ void WebRequest::SetListener(Method method, Event type, mate::Arguments* args) {
         base::Unretained(this),
         scoped_refptr<net::URLRequestContextGetter>(
           browser_context_->GetRequestContext()),
-          method, type, patterns, listener));
+          method, type, patterns, options, listener));
+}
+
+void WebRequest::SetRules(mate::Arguments* args) {
+  // Array of rules or null.
+  std::vector<AtomNetworkDelegate::DeclarativeRule> rules;
+  v8::Local<v8::Value> value;
+  if (!args->GetNext(&rules) &&
+      !(args->GetNext(&value) && value->IsNull())) {
+    args->ThrowError("Must pass null or an Array of rules");
+    return;
+  }
+
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&SetRulesOnIOThread,
+        scoped_refptr<net::URLRequestContextGetter>(
+          browser_context_->GetRequestContext()),
+        rules));
+}
+
+void WebRequest::GetRuleHitCounts(mate::Arguments* args) {
+  base::Callback<void(const base::DictionaryValue&)> callback;
+  if (!args->GetNext(&callback)) {
+    args->ThrowError("Must pass a Function");
+    return;
+  }
+
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&GetRuleHitsOnIOThread,
+        scoped_refptr<net::URLRequestContextGetter>(
+          browser_context_->GetRequestContext()),
+        base::Bind(&RunRuleHitsCallback, callback)));
 }
 
 void WebRequest::HandleBehaviorChanged() {
@@ -236,6 +350,10 @@ void WebRequest::BuildPrototype(v8::Isolate* isolate,
       .SetMethod("onErrorOccurred",
                  &WebRequest::SetSimpleListener<
                     AtomNetworkDelegate::kOnErrorOccurred>)
+      .SetMethod("setRules",
+                 &WebRequest::SetRules)
+      .SetMethod("getRuleHitCounts",
+                 &WebRequest::GetRuleHitCounts)
       .SetMethod("handleBehaviorChanged",
                  &WebRequest::HandleBehaviorChanged)
       .SetMethod("fetch",
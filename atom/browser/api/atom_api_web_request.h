@@ -109,10 +109,16 @@ class WebRequest : public mate::TrackableObject<WebRequest>,
   void SetListenerOnIOThread(
       const scoped_refptr<net::URLRequestContextGetter>& request_context,
       Method method, Event type,
-      URLPatterns patterns, Listener listener);
+      URLPatterns patterns,
+      const AtomNetworkDelegate::ListenerOptions& options,
+      Listener listener);
   template<typename Listener, typename Method, typename Event>
   void SetListener(Method method, Event type, mate::Arguments* args);
 
+  // Declarative rules evaluated on the IO thread.
+  void SetRules(mate::Arguments* args);
+  void GetRuleHitCounts(mate::Arguments* args);
+
  private:
   AtomBrowserContext* browser_context_;
   std::map<const net::URLFetcher*, FetchCallback> fetchers_;
@@ -5,6 +5,7 @@
 #include "atom/browser/api/event.h"
 
 #include "atom/common/api/api_messages.h"
+#include "atom/common/api/serialized_value.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
 #include "content/public/browser/web_contents.h"
 #include "native_mate/object_template_builder.h"
@@ -51,6 +52,27 @@ bool Event::SendReply(const base::string16& json) {
   return success;
 }
 
+bool Event::SendSerializedReply(v8::Isolate* isolate,
+                                v8::Local<v8::Value> value) {
+  if (message_ == nullptr || sender_ == nullptr)
+    return false;
+
+  // Still reply when |value| can't be serialized, the renderer is blocked
+  // on this message and reads an empty value as undefined.
+  atom::SerializedValue serialized;
+  bool serialized_ok = atom::SerializeValue(
+      isolate, value, v8::Local<v8::Value>(), &serialized);
+  if (!serialized_ok)
+    serialized = atom::SerializedValue();
+
+  AtomViewHostMsg_Message_Serialized_Sync::WriteReplyParams(message_,
+                                                            serialized);
+  bool success = sender_->Send(message_);
+  message_ = nullptr;
+  sender_ = nullptr;
+  return serialized_ok && success;
+}
+
 // static
 Handle<Event> Event::Create(v8::Isolate* isolate) {
   return mate::CreateHandle(isolate, new Event(isolate));
@@ -62,7 +84,8 @@ void Event::BuildPrototype(
   prototype->SetClassName(mate::StringToV8(isolate, "Event"));
   mate::ObjectTemplateBuilder(isolate, prototype->PrototypeTemplate())
       .SetMethod("preventDefault", &Event::PreventDefault)
-      .SetMethod("sendReply", &Event::SendReply);
+      .SetMethod("sendReply", &Event::SendReply)
+      .SetMethod("sendSerializedReply", &Event::SendSerializedReply);
 }
 
 }  // namespace mate
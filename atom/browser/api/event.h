@@ -32,6 +32,10 @@ class Event : public Wrappable<Event>,
   // event.sendReply(json), used for replying synchronous message.
   bool SendReply(const base::string16& json);
 
+  // event.sendSerializedReply(value), used for replying synchronous
+  // structured clone messages.
+  bool SendSerializedReply(v8::Isolate* isolate, v8::Local<v8::Value> value);
+
  protected:
   explicit Event(v8::Isolate* isolate);
   ~Event() override;
@@ -5,10 +5,13 @@
 #include "atom/browser/extensions/atom_browser_client_extensions_part.h"
 
 #include <map>
+#include <memory>
 #include <set>
+#include <string>
 
 #include "atom/common/api/api_messages.h"
 #include "base/command_line.h"
+#include "base/supports_user_data.h"
 #include "brave/browser/api/brave_api_extension.h"
 #include "chrome/browser/browser_process.h"
 #include "chrome/browser/profiles/profile.h"
@@ -21,6 +24,7 @@
 #include "components/prefs/pref_registry_simple.h"
 #include "components/prefs/pref_service.h"
 #include "components/user_prefs/user_prefs.h"
+#include "content/public/browser/browser_message_filter.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/browser_url_handler.h"
 #include "content/public/browser/render_process_host.h"
@@ -46,6 +50,7 @@
 #include "extensions/common/switches.h"
 
 using content::BrowserContext;
+using content::BrowserMessageFilter;
 using content::BrowserThread;
 using content::BrowserURLHandler;
 using content::SiteInstance;
@@ -91,9 +96,185 @@ RenderProcessHostPrivilege GetProcessPrivilege(
 
 static std::map<int, void*> render_process_hosts_;
 
+// The content settings last sent to the renderers of a browser context.
+// Every change bumps |version| and keeps the changes from the previous
+// version, so renderers that are up to date only receive those. Owned by
+// the browser context, so it goes away with it.
+struct ContentSettingsState : public base::SupportsUserData::Data {
+  int version = 0;
+  std::unique_ptr<base::DictionaryValue> content_settings;
+  std::unique_ptr<base::ListValue> last_changes;
+  AtomBrowserClientExtensionsPart::ContentSettingsUpdateStats stats;
+};
+
+const char kContentSettingsStateKey[] = "atom_content_settings_state";
+
+ContentSettingsState* GetContentSettingsState(BrowserContext* context) {
+  auto state = static_cast<ContentSettingsState*>(
+      context->GetUserData(kContentSettingsStateKey));
+  if (!state) {
+    state = new ContentSettingsState;
+    context->SetUserData(kContentSettingsStateKey, state);
+  }
+  return state;
+}
+
+// content settings version last sent to each render process
+static std::map<int, int> content_settings_versions_;
+
+// Appends the change turning |from| into |to| for |content_type|. Either
+// value can be null when the content type is added or removed.
+void DiffContentType(const std::string& content_type,
+                     const base::Value* from,
+                     const base::Value* to,
+                     base::ListValue* changes) {
+  std::unique_ptr<base::DictionaryValue> change(new base::DictionaryValue);
+  change->SetString("type", content_type);
+
+  const base::ListValue* from_rules = nullptr;
+  const base::ListValue* to_rules = nullptr;
+  if (!to) {
+    change->SetString("op", "remove");
+  } else if (from && from->GetAsList(&from_rules) &&
+             to->GetAsList(&to_rules)) {
+    // a single splice covers adding, removing or replacing a run of rules
+    auto rules_equal = [from_rules, to_rules](size_t i, size_t j) {
+      const base::Value* a = nullptr;
+      const base::Value* b = nullptr;
+      return from_rules->Get(i, &a) && to_rules->Get(j, &b) && a->Equals(b);
+    };
+    size_t start = 0;
+    size_t from_end = from_rules->GetSize();
+    size_t to_end = to_rules->GetSize();
+    while (start < from_end && start < to_end && rules_equal(start, start))
+      ++start;
+    while (from_end > start && to_end > start &&
+           rules_equal(from_end - 1, to_end - 1)) {
+      --from_end;
+      --to_end;
+    }
+
+    std::unique_ptr<base::ListValue> rules(new base::ListValue);
+    for (size_t i = start; i < to_end; ++i) {
+      const base::Value* rule = nullptr;
+      to_rules->Get(i, &rule);
+      rules->Append(rule->CreateDeepCopy());
+    }
+    change->SetString("op", "splice");
+    change->SetInteger("start", static_cast<int>(start));
+    change->SetInteger("deleteCount", static_cast<int>(from_end - start));
+    change->Set("rules", std::move(rules));
+  } else {
+    change->SetString("op", "set");
+    change->Set("value", to->CreateDeepCopy());
+  }
+  changes->Append(std::move(change));
+}
+
+// Brings the state of |context| up to date with its content settings pref.
+ContentSettingsState* RefreshContentSettingsState(BrowserContext* context) {
+  const base::DictionaryValue* content_settings =
+      user_prefs::UserPrefs::Get(context)->GetDictionary("content_settings");
+  ContentSettingsState* state = GetContentSettingsState(context);
+  if (state->content_settings &&
+      state->content_settings->Equals(content_settings))
+    return state;
+
+  std::unique_ptr<base::ListValue> changes;
+  if (state->content_settings) {
+    changes.reset(new base::ListValue);
+    for (base::DictionaryValue::Iterator it(*state->content_settings);
+        !it.IsAtEnd();
+        it.Advance()) {
+      const base::Value* value = nullptr;
+      content_settings->GetWithoutPathExpansion(it.key(), &value);
+      if (!value || !value->Equals(&it.value()))
+        DiffContentType(it.key(), &it.value(), value, changes.get());
+    }
+    for (base::DictionaryValue::Iterator it(*content_settings);
+        !it.IsAtEnd();
+        it.Advance()) {
+      if (!state->content_settings->GetWithoutPathExpansion(it.key(), nullptr))
+        DiffContentType(it.key(), nullptr, &it.value(), changes.get());
+    }
+  }
+
+  state->version++;
+  state->content_settings = content_settings->CreateDeepCopy();
+  state->last_changes = std::move(changes);
+  return state;
+}
+
+// Sends |host| the changes since the version it has, or all content
+// settings if it has none or an older version.
+void SendContentSettings(content::RenderProcessHost* host,
+                         ContentSettingsState* state,
+                         bool force_full) {
+  auto version = content_settings_versions_.find(host->GetID());
+  if (!force_full && version != content_settings_versions_.end()) {
+    if (version->second == state->version)
+      return;
+
+    if (version->second == state->version - 1 && state->last_changes) {
+      host->Send(new AtomMsg_UpdateContentSettingsDelta(
+          version->second, *state->last_changes));
+      version->second = state->version;
+      state->stats.deltas++;
+      return;
+    }
+  }
+
+  host->Send(new AtomMsg_UpdateContentSettings(
+      state->version, *state->content_settings));
+  content_settings_versions_[host->GetID()] = state->version;
+  state->stats.full_updates++;
+}
+
+// Resends all content settings when a renderer can't apply a delta.
+class ContentSettingsMessageFilter : public BrowserMessageFilter {
+ public:
+  explicit ContentSettingsMessageFilter(int render_process_id)
+      : BrowserMessageFilter(ShellMsgStart),
+        render_process_id_(render_process_id) {}
+
+  // content::BrowserMessageFilter:
+  void OverrideThreadForMessage(const IPC::Message& message,
+                                BrowserThread::ID* thread) override {
+    if (message.type() == AtomHostMsg_RequestContentSettings::ID)
+      *thread = BrowserThread::UI;
+  }
+
+  bool OnMessageReceived(const IPC::Message& message) override {
+    bool handled = true;
+    IPC_BEGIN_MESSAGE_MAP(ContentSettingsMessageFilter, message)
+      IPC_MESSAGE_HANDLER(AtomHostMsg_RequestContentSettings,
+                          OnRequestContentSettings)
+      IPC_MESSAGE_UNHANDLED(handled = false)
+    IPC_END_MESSAGE_MAP()
+    return handled;
+  }
+
+ private:
+  ~ContentSettingsMessageFilter() override {}
+
+  void OnRequestContentSettings() {
+    auto host = content::RenderProcessHost::FromID(render_process_id_);
+    if (!host)
+      return;
+
+    SendContentSettings(
+        host, RefreshContentSettingsState(host->GetBrowserContext()), true);
+  }
+
+  int render_process_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContentSettingsMessageFilter);
+};
+
 }  // namespace
 
-AtomBrowserClientExtensionsPart::AtomBrowserClientExtensionsPart() {
+AtomBrowserClientExtensionsPart::AtomBrowserClientExtensionsPart()
+    : render_process_host_observer_(this) {
 }
 
 AtomBrowserClientExtensionsPart::~AtomBrowserClientExtensionsPart() {
@@ -321,12 +502,16 @@ void AtomBrowserClientExtensionsPart::RenderProcessWillLaunch(
   host->AddFilter(new ExtensionMessageFilter(id, context));
   host->AddFilter(new IOThreadExtensionMessageFilter(id, context));
   host->AddFilter(new ExtensionsGuestViewMessageFilter(id, context));
+  host->AddFilter(new ContentSettingsMessageFilter(id));
   if (extensions::ExtensionsClient::Get()
           ->ExtensionAPIEnabledInExtensionServiceWorkers()) {
     host->AddFilter(new ExtensionServiceWorkerMessageFilter(
        id, context, host->GetStoragePartition()->GetServiceWorkerContext()));
   }
 
+  if (!render_process_host_observer_.IsObserving(host))
+    render_process_host_observer_.Add(host);
+
   auto user_prefs_registrar = context->user_prefs_change_registrar();
   if (!user_prefs_registrar->IsObserved("content_settings")) {
     user_prefs_registrar->Add(
@@ -368,20 +553,49 @@ void AtomBrowserClientExtensionsPart::UpdateContentSettingsForHost(
   if (!host)
     return;
 
-  auto context =
-      static_cast<atom::AtomBrowserContext*>(host->GetBrowserContext());
-  auto user_prefs = user_prefs::UserPrefs::Get(context);
-  const base::DictionaryValue* content_settings =
-    user_prefs->GetDictionary("content_settings");
-  host->Send(new AtomMsg_UpdateContentSettings(*content_settings));
+  SendContentSettings(
+      host, RefreshContentSettingsState(host->GetBrowserContext()), false);
+}
+
+// static
+AtomBrowserClientExtensionsPart::ContentSettingsUpdateStats
+AtomBrowserClientExtensionsPart::GetContentSettingsUpdateStats(
+    BrowserContext* context) {
+  return GetContentSettingsState(context)->stats;
+}
+
+void AtomBrowserClientExtensionsPart::RenderProcessExited(
+    content::RenderProcessHost* host,
+    base::TerminationStatus status,
+    int exit_code) {
+  // A relaunched renderer starts without content settings.
+  content_settings_versions_.erase(host->GetID());
+}
+
+void AtomBrowserClientExtensionsPart::RenderProcessHostDestroyed(
+    content::RenderProcessHost* host) {
+  content_settings_versions_.erase(host->GetID());
+  render_process_host_observer_.Remove(host);
 }
 
 void AtomBrowserClientExtensionsPart::UpdateContentSettings() {
+  // compare the pref with the last sent settings once per context
+  std::set<BrowserContext*> refreshed;
   for (std::map<int, void*>::iterator
       it = render_process_hosts_.begin();
       it != render_process_hosts_.end();
       ++it) {
-    UpdateContentSettingsForHost(it->first);
+    auto host = content::RenderProcessHost::FromID(it->first);
+    if (!host) {
+      content_settings_versions_.erase(it->first);
+      continue;
+    }
+
+    BrowserContext* context = host->GetBrowserContext();
+    ContentSettingsState* state = refreshed.insert(context).second
+        ? RefreshContentSettingsState(context)
+        : GetContentSettingsState(context);
+    SendContentSettings(host, state, false);
   }
 }
 
@@ -9,6 +9,9 @@
 #include <vector>
 #include "base/compiler_specific.h"
 #include "base/macros.h"
+#include "base/scoped_observer.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/render_process_host_observer.h"
 
 class GURL;
 class PrefRegistrySimple;
@@ -23,7 +26,6 @@ class BrowserContext;
 class BrowserURLHandler;
 class ResourceContext;
 class SiteInstance;
-class RenderProcessHost;
 class RenderViewHost;
 struct WebPreferences;
 }
@@ -33,10 +35,20 @@ class Profile;
 namespace extensions {
 
 // Implements the extensions portion of AtomBrowserClient.
-class AtomBrowserClientExtensionsPart {
+class AtomBrowserClientExtensionsPart
+    : public content::RenderProcessHostObserver {
  public:
+  // Content settings updates sent to the renderers of a browser context.
+  struct ContentSettingsUpdateStats {
+    int full_updates = 0;
+    int deltas = 0;
+  };
+
   AtomBrowserClientExtensionsPart();
-  ~AtomBrowserClientExtensionsPart();
+  ~AtomBrowserClientExtensionsPart() override;
+
+  static ContentSettingsUpdateStats GetContentSettingsUpdateStats(
+      content::BrowserContext* context);
 
   // Corresponds to the AtomBrowserClient function of the same name.
   static GURL GetEffectiveURL(Profile* profile, const GURL& url);
@@ -86,9 +98,18 @@ class AtomBrowserClientExtensionsPart {
   std::string GetApplicationLocale();
 
  private:
+  // content::RenderProcessHostObserver:
+  void RenderProcessExited(content::RenderProcessHost* host,
+                           base::TerminationStatus status,
+                           int exit_code) override;
+  void RenderProcessHostDestroyed(content::RenderProcessHost* host) override;
+
   void UpdateContentSettings();
   void UpdateContentSettingsForHost(int render_process_id);
 
+  ScopedObserver<content::RenderProcessHost,
+                 content::RenderProcessHostObserver>
+      render_process_host_observer_;
 
   DISALLOW_COPY_AND_ASSIGN(AtomBrowserClientExtensionsPart);
 };
@@ -5,6 +5,7 @@
 #include "atom/browser/extensions/tab_helper.h"
 
 #include <map>
+#include <set>
 #include <utility>
 #include "atom/browser/extensions/atom_extension_api_frame_id_map_helper.h"
 #include "atom/browser/extensions/atom_extension_web_contents_observer.h"
@@ -12,6 +13,7 @@
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/gurl_converter.h"
 #include "atom/common/native_mate_converters/value_converter.h"
+#include "base/lazy_instance.h"
 #include "base/strings/utf_string_conversions.h"
 #include "brave/browser/brave_browser_context.h"
 #include "brave/browser/guest_view/tab_view/tab_view_guest.h"
@@ -21,14 +23,11 @@
 #include "chrome/browser/sessions/session_tab_helper.h"
 #include "chrome/browser/ui/browser.h"
 #include "chrome/browser/ui/browser_list.h"
-#include "chrome/browser/ui/tab_contents/tab_contents_iterator.h"
 #include "chrome/browser/ui/tabs/tab_strip_model.h"
 #include "components/sessions/core/session_id.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/navigation_entry.h"
 #include "content/public/browser/render_frame_host.h"
-#include "content/public/browser/render_process_host.h"
-#include "content/public/browser/render_view_host.h"
 #include "content/public/browser/web_contents.h"
 #include "extensions/browser/component_extension_resource_manager.h"
 #include "extensions/browser/extension_registry.h"
@@ -63,12 +62,19 @@ const char kPinnedKey[] = "pinned";
 const char kSelectedKey[] = "selected";
 }  // namespace keys
 
-static std::map<int32_t, std::pair<int, int>> render_view_map_;
-
 namespace extensions {
 
 namespace {
 
+// Finds tabs by id and by (window id, index) without going through every
+// WebContents. Entries are checked against the tab before they are used.
+struct TabIndex {
+  std::map<int32_t, TabHelper*> by_id;
+  std::map<std::pair<int32_t, int>, std::set<TabHelper*>> by_position;
+};
+
+base::LazyInstance<TabIndex>::Leaky g_tab_index = LAZY_INSTANCE_INITIALIZER;
+
 TabManager* GetTabManager() {
   return g_browser_process->GetTabManager();
 }
@@ -81,14 +87,18 @@ TabHelper::TabHelper(content::WebContents* contents)
       script_executor_(
           new ScriptExecutor(contents, &script_execution_observers_)),
       index_(TabStripModel::kNoTab),
+      indexed_tab_id_(-1),
+      indexed_position_(-1, TabStripModel::kNoTab),
       pinned_(false),
       is_placeholder_(false),
       window_closing_(false),
       browser_(nullptr) {
   SessionTabHelper::CreateForWebContents(contents);
+  indexed_tab_id_ = session_id();
+  g_tab_index.Get().by_id[indexed_tab_id_] = this;
+  g_tab_index.Get().by_position[indexed_position_].insert(this);
   SetWindowId(-1);
 
-  RenderViewCreated(contents->GetRenderViewHost());
   contents->ForEachFrame(
       base::Bind(&TabHelper::SetTabId, base::Unretained(this)));
 
@@ -97,6 +107,7 @@ TabHelper::TabHelper(content::WebContents* contents)
 }
 
 TabHelper::~TabHelper() {
+  RemoveFromTabIndex();
   BrowserList::RemoveObserver(this);
 }
 
@@ -150,12 +161,17 @@ void TabHelper::DestroyTab(content::WebContents* tab) {
 
 // static
 int TabHelper::GetTabStripIndex(int window_id, int index) {
-  for (TabContentsIterator it; !it.done(); it.Next()) {
-    auto tab_helper = FromWebContents(*it);
-    if (tab_helper &&
-        tab_helper->get_index() == index &&
-        tab_helper->window_id() == window_id)
-      return tab_helper->get_tab_strip_index();
+  const auto& by_position = g_tab_index.Get().by_position;
+  auto it = by_position.find(std::make_pair(window_id, index));
+  if (it != by_position.end()) {
+    for (TabHelper* tab_helper : it->second) {
+      if (tab_helper->get_index() != index ||
+          tab_helper->window_id() != window_id)
+        continue;
+      int tab_strip_index = tab_helper->get_tab_strip_index();
+      if (tab_strip_index != TabStripModel::kNoTab)
+        return tab_strip_index;
+    }
   }
   return TabStripModel::kNoTab;
 }
@@ -166,6 +182,7 @@ bool TabHelper::AttachGuest(int window_id, int index) {
   for (auto* browser : *BrowserList::GetInstance()) {
     if (browser->session_id().id() == window_id) {
       index_ = index;
+      UpdateTabPosition();
       browser->tab_strip_model()->ReplaceWebContentsAt(
           GetTabStripIndex(window_id, index_), web_contents());
       return true;
@@ -186,6 +203,7 @@ content::WebContents* TabHelper::DetachGuest() {
     auto null_helper = FromWebContents(null_contents);
     null_helper->index_ = index_;
     null_helper->pinned_ = pinned_;
+    null_helper->UpdateTabPosition();
     // transfer window closing state
     null_helper->window_closing_ = window_closing_;
     window_closing_ = false;
@@ -257,6 +275,7 @@ void TabHelper::OnBrowserRemoved(Browser* browser) {
     browser_->tab_strip_model()->RemoveObserver(this);
     browser_ = nullptr;
     index_ = TabStripModel::kNoTab;
+    UpdateTabPosition();
   }
 }
 
@@ -316,6 +335,7 @@ void TabHelper::TabReplacedAt(TabStripModel* tab_strip_model,
 
   OnBrowserRemoved(old_browser);
   new_helper->UpdateBrowser(old_browser);
+  new_helper->UpdateTabPosition();
 
   brave::TabViewGuest* new_guest = new_helper->guest();
   old_contents->WasHidden();
@@ -329,6 +349,18 @@ void TabHelper::TabReplacedAt(TabStripModel* tab_strip_model,
   new_guest->AttachGuest(new_guest->guest_instance_id());
 }
 
+void TabHelper::TabInsertedAt(TabStripModel* tab_strip_model,
+                              content::WebContents* contents,
+                              int index,
+                              bool foreground) {
+  if (contents != web_contents())
+    return;
+
+  // The browser sets the window id of inserted tabs without going through
+  // SetWindowId.
+  UpdateTabPosition();
+}
+
 void TabHelper::TabDetachedAt(content::WebContents* contents, int index) {
   if (contents != web_contents())
     return;
@@ -366,6 +398,7 @@ void TabHelper::UpdateBrowser(Browser* browser) {
   browser_ = browser;
   browser_->tab_strip_model()->AddObserver(this);
   static_cast<atom::NativeWindow*>(browser_->window())->AddObserver(this);
+  UpdateTabPosition();
 }
 
 void TabHelper::SetBrowser(Browser* browser) {
@@ -391,6 +424,7 @@ void TabHelper::SetWindowId(const int32_t& id) {
   SessionID session;
   session.set_id(id);
   SessionTabHelper::FromWebContents(web_contents())->SetWindowID(session);
+  UpdateTabPosition();
 }
 
 int32_t TabHelper::window_id() const {
@@ -432,6 +466,37 @@ bool TabHelper::IsPinned() const {
 
 void TabHelper::SetTabIndex(int index) {
   index_ = index;
+  UpdateTabPosition();
+}
+
+void TabHelper::UpdateTabPosition() {
+  std::pair<int32_t, int> position(window_id(), index_);
+  if (position == indexed_position_)
+    return;
+
+  auto& by_position = g_tab_index.Get().by_position;
+  auto it = by_position.find(indexed_position_);
+  if (it != by_position.end()) {
+    it->second.erase(this);
+    if (it->second.empty())
+      by_position.erase(it);
+  }
+  indexed_position_ = position;
+  by_position[indexed_position_].insert(this);
+}
+
+void TabHelper::RemoveFromTabIndex() {
+  TabIndex& tab_index = g_tab_index.Get();
+  auto id_it = tab_index.by_id.find(indexed_tab_id_);
+  if (id_it != tab_index.by_id.end() && id_it->second == this)
+    tab_index.by_id.erase(id_it);
+
+  auto position_it = tab_index.by_position.find(indexed_position_);
+  if (position_it != tab_index.by_position.end()) {
+    position_it->second.erase(this);
+    if (position_it->second.empty())
+      tab_index.by_position.erase(position_it);
+  }
 }
 
 bool TabHelper::is_active() const {
@@ -453,12 +518,6 @@ void TabHelper::SetTabValues(const base::DictionaryValue& values) {
   values_->MergeDictionary(&values);
 }
 
-void TabHelper::RenderViewCreated(content::RenderViewHost* render_view_host) {
-  render_view_map_[session_id()] = std::make_pair(
-      render_view_host->GetProcess()->GetID(),
-      render_view_host->GetRoutingID());
-}
-
 void TabHelper::RenderFrameCreated(content::RenderFrameHost* host) {
   SetTabId(host);
 }
@@ -467,7 +526,7 @@ void TabHelper::WebContentsDestroyed() {
   if (browser())
     SetBrowser(nullptr);
 
-  render_view_map_.erase(session_id());
+  RemoveFromTabIndex();
 }
 
 void TabHelper::SetTabId(content::RenderFrameHost* render_frame_host) {
@@ -640,14 +699,11 @@ int TabHelper::get_tab_strip_index() const {
 
 // static
 content::WebContents* TabHelper::GetTabById(int32_t tab_id) {
-  content::RenderViewHost* rvh =
-      content::RenderViewHost::FromID(render_view_map_[tab_id].first,
-                                      render_view_map_[tab_id].second);
-  if (rvh) {
-    return content::WebContents::FromRenderViewHost(rvh);
-  } else {
+  const auto& by_id = g_tab_index.Get().by_id;
+  auto it = by_id.find(tab_id);
+  if (it == by_id.end())
     return NULL;
-  }
+  return it->second->web_contents();
 }
 
 // static
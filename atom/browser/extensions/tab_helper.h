@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "atom/browser/native_window_observer.h"
 #include "base/macros.h"
@@ -148,6 +149,10 @@ class TabHelper : public content::WebContentsObserver,
   explicit TabHelper(content::WebContents* contents);
   friend class content::WebContentsUserData<TabHelper>;
 
+  void TabInsertedAt(TabStripModel* tab_strip_model,
+                     content::WebContents* contents,
+                     int index,
+                     bool foreground) override;
   void TabDetachedAt(content::WebContents* contents, int index) override;
   void TabReplacedAt(TabStripModel* tab_strip_model,
                      content::WebContents* old_contents,
@@ -165,6 +170,11 @@ class TabHelper : public content::WebContentsObserver,
   void MaybeAttachOrCreatePinnedTab();
   void MaybeRequestWindowClose();
 
+  // Keeps the (window id, index) entry of the tab index up to date, called
+  // whenever either of them changes.
+  void UpdateTabPosition();
+  void RemoveFromTabIndex();
+
   // atom::NativeWindowObserver overrides.
   void WillCloseWindow(bool* prevent_default) override;
 
@@ -178,7 +188,6 @@ class TabHelper : public content::WebContentsObserver,
       std::unique_ptr<std::string> code_string);
 
   // content::WebContentsObserver overrides.
-  void RenderViewCreated(content::RenderViewHost* render_view_host) override;
   void RenderFrameCreated(content::RenderFrameHost* host) override;
   void WebContentsDestroyed() override;
   void DidCloneToNewWebContents(
@@ -195,6 +204,9 @@ class TabHelper : public content::WebContentsObserver,
 
   // Index of the tab within the window
   int index_;
+  // The tab id and (window id, index) the tab is indexed by.
+  int32_t indexed_tab_id_;
+  std::pair<int32_t, int> indexed_position_;
   bool pinned_;
   bool is_placeholder_;
   bool window_closing_;
@@ -188,6 +188,12 @@ void JavascriptEnvironment::OnMessageLoopDestroying() {
 bool JavascriptEnvironment::Initialize() {
   auto cmd = base::CommandLine::ForCurrentProcess();
 
+  // SharedArrayBuffer and Atomics for memory shared with V8 workers, before
+  // --js-flags so they can still be turned off.
+  const char shared_array_buffer_flag[] = "--harmony-sharedarraybuffer";
+  v8::V8::SetFlagsFromString(shared_array_buffer_flag,
+                             sizeof(shared_array_buffer_flag) - 1);
+
   // --js-flags.
   std::string js_flags = cmd->GetSwitchValueASCII(switches::kJavaScriptFlags);
   if (!js_flags.empty())
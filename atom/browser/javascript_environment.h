@@ -41,6 +41,7 @@ class JavascriptEnvironment {
   const brave::AsarSourceMap& source_map() const {
     return source_map_;
   }
+  brave::AsarSourceMap* mutable_source_map() { return &source_map_; }
 
  private:
   bool Initialize();
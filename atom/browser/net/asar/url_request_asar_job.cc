@@ -4,6 +4,8 @@
 
 #include "atom/browser/net/asar/url_request_asar_job.h"
 
+#include <string.h>
+
 #include <string>
 #include <utility>
 #include <vector>
@@ -13,6 +15,7 @@
 #include "atom/common/atom_constants.h"
 #include "base/bind.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/strings/string_util.h"
 #include "base/synchronization/lock.h"
 #include "base/task_runner.h"
@@ -66,6 +69,15 @@ void Initialize(
   *type = URLRequestAsarJob::TYPE_ASAR;
 }
 
+// Copies |size| bytes at |offset| of |mapped_file| into |dest|. The pages
+// may not be resident yet, so this runs on the file task runner.
+void CopyFromMappedFile(std::shared_ptr<base::MemoryMappedFile> mapped_file,
+                        int64_t offset,
+                        net::IOBuffer* dest,
+                        int size) {
+  memcpy(dest->data(), mapped_file->data() + offset, size);
+}
+
 }  // namespace
 
 URLRequestAsarJob::FileMetaInfo::FileMetaInfo()
@@ -110,6 +122,20 @@ void URLRequestAsarJob::Start() {
 
 void URLRequestAsarJob::DidInitialize() {
   if (type_ == TYPE_ASAR) {
+    // Packed files are copied out of the archive mapping shared by all
+    // requests, without opening and seeking the archive every time.
+    mapped_file_ = archive_->mapped_file();
+    if (mapped_file_ &&
+        file_info_.offset <= mapped_file_->length() &&
+        file_info_.stored_size() <=
+            mapped_file_->length() - file_info_.offset) {
+      RecordAsarRequest(true);
+      DidOpen(net::OK);
+      return;
+    }
+    mapped_file_.reset();
+    RecordAsarRequest(false);
+
     InitializeAsarJob();
     int flags = base::File::FLAG_OPEN |
                 base::File::FLAG_READ |
@@ -151,6 +177,18 @@ int URLRequestAsarJob::ReadRawData(net::IOBuffer* dest, int dest_size) {
   if (!dest_size)
     return 0;
 
+  if (mapped_file_) {
+    file_task_runner_->PostTaskAndReply(
+        FROM_HERE,
+        base::Bind(&CopyFromMappedFile, mapped_file_, seek_offset_,
+                   base::RetainedRef(dest), dest_size),
+        base::Bind(&URLRequestAsarJob::DidRead,
+                   weak_ptr_factory_.GetWeakPtr(),
+                   base::RetainedRef(dest), dest_size));
+    seek_offset_ += dest_size;
+    return net::ERR_IO_PENDING;
+  }
+
   int rv = stream_->Read(dest,
                          dest_size,
                          base::Bind(&URLRequestAsarJob::DidRead,
@@ -193,6 +231,11 @@ bool URLRequestAsarJob::IsRedirectResponse(GURL* location,
 std::unique_ptr<net::SourceStream> URLRequestAsarJob::SetUpSourceStream() {
   std::unique_ptr<net::SourceStream> source =
     URLRequestJob::SetUpSourceStream();
+  // Compressed archive entries are inflated as they are read.
+  if (type_ == TYPE_ASAR && file_info_.compressed) {
+    source = net::GzipSourceStream::Create(std::move(source),
+                                           net::SourceStream::TYPE_GZIP);
+  }
   if (!base::LowerCaseEqualsASCII(file_path_.Extension(), ".svgz"))
     return source;
 
@@ -290,7 +333,14 @@ void URLRequestAsarJob::DidOpen(int result) {
 
   int64_t file_size, read_offset;
   if (type_ == TYPE_ASAR) {
-    file_size = file_info_.size;
+    // Ranges of a compressed entry can't be found without inflating it.
+    if (file_info_.compressed && byte_range_.IsValid()) {
+      NotifyStartError(
+          net::URLRequestStatus(net::URLRequestStatus::FAILED,
+                                net::ERR_REQUEST_RANGE_NOT_SATISFIABLE));
+      return;
+    }
+    file_size = file_info_.stored_size();
     read_offset = file_info_.offset;
   } else {
     file_size = meta_info_.file_size;
@@ -308,7 +358,7 @@ void URLRequestAsarJob::DidOpen(int result) {
                      byte_range_.first_byte_position() + 1;
   seek_offset_ = byte_range_.first_byte_position() + read_offset;
 
-  if (remaining_bytes_ > 0 && seek_offset_ != 0) {
+  if (!mapped_file_ && remaining_bytes_ > 0 && seek_offset_ != 0) {
     int rv = stream_->Seek(seek_offset_,
                            base::Bind(&URLRequestAsarJob::DidSeek,
                                       weak_ptr_factory_.GetWeakPtr()));
@@ -17,6 +17,7 @@
 #include "net/url_request/url_request_job.h"
 
 namespace base {
+class MemoryMappedFile;
 class TaskRunner;
 }
 
@@ -110,6 +111,8 @@ class URLRequestAsarJob : public net::URLRequestJob {
   Archive::FileInfo file_info_;
 
   std::unique_ptr<net::FileStream> stream_;
+  // The mapping of |archive_| packed files are read from instead of |stream_|.
+  std::shared_ptr<base::MemoryMappedFile> mapped_file_;
   FileMetaInfo meta_info_;
 
   net::HttpByteRange byte_range_;
@@ -6,8 +6,10 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "atom/common/native_mate_converters/net_converter.h"
+#include "base/memory/ptr_util.h"
 #include "base/stl_util.h"
 #include "base/strings/string_util.h"
 #include "chrome/browser/devtools/devtools_network_transaction.h"
@@ -74,15 +76,8 @@ void RunResponseListener(
 
 // Test whether the URL of |request| matches |patterns|.
 bool MatchesFilterCondition(net::URLRequest* request,
-                            const URLPatterns& patterns) {
-  if (patterns.empty())
-    return true;
-
-  for (const auto& pattern : patterns) {
-    if (pattern.MatchesURL(request->url()))
-      return true;
-  }
-  return false;
+                            const URLPatternMatcher& patterns) {
+  return patterns.Matches(request->url());
 }
 
 int GetTabId(net::URLRequest* request) {
@@ -115,22 +110,59 @@ int GetTabId(net::URLRequest* request) {
 #endif
 }
 
-// Overloaded by multiple types to fill the |details| object.
-void ToDictionary(base::DictionaryValue* details, net::URLRequest* request) {
-  FillRequestDetails(details, request);
-  details->SetInteger("id", request->identifier());
-  details->SetDouble("timestamp", base::Time::Now().ToDoubleT() * 1000);
-  details->SetString("firstPartyUrl",
-    request->first_party_for_cookies().spec());
-  auto info = content::ResourceRequestInfo::ForRequest(request);
-  details->SetString("resourceType",
-                     info ? ResourceTypeToString(info->GetResourceType())
-                          : "other");
-  details->SetInteger("tabId", GetTabId(request));
+using DetailsField = AtomNetworkDelegate::DetailsField;
+
+const struct {
+  const char* name;
+  DetailsField field;
+} kDetailsFieldNames[] = {
+  { "id", AtomNetworkDelegate::kDetailsId },
+  { "url", AtomNetworkDelegate::kDetailsUrl },
+  { "method", AtomNetworkDelegate::kDetailsMethod },
+  { "referrer", AtomNetworkDelegate::kDetailsReferrer },
+  { "uploadData", AtomNetworkDelegate::kDetailsUploadData },
+  { "timestamp", AtomNetworkDelegate::kDetailsTimestamp },
+  { "firstPartyUrl", AtomNetworkDelegate::kDetailsFirstPartyUrl },
+  { "resourceType", AtomNetworkDelegate::kDetailsResourceType },
+  { "tabId", AtomNetworkDelegate::kDetailsTabId },
+  { "requestHeaders", AtomNetworkDelegate::kDetailsRequestHeaders },
+  { "responseHeaders", AtomNetworkDelegate::kDetailsResponseHeaders },
+  { "statusLine", AtomNetworkDelegate::kDetailsStatusLine },
+  { "statusCode", AtomNetworkDelegate::kDetailsStatusCode },
+  { "redirectURL", AtomNetworkDelegate::kDetailsRedirectURL },
+  { "ip", AtomNetworkDelegate::kDetailsIp },
+  { "fromCache", AtomNetworkDelegate::kDetailsFromCache },
+  { "error", AtomNetworkDelegate::kDetailsError },
+};
+
+// Overloaded by multiple types to fill the |details| object with the
+// requested |fields|.
+void ToDictionary(base::DictionaryValue* details, uint32_t fields,
+                  net::URLRequest* request) {
+  FillRequestDetails(details, request, fields);
+  if (fields & AtomNetworkDelegate::kDetailsId)
+    details->SetInteger("id", request->identifier());
+  if (fields & AtomNetworkDelegate::kDetailsTimestamp)
+    details->SetDouble("timestamp", base::Time::Now().ToDoubleT() * 1000);
+  if (fields & AtomNetworkDelegate::kDetailsFirstPartyUrl) {
+    details->SetString("firstPartyUrl",
+      request->first_party_for_cookies().spec());
+  }
+  if (fields & AtomNetworkDelegate::kDetailsResourceType) {
+    auto info = content::ResourceRequestInfo::ForRequest(request);
+    details->SetString("resourceType",
+                       info ? ResourceTypeToString(info->GetResourceType())
+                            : "other");
+  }
+  if (fields & AtomNetworkDelegate::kDetailsTabId)
+    details->SetInteger("tabId", GetTabId(request));
 }
 
-void ToDictionary(base::DictionaryValue* details,
+void ToDictionary(base::DictionaryValue* details, uint32_t fields,
                   const net::HttpRequestHeaders& headers) {
+  if (!(fields & AtomNetworkDelegate::kDetailsRequestHeaders))
+    return;
+
   std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
   net::HttpRequestHeaders::Iterator it(headers);
   while (it.GetNext())
@@ -138,60 +170,73 @@ void ToDictionary(base::DictionaryValue* details,
   details->Set("requestHeaders", std::move(dict));
 }
 
-void ToDictionary(base::DictionaryValue* details,
+void ToDictionary(base::DictionaryValue* details, uint32_t fields,
                   const net::HttpResponseHeaders* headers) {
   if (!headers)
     return;
 
-  std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
-  size_t iter = 0;
-  std::string key;
-  std::string value;
-  while (headers->EnumerateHeaderLines(&iter, &key, &value)) {
-    if (dict->HasKey(key)) {
-      base::ListValue* values = nullptr;
-      if (dict->GetList(key, &values))
+  if (fields & AtomNetworkDelegate::kDetailsResponseHeaders) {
+    std::unique_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
+    size_t iter = 0;
+    std::string key;
+    std::string value;
+    while (headers->EnumerateHeaderLines(&iter, &key, &value)) {
+      if (dict->HasKey(key)) {
+        base::ListValue* values = nullptr;
+        if (dict->GetList(key, &values))
+          values->AppendString(value);
+      } else {
+        std::unique_ptr<base::ListValue> values(new base::ListValue);
         values->AppendString(value);
-    } else {
-      std::unique_ptr<base::ListValue> values(new base::ListValue);
-      values->AppendString(value);
-      dict->Set(key, std::move(values));
+        dict->Set(key, std::move(values));
+      }
     }
+    details->Set("responseHeaders", std::move(dict));
   }
-  details->Set("responseHeaders", std::move(dict));
-  details->SetString("statusLine", headers->GetStatusLine());
-  details->SetInteger("statusCode", headers->response_code());
+  if (fields & AtomNetworkDelegate::kDetailsStatusLine)
+    details->SetString("statusLine", headers->GetStatusLine());
+  if (fields & AtomNetworkDelegate::kDetailsStatusCode)
+    details->SetInteger("statusCode", headers->response_code());
 }
 
-void ToDictionary(base::DictionaryValue* details, const GURL& location) {
-  details->SetString("redirectURL", location.spec());
+void ToDictionary(base::DictionaryValue* details, uint32_t fields,
+                  const GURL& location) {
+  if (fields & AtomNetworkDelegate::kDetailsRedirectURL)
+    details->SetString("redirectURL", location.spec());
 }
 
-void ToDictionary(base::DictionaryValue* details,
+void ToDictionary(base::DictionaryValue* details, uint32_t fields,
                   const net::HostPortPair& host_port) {
+  if (!(fields & AtomNetworkDelegate::kDetailsIp))
+    return;
   if (host_port.host().empty())
     details->SetString("ip", host_port.host());
 }
 
-void ToDictionary(base::DictionaryValue* details, bool from_cache) {
-  details->SetBoolean("fromCache", from_cache);
+void ToDictionary(base::DictionaryValue* details, uint32_t fields,
+                  bool from_cache) {
+  if (fields & AtomNetworkDelegate::kDetailsFromCache)
+    details->SetBoolean("fromCache", from_cache);
 }
 
-void ToDictionary(base::DictionaryValue* details,
+void ToDictionary(base::DictionaryValue* details, uint32_t fields,
                   const net::URLRequestStatus& status) {
-  details->SetString("error", net::ErrorToString(status.error()));
+  if (fields & AtomNetworkDelegate::kDetailsError)
+    details->SetString("error", net::ErrorToString(status.error()));
 }
 
 // Helper function to fill |details| with arbitrary |args|.
 template<typename Arg>
-void FillDetailsObject(base::DictionaryValue* details, Arg arg) {
-  ToDictionary(details, arg);
+void FillDetailsObject(base::DictionaryValue* details, uint32_t fields,
+                       Arg arg) {
+  ToDictionary(details, fields, arg);
 }
 
 template<typename Arg, typename... Args>
-void FillDetailsObject(base::DictionaryValue* details, Arg arg, Args... args) {
-  ToDictionary(details, arg);
-  FillDetailsObject(details, args...);
+void FillDetailsObject(base::DictionaryValue* details, uint32_t fields,
+                       Arg arg, Args... args) {
+  ToDictionary(details, fields, arg);
+  FillDetailsObject(details, fields, args...);
 }
 
 // Fill the native types with the result from the response object.
@@ -248,30 +293,132 @@ void ReadFromResponseObject(const base::DictionaryValue& response,
 
 }  // namespace
 
-AtomNetworkDelegate::AtomNetworkDelegate() {
+AtomNetworkDelegate::DeclarativeRule::DeclarativeRule() : cancel(false) {
+}
+
+AtomNetworkDelegate::DeclarativeRule::DeclarativeRule(
+    const DeclarativeRule& other) = default;
+
+AtomNetworkDelegate::DeclarativeRule::~DeclarativeRule() {
+}
+
+AtomNetworkDelegate::AtomNetworkDelegate() : weak_factory_(this) {
 }
 
 AtomNetworkDelegate::~AtomNetworkDelegate() {
 }
 
+// static
+bool AtomNetworkDelegate::ParseDetailsFields(
+    const std::vector<std::string>& names, uint32_t* fields) {
+  uint32_t result = 0;
+  for (const auto& name : names) {
+    bool found = false;
+    for (const auto& entry : kDetailsFieldNames) {
+      if (name == entry.name) {
+        result |= entry.field;
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+      return false;
+  }
+  *fields = result;
+  return true;
+}
+
 void AtomNetworkDelegate::SetSimpleListenerInIO(
     SimpleEvent type,
     const URLPatterns& patterns,
+    const ListenerOptions& options,
     const SimpleListener& callback) {
+  // Deliver what was collected for the previous listener first.
+  FlushBatch(type);
   if (callback.is_null())
     simple_listeners_.erase(type);
   else
-    simple_listeners_[type] = { patterns, callback };
+    simple_listeners_[type] =
+        { URLPatternMatcher(patterns), options, callback };
 }
 
 void AtomNetworkDelegate::SetResponseListenerInIO(
     ResponseEvent type,
     const URLPatterns& patterns,
+    const ListenerOptions& options,
     const ResponseListener& callback) {
   if (callback.is_null())
     response_listeners_.erase(type);
   else
-    response_listeners_[type] = { patterns, callback };
+    response_listeners_[type] =
+        { URLPatternMatcher(patterns), options, callback };
+}
+
+void AtomNetworkDelegate::SetDeclarativeRulesInIO(
+    const std::vector<DeclarativeRule>& rules) {
+  rules_ = rules;
+  rule_hits_.assign(rules_.size(), 0);
+}
+
+void AtomNetworkDelegate::GetDeclarativeRuleHitsInIO(
+    const RuleHitsCallback& callback) {
+  std::unique_ptr<base::DictionaryValue> hits(new base::DictionaryValue);
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    double count = static_cast<double>(rule_hits_[i]);
+    double previous = 0;
+    // Rules sharing an id are reported together.
+    hits->GetDoubleWithoutPathExpansion(rules_[i].id, &previous);
+    hits->SetDoubleWithoutPathExpansion(rules_[i].id, previous + count);
+  }
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(callback, base::Passed(&hits)));
+}
+
+bool AtomNetworkDelegate::ApplyRulesBeforeRequest(net::URLRequest* request,
+                                                  GURL* new_url,
+                                                  int* result) {
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    const DeclarativeRule& rule = rules_[i];
+    if (!rule.cancel && !rule.redirect_url.is_valid())
+      continue;
+    // Do not redirect a request to itself forever.
+    if (!rule.cancel && rule.redirect_url == request->url())
+      continue;
+    if (!MatchesFilterCondition(request, rule.url_patterns))
+      continue;
+
+    ++rule_hits_[i];
+    if (rule.cancel) {
+      *result = net::ERR_BLOCKED_BY_CLIENT;
+    } else {
+      *new_url = rule.redirect_url;
+      *result = net::OK;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool AtomNetworkDelegate::ApplyRulesBeforeSendHeaders(
+    net::URLRequest* request,
+    net::HttpRequestHeaders* headers) {
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    const DeclarativeRule& rule = rules_[i];
+    if (rule.set_request_headers.empty() &&
+        rule.remove_request_headers.empty())
+      continue;
+    if (!MatchesFilterCondition(request, rule.url_patterns))
+      continue;
+
+    ++rule_hits_[i];
+    for (const auto& name : rule.remove_request_headers)
+      headers->RemoveHeader(name);
+    for (const auto& header : rule.set_request_headers)
+      headers->SetHeader(header.first, header.second);
+    return true;
+  }
+  return false;
 }
 
 void AtomNetworkDelegate::SetDevToolsNetworkEmulationClientId(
@@ -284,6 +431,10 @@ int AtomNetworkDelegate::OnBeforeURLRequest(
     net::URLRequest* request,
     const net::CompletionCallback& callback,
     GURL* new_url) {
+  int result;
+  if (ApplyRulesBeforeRequest(request, new_url, &result))
+    return result;
+
   if (!base::ContainsKey(response_listeners_, kOnBeforeRequest))
     return brightray::NetworkDelegate::OnBeforeURLRequest(
         request, callback, new_url);
@@ -305,6 +456,9 @@ int AtomNetworkDelegate::OnBeforeStartTransaction(
     headers->SetHeader(
         DevToolsNetworkTransaction::kDevToolsEmulateNetworkConditionsClientId,
         client_id);
+  if (ApplyRulesBeforeSendHeaders(request, headers))
+    return net::OK;
+
   if (!base::ContainsKey(response_listeners_, kOnBeforeSendHeaders))
     return brightray::NetworkDelegate::OnBeforeStartTransaction(
         request, callback, headers);
@@ -418,7 +572,7 @@ int AtomNetworkDelegate::HandleResponseEvent(
     return net::OK;
 
   std::unique_ptr<base::DictionaryValue> details(new base::DictionaryValue);
-  FillDetailsObject(details.get(), request, args...);
+  FillDetailsObject(details.get(), info.options.fields, request, args...);
 
   // The |request| could be destroyed before the |callback| is called.
   callbacks_[request->identifier()] = callback;
@@ -441,13 +595,87 @@ void AtomNetworkDelegate::HandleSimpleEvent(
     return;
 
   std::unique_ptr<base::DictionaryValue> details(new base::DictionaryValue);
-  FillDetailsObject(details.get(), request, args...);
+  FillDetailsObject(details.get(), info.options.fields, request, args...);
+
+  if (!info.options.batch_interval.is_zero()) {
+    AddToBatch(type, info, std::move(details));
+    return;
+  }
 
   BrowserThread::PostTask(
       BrowserThread::UI, FROM_HERE,
       base::Bind(RunSimpleListener, info.listener, base::Passed(&details)));
 }
 
+void AtomNetworkDelegate::AddToBatch(
+    SimpleEvent type,
+    const SimpleListenerInfo& info,
+    std::unique_ptr<base::DictionaryValue> details) {
+  std::unique_ptr<base::DictionaryValue>& batch = pending_batches_[type];
+  if (!batch) {
+    batch.reset(new base::DictionaryValue);
+    batch->SetInteger("length", 0);
+    BrowserThread::PostDelayedTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&AtomNetworkDelegate::OnBatchTimer,
+                   weak_factory_.GetWeakPtr(), type,
+                   batch_generations_[type]),
+        info.options.batch_interval);
+  }
+
+  int length = 0;
+  batch->GetInteger("length", &length);
+  for (base::DictionaryValue::Iterator it(*details); !it.IsAtEnd();
+       it.Advance()) {
+    base::ListValue* column = nullptr;
+    if (!batch->GetListWithoutPathExpansion(it.key(), &column)) {
+      column = new base::ListValue;
+      batch->SetWithoutPathExpansion(it.key(), base::WrapUnique(column));
+    }
+    // Fields missing from earlier events are null.
+    while (static_cast<int>(column->GetSize()) < length)
+      column->Append(base::Value::CreateNullValue());
+    column->Append(it.value().CreateDeepCopy());
+  }
+  batch->SetInteger("length", length + 1);
+}
+
+void AtomNetworkDelegate::OnBatchTimer(SimpleEvent type, uint64_t generation) {
+  // The batch this timer was started for has already been flushed.
+  if (generation != batch_generations_[type])
+    return;
+  FlushBatch(type);
+}
+
+void AtomNetworkDelegate::FlushBatch(SimpleEvent type) {
+  auto batch_it = pending_batches_.find(type);
+  if (batch_it == pending_batches_.end())
+    return;
+  std::unique_ptr<base::DictionaryValue> batch = std::move(batch_it->second);
+  pending_batches_.erase(batch_it);
+  ++batch_generations_[type];
+
+  auto listener_it = simple_listeners_.find(type);
+  if (!batch || listener_it == simple_listeners_.end())
+    return;
+
+  int length = 0;
+  batch->GetInteger("length", &length);
+  for (base::DictionaryValue::Iterator it(*batch); !it.IsAtEnd();
+       it.Advance()) {
+    base::ListValue* column = nullptr;
+    if (!batch->GetListWithoutPathExpansion(it.key(), &column))
+      continue;
+    while (static_cast<int>(column->GetSize()) < length)
+      column->Append(base::Value::CreateNullValue());
+  }
+
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(RunSimpleListener, listener_it->second.listener,
+                 base::Passed(&batch)));
+}
+
 template<typename T>
 void AtomNetworkDelegate::OnListenerResultInIO(
     uint64_t id, T out, std::unique_ptr<base::DictionaryValue> response) {
@@ -9,21 +9,24 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
+#include "atom/browser/net/url_pattern_matcher.h"
+#include "atom/common/native_mate_converters/net_converter.h"
 #include "base/callback.h"
+#include "base/memory/weak_ptr.h"
 #include "base/synchronization/lock.h"
+#include "base/time/time.h"
 #include "base/values.h"
 #include "brightray/browser/network_delegate.h"
 #include "content/public/browser/resource_request_info.h"
-#include "extensions/common/url_pattern.h"
 #include "net/base/net_errors.h"
 #include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
+#include "url/gurl.h"
 
 namespace atom {
 
-using URLPatterns = std::set<URLPattern>;
-
 const char* ResourceTypeToString(content::ResourceType type);
 
 class AtomNetworkDelegate : public brightray::NetworkDelegate {
@@ -47,26 +50,92 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
     kOnHeadersReceived,
   };
 
+  // Fields of the details object, listeners may ask for a subset of them so
+  // the others are never computed.
+  enum DetailsField : uint32_t {
+    kDetailsId = 1 << 0,
+    kDetailsUrl = kRequestDetailsUrl,
+    kDetailsMethod = kRequestDetailsMethod,
+    kDetailsReferrer = kRequestDetailsReferrer,
+    kDetailsUploadData = kRequestDetailsUploadData,
+    kDetailsTimestamp = 1 << 5,
+    kDetailsFirstPartyUrl = 1 << 6,
+    kDetailsResourceType = 1 << 7,
+    kDetailsTabId = 1 << 8,
+    kDetailsRequestHeaders = 1 << 9,
+    kDetailsResponseHeaders = 1 << 10,
+    kDetailsStatusLine = 1 << 11,
+    kDetailsStatusCode = 1 << 12,
+    kDetailsRedirectURL = 1 << 13,
+    kDetailsIp = 1 << 14,
+    kDetailsFromCache = 1 << 15,
+    kDetailsError = 1 << 16,
+    kDetailsAll = 0xffffffff,
+  };
+
+  struct ListenerOptions {
+    ListenerOptions() : fields(kDetailsAll) {}
+
+    // Bitmask of DetailsField.
+    uint32_t fields;
+    // When set, simple events are delivered in batches once per interval.
+    base::TimeDelta batch_interval;
+  };
+
   struct SimpleListenerInfo {
-    URLPatterns url_patterns;
+    URLPatternMatcher url_patterns;
+    ListenerOptions options;
     SimpleListener listener;
   };
 
   struct ResponseListenerInfo {
-    URLPatterns url_patterns;
+    URLPatternMatcher url_patterns;
+    ListenerOptions options;
     ResponseListener listener;
   };
 
+  // A static decision made on the IO thread, requests decided by a rule never
+  // reach the JS listeners of the same event.
+  struct DeclarativeRule {
+    DeclarativeRule();
+    DeclarativeRule(const DeclarativeRule& other);
+    ~DeclarativeRule();
+
+    std::string id;
+    URLPatternMatcher url_patterns;
+    // Decisions for onBeforeRequest.
+    bool cancel;
+    GURL redirect_url;
+    // Decisions for onBeforeSendHeaders.
+    std::map<std::string, std::string> set_request_headers;
+    std::vector<std::string> remove_request_headers;
+  };
+
+  using RuleHitsCallback =
+      base::Callback<void(std::unique_ptr<base::DictionaryValue>)>;
+
   AtomNetworkDelegate();
   ~AtomNetworkDelegate() override;
 
+  // Converts the names of details fields to a DetailsField bitmask, returns
+  // false for unknown names.
+  static bool ParseDetailsFields(const std::vector<std::string>& names,
+                                 uint32_t* fields);
+
   void SetSimpleListenerInIO(SimpleEvent type,
                              const URLPatterns& patterns,
+                             const ListenerOptions& options,
                              const SimpleListener& callback);
   void SetResponseListenerInIO(ResponseEvent type,
                                const URLPatterns& patterns,
+                               const ListenerOptions& options,
                                const ResponseListener& callback);
 
+  // Replaces the declarative rules, the hit counts start over.
+  void SetDeclarativeRulesInIO(const std::vector<DeclarativeRule>& rules);
+  // Runs |callback| on the UI thread with the hit count of each rule id.
+  void GetDeclarativeRuleHitsInIO(const RuleHitsCallback& callback);
+
   void SetDevToolsNetworkEmulationClientId(const std::string& client_id);
 
  protected:
@@ -94,6 +163,14 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
  private:
   void OnErrorOccurred(net::URLRequest* request, bool started);
 
+  // Apply the first matching declarative rule, returns false when no rule
+  // decides the request.
+  bool ApplyRulesBeforeRequest(net::URLRequest* request,
+                               GURL* new_url,
+                               int* result);
+  bool ApplyRulesBeforeSendHeaders(net::URLRequest* request,
+                                   net::HttpRequestHeaders* headers);
+
   template<typename...Args>
   void HandleSimpleEvent(SimpleEvent type,
                          net::URLRequest* request,
@@ -105,6 +182,16 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
                           Out out,
                           Args... args);
 
+  // Appends |details| to the pending batch of |type|, the batch is flushed
+  // to the listener once its interval has elapsed.
+  void AddToBatch(SimpleEvent type,
+                  const SimpleListenerInfo& info,
+                  std::unique_ptr<base::DictionaryValue> details);
+  void FlushBatch(SimpleEvent type);
+  // Flushes the batch of |type| unless the one the timer was started for,
+  // |generation|, has been flushed already.
+  void OnBatchTimer(SimpleEvent type, uint64_t generation);
+
   // Deal with the results of Listener.
   template<typename T>
   void OnListenerResultInIO(
@@ -117,11 +204,24 @@ class AtomNetworkDelegate : public brightray::NetworkDelegate {
   std::map<ResponseEvent, ResponseListenerInfo> response_listeners_;
   std::map<uint64_t, net::CompletionCallback> callbacks_;
 
+  // Simple events waiting to be delivered in one task, stored as one list per
+  // field with the same length as "length".
+  std::map<SimpleEvent, std::unique_ptr<base::DictionaryValue>>
+      pending_batches_;
+  // Bumped every time a batch of the event is flushed.
+  std::map<SimpleEvent, uint64_t> batch_generations_;
+
+  std::vector<DeclarativeRule> rules_;
+  // Hit counts of |rules_|, by index.
+  std::vector<uint64_t> rule_hits_;
+
   base::Lock lock_;
 
   // Client id for devtools network emulation.
   std::string client_id_;
 
+  base::WeakPtrFactory<AtomNetworkDelegate> weak_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(AtomNetworkDelegate);
 };
 
@@ -0,0 +1,94 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/browser/net/url_pattern_matcher.h"
+
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
+#include "url/gurl.h"
+
+namespace atom {
+
+namespace {
+
+// Hosts are compared case-insensitively and without the trailing dot.
+std::string NormalizeHost(base::StringPiece host) {
+  if (host.ends_with("."))
+    host.remove_suffix(1);
+  return base::ToLowerASCII(host);
+}
+
+}  // namespace
+
+URLPatternMatcher::URLPatternMatcher() {
+}
+
+URLPatternMatcher::URLPatternMatcher(const URLPatterns& patterns)
+    : patterns_(patterns.begin(), patterns.end()) {
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    const URLPattern& pattern = patterns_[i];
+    if (pattern.match_all_urls() ||
+        (pattern.match_subdomains() && pattern.host().empty())) {
+      residual_.push_back(i);
+    } else if (pattern.match_subdomains()) {
+      domains_[NormalizeHost(pattern.host())].push_back(i);
+    } else {
+      hosts_[NormalizeHost(pattern.host())].push_back(i);
+    }
+  }
+}
+
+URLPatternMatcher::URLPatternMatcher(const URLPatternMatcher& other) = default;
+
+URLPatternMatcher::~URLPatternMatcher() {
+}
+
+bool URLPatternMatcher::Matches(const GURL& url) const {
+  if (patterns_.empty())
+    return true;
+
+  // URLPattern matches the inner URL of these, do not second-guess it.
+  if (url.SchemeIsFileSystem() || url.SchemeIsBlob()) {
+    for (const auto& pattern : patterns_) {
+      if (pattern.MatchesURL(url))
+        return true;
+    }
+    return false;
+  }
+
+  if (MatchesAny(residual_, url))
+    return true;
+
+  std::string host = NormalizeHost(url.host_piece());
+  auto it = hosts_.find(host);
+  if (it != hosts_.end() && MatchesAny(it->second, url))
+    return true;
+
+  if (domains_.empty())
+    return false;
+
+  // Try the host itself and then each parent domain.
+  size_t pos = 0;
+  while (true) {
+    it = domains_.find(host.substr(pos));
+    if (it != domains_.end() && MatchesAny(it->second, url))
+      return true;
+    pos = host.find('.', pos);
+    if (pos == std::string::npos)
+      break;
+    ++pos;
+  }
+  return false;
+}
+
+bool URLPatternMatcher::MatchesAny(const std::vector<size_t>& candidates,
+                                   const GURL& url) const {
+  for (size_t index : candidates) {
+    if (patterns_[index].MatchesURL(url))
+      return true;
+  }
+  return false;
+}
+
+}  // namespace atom
@@ -0,0 +1,53 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
+#define ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "extensions/common/url_pattern.h"
+
+class GURL;
+
+namespace atom {
+
+using URLPatterns = std::set<URLPattern>;
+
+// Matches URLs against a set of URLPatterns without testing every pattern.
+// Patterns are indexed by host once, a lookup only runs URLPattern::MatchesURL
+// on the patterns whose host can match plus the few that match any host.
+class URLPatternMatcher {
+ public:
+  URLPatternMatcher();
+  explicit URLPatternMatcher(const URLPatterns& patterns);
+  URLPatternMatcher(const URLPatternMatcher& other);
+  ~URLPatternMatcher();
+
+  // Whether |url| matches any of the patterns, an empty matcher matches all.
+  bool Matches(const GURL& url) const;
+
+  bool empty() const { return patterns_.empty(); }
+  size_t size() const { return patterns_.size(); }
+
+ private:
+  typedef std::unordered_map<std::string, std::vector<size_t>> HostIndex;
+
+  bool MatchesAny(const std::vector<size_t>& candidates, const GURL& url) const;
+
+  std::vector<URLPattern> patterns_;
+  // Patterns matching exactly one host, keyed by that host.
+  HostIndex hosts_;
+  // Patterns matching a domain and its subdomains, keyed by the domain.
+  HostIndex domains_;
+  // Patterns matching any host, always tested.
+  std::vector<size_t> residual_;
+};
+
+}  // namespace atom
+
+#endif  // ATOM_BROWSER_NET_URL_PATTERN_MATCHER_H_
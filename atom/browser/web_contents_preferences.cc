@@ -5,6 +5,7 @@
 #include "atom/browser/web_contents_preferences.h"
 
 #include <algorithm>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -12,8 +13,10 @@
 #include "atom/common/native_mate_converters/value_converter.h"
 #include "base/strings/string_number_conversions.h"
 #include "cc/base/switches.h"
+#include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/render_process_host.h"
 #include "content/public/browser/render_view_host.h"
+#include "content/public/common/child_process_host.h"
 #include "content/public/common/content_switches.h"
 #include "content/public/common/web_preferences.h"
 #include "native_mate/dictionary.h"
@@ -28,12 +31,15 @@ DEFINE_WEB_CONTENTS_USER_DATA_KEY(atom::WebContentsPreferences);
 namespace atom {
 
 // static
-std::vector<WebContentsPreferences*> WebContentsPreferences::instances_;
+std::map<int, std::vector<WebContentsPreferences*>>
+    WebContentsPreferences::instances_;
 
 WebContentsPreferences::WebContentsPreferences(
     content::WebContents* web_contents,
     const mate::Dictionary& web_preferences)
-    : web_contents_(web_contents) {
+    : content::WebContentsObserver(web_contents),
+      web_contents_(web_contents),
+      process_id_(content::ChildProcessHost::kInvalidUniqueID) {
   v8::Isolate* isolate = web_preferences.isolate();
   mate::Dictionary copied(isolate, web_preferences.GetHandle()->Clone());
   // Following fields should not be stored.
@@ -44,13 +50,51 @@ WebContentsPreferences::WebContentsPreferences(
   mate::ConvertFromV8(isolate, copied.GetHandle(), &web_preferences_);
   web_contents->SetUserData(UserDataKey(), this);
 
-  instances_.push_back(this);
+  UpdateProcessID();
 }
 
 WebContentsPreferences::~WebContentsPreferences() {
-  instances_.erase(
-      std::remove(instances_.begin(), instances_.end(), this),
-      instances_.end());
+  RemoveFromProcessIndex();
+}
+
+void WebContentsPreferences::RenderViewCreated(
+    content::RenderViewHost* render_view_host) {
+  UpdateProcessID();
+}
+
+void WebContentsPreferences::RenderViewHostChanged(
+    content::RenderViewHost* old_host,
+    content::RenderViewHost* new_host) {
+  UpdateProcessID();
+}
+
+void WebContentsPreferences::RenderFrameHostChanged(
+    content::RenderFrameHost* old_host,
+    content::RenderFrameHost* new_host) {
+  if (!new_host->GetParent())
+    UpdateProcessID();
+}
+
+void WebContentsPreferences::UpdateProcessID() {
+  int process_id = web_contents_->GetRenderProcessHost()->GetID();
+  if (process_id == process_id_)
+    return;
+
+  RemoveFromProcessIndex();
+  process_id_ = process_id;
+  instances_[process_id_].push_back(this);
+}
+
+void WebContentsPreferences::RemoveFromProcessIndex() {
+  auto it = instances_.find(process_id_);
+  if (it == instances_.end())
+    return;
+
+  std::vector<WebContentsPreferences*>& instances = it->second;
+  instances.erase(std::remove(instances.begin(), instances.end(), this),
+                  instances.end());
+  if (instances.empty())
+    instances_.erase(it);
 }
 
 void WebContentsPreferences::Merge(const base::DictionaryValue& extend) {
@@ -60,10 +104,13 @@ void WebContentsPreferences::Merge(const base::DictionaryValue& extend) {
 // static
 content::WebContents* WebContentsPreferences::GetWebContentsFromProcessID(
     int process_id) {
-  for (WebContentsPreferences* preferences : instances_) {
-    content::WebContents* web_contents = preferences->web_contents_;
-    if (web_contents->GetRenderProcessHost()->GetID() == process_id)
-      return web_contents;
+  auto it = instances_.find(process_id);
+  if (it != instances_.end()) {
+    for (WebContentsPreferences* preferences : it->second) {
+      content::WebContents* web_contents = preferences->web_contents_;
+      if (web_contents->GetRenderProcessHost()->GetID() == process_id)
+        return web_contents;
+    }
   }
   // Also try to get the webview from RenderViewHost::FromID because
   // not all web contents have preferences created (devtools).
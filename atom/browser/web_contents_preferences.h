@@ -5,11 +5,13 @@
 #ifndef ATOM_BROWSER_WEB_CONTENTS_PREFERENCES_H_
 #define ATOM_BROWSER_WEB_CONTENTS_PREFERENCES_H_
 
+#include <map>
 #include <vector>
 
 #include "atom/common/options_switches.h"
 #include "base/command_line.h"
 #include "base/values.h"
+#include "content/public/browser/web_contents_observer.h"
 #include "content/public/browser/web_contents_user_data.h"
 #include "content/public/common/content_switches.h"
 
@@ -29,7 +31,8 @@ namespace atom {
 
 // Stores and applies the preferences of WebContents.
 class WebContentsPreferences
-    : public content::WebContentsUserData<WebContentsPreferences> {
+    : public content::WebContentsUserData<WebContentsPreferences>,
+      public content::WebContentsObserver {
  public:
   // Get WebContents according to process ID.
   // FIXME(zcbenz): This method does not belong here.
@@ -53,12 +56,27 @@ class WebContentsPreferences
   // Returns the web preferences.
   base::DictionaryValue* web_preferences() { return &web_preferences_; }
 
+ protected:
+  // content::WebContentsObserver:
+  void RenderViewCreated(content::RenderViewHost* render_view_host) override;
+  void RenderViewHostChanged(content::RenderViewHost* old_host,
+                             content::RenderViewHost* new_host) override;
+  void RenderFrameHostChanged(content::RenderFrameHost* old_host,
+                              content::RenderFrameHost* new_host) override;
+
  private:
   friend class content::WebContentsUserData<WebContentsPreferences>;
 
-  static std::vector<WebContentsPreferences*> instances_;
+  // Moves |this| to the current render process of |web_contents_| in
+  // |instances_|.
+  void UpdateProcessID();
+  void RemoveFromProcessIndex();
+
+  // Instances by the id of the render process they were last seen in.
+  static std::map<int, std::vector<WebContentsPreferences*>> instances_;
 
   content::WebContents* web_contents_;
+  int process_id_;
   base::DictionaryValue web_preferences_;
 
   DISALLOW_COPY_AND_ASSIGN(WebContentsPreferences);
@@ -4,6 +4,7 @@
 
 // Multiply-included file, no traditional include guard.
 
+#include "atom/common/api/serialized_value.h"
 #include "base/strings/string16.h"
 #include "base/memory/shared_memory.h"
 #include "base/values.h"
@@ -34,11 +35,68 @@ IPC_MESSAGE_ROUTED2(AtomViewMsg_Message_Shared,
                     base::string16 /* channel */,
                     base::SharedMemoryHandle /* arguments */)
 
+IPC_STRUCT_TRAITS_BEGIN(atom::SerializedValue)
+  IPC_STRUCT_TRAITS_MEMBER(data)
+  IPC_STRUCT_TRAITS_MEMBER(array_buffers)
+IPC_STRUCT_TRAITS_END()
+
+// Messages carrying a structured clone of their argument instead of a
+// base::ListValue.
+IPC_MESSAGE_ROUTED2(AtomViewHostMsg_Message_Serialized,
+                    base::string16 /* channel */,
+                    atom::SerializedValue /* message */)
+
+IPC_SYNC_MESSAGE_ROUTED2_1(AtomViewHostMsg_Message_Serialized_Sync,
+                           base::string16 /* channel */,
+                           atom::SerializedValue /* message */,
+                           atom::SerializedValue /* result */)
+
+IPC_MESSAGE_ROUTED3(AtomViewMsg_Message_Serialized,
+                    bool /* send_to_all */,
+                    base::string16 /* channel */,
+                    atom::SerializedValue /* message */)
+
+// Messages on a channel between a V8 worker and a renderer. They are sent
+// and received on the IO thread and never go through the browser UI thread.
+IPC_MESSAGE_ROUTED1(AtomViewMsg_WorkerPortConnect,
+                    int /* channel_id */)
+
+IPC_MESSAGE_ROUTED1(AtomViewMsg_WorkerPortClose,
+                    int /* channel_id */)
+
+IPC_MESSAGE_ROUTED2(AtomViewMsg_WorkerPortMessage,
+                    int /* channel_id */,
+                    std::vector<uint8_t> /* message */)
+
+// Large worker messages are copied to shared memory instead of the channel.
+IPC_MESSAGE_ROUTED3(AtomViewMsg_WorkerPortMessage_Shared,
+                    int /* channel_id */,
+                    base::SharedMemoryHandle /* message */,
+                    uint32_t /* size */)
+
+IPC_MESSAGE_ROUTED2(AtomViewHostMsg_WorkerPortMessage,
+                    int /* channel_id */,
+                    std::vector<uint8_t> /* message */)
+
+IPC_MESSAGE_ROUTED1(AtomViewHostMsg_WorkerPortClose,
+                    int /* channel_id */)
+
 // Update renderer process preferences.
 IPC_MESSAGE_CONTROL1(AtomMsg_UpdatePreferences, base::ListValue)
 
-// Update renderer content settings
-IPC_MESSAGE_CONTROL1(AtomMsg_UpdateContentSettings, base::DictionaryValue)
+// Replace renderer content settings
+IPC_MESSAGE_CONTROL2(AtomMsg_UpdateContentSettings,
+                     int /* version */,
+                     base::DictionaryValue /* content_settings */)
+
+// Apply changes to renderer content settings at |base_version|, producing
+// |base_version| + 1
+IPC_MESSAGE_CONTROL2(AtomMsg_UpdateContentSettingsDelta,
+                     int /* base_version */,
+                     base::ListValue /* changes */)
+
+// Ask for all content settings after a delta with the wrong base version
+IPC_MESSAGE_CONTROL0(AtomHostMsg_RequestContentSettings)
 
 // Update renderer content settings
 IPC_MESSAGE_CONTROL1(AtomMsg_UpdateWebKitPrefs, content::WebPreferences)
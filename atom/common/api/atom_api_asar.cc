@@ -9,6 +9,7 @@
 #include "atom_natives.h"  // NOLINT: This file is generated with coffee2c.
 
 #include "atom/common/asar/archive.h"
+#include "atom/common/asar/asar_util.h"
 #include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/file_path_converter.h"
 #include "atom/common/node_includes.h"
@@ -23,10 +24,11 @@ class Archive : public mate::Wrappable<Archive> {
  public:
   static v8::Local<v8::Value> Create(v8::Isolate* isolate,
                                       const base::FilePath& path) {
-    std::unique_ptr<asar::Archive> archive(new asar::Archive(path));
-    if (!archive->Init())
+    std::shared_ptr<asar::Archive> archive =
+        asar::GetOrCreateAsarArchive(path);
+    if (!archive)
       return v8::False(isolate);
-    return (new Archive(isolate, std::move(archive)))->GetWrapper();
+    return (new Archive(isolate, archive))->GetWrapper();
   }
 
   static void BuildPrototype(
@@ -39,13 +41,15 @@ class Archive : public mate::Wrappable<Archive> {
         .SetMethod("readdir", &Archive::Readdir)
         .SetMethod("realpath", &Archive::Realpath)
         .SetMethod("copyFileOut", &Archive::CopyFileOut)
+        .SetMethod("readFile", &Archive::ReadFile)
+        .SetMethod("readFileUtf8", &Archive::ReadFileUtf8)
         .SetMethod("getFd", &Archive::GetFD)
         .SetMethod("destroy", &Archive::Destroy);
   }
 
  protected:
-  Archive(v8::Isolate* isolate, std::unique_ptr<asar::Archive> archive)
-      : archive_(std::move(archive)) {
+  Archive(v8::Isolate* isolate, std::shared_ptr<asar::Archive> archive)
+      : archive_(archive) {
     Init(isolate);
   }
 
@@ -63,6 +67,9 @@ class Archive : public mate::Wrappable<Archive> {
     mate::Dictionary dict(isolate, v8::Object::New(isolate));
     dict.Set("size", info.size);
     dict.Set("unpacked", info.unpacked);
+    dict.Set("compressed", info.compressed);
+    if (info.compressed)
+      dict.Set("compressedSize", info.compressed_size);
     dict.Set("offset", info.offset);
     return dict.GetHandle();
   }
@@ -109,6 +116,47 @@ class Archive : public mate::Wrappable<Archive> {
     return mate::ConvertToV8(isolate, new_path);
   }
 
+  // Reads a packed file into a Buffer, copying straight from the mapping.
+  // Compressed files are inflated.
+  v8::Local<v8::Value> ReadFile(v8::Isolate* isolate,
+                                 const base::FilePath& path) {
+    if (!archive_)
+      return v8::False(isolate);
+    base::StringPiece contents;
+    std::string inflated;
+    if (!archive_->GetMappedContents(path, &contents)) {
+      if (!IsCompressed(path) || !archive_->ReadFile(path, &inflated))
+        return v8::False(isolate);
+      contents = inflated;
+    }
+    return node::Buffer::Copy(isolate, contents.data(), contents.size())
+        .ToLocalChecked();
+  }
+
+  // Reads a packed file as a string, ASCII files are not copied at all.
+  v8::Local<v8::Value> ReadFileUtf8(v8::Isolate* isolate,
+                                     const base::FilePath& path) {
+    if (!archive_)
+      return v8::False(isolate);
+    base::StringPiece contents;
+    if (!archive_->GetMappedContents(path, &contents)) {
+      std::string inflated;
+      if (!IsCompressed(path) || !archive_->ReadFile(path, &inflated))
+        return v8::False(isolate);
+      return mate::ConvertToV8(isolate, inflated);
+    }
+    v8::Local<v8::String> result =
+        asar::MappedContentsToV8String(isolate, *archive_, contents);
+    if (result.IsEmpty())
+      return v8::False(isolate);
+    return result;
+  }
+
+  bool IsCompressed(const base::FilePath& path) {
+    asar::Archive::FileInfo info;
+    return archive_->GetFileInfo(path, &info) && info.compressed;
+  }
+
   // Return the file descriptor.
   int GetFD() const {
     if (!archive_)
@@ -116,13 +164,14 @@ class Archive : public mate::Wrappable<Archive> {
     return archive_->GetFD();
   }
 
-  // Free the resources used by archive.
+  // Release the archive, it is closed once the cache evicts it too.
   void Destroy() {
     archive_.reset();
   }
 
  private:
-  std::unique_ptr<asar::Archive> archive_;
+  // Shared with every other user of the process-wide archive cache.
+  std::shared_ptr<asar::Archive> archive_;
 
   DISALLOW_COPY_AND_ASSIGN(Archive);
 };
@@ -153,10 +202,26 @@ void InitAsarSupport(v8::Isolate* isolate,
   }
 }
 
+v8::Local<v8::Value> GetArchiveCacheStats(v8::Isolate* isolate) {
+  asar::ArchiveCacheStats stats = asar::GetAsarArchiveCacheStats();
+  mate::Dictionary dict(isolate, v8::Object::New(isolate));
+  dict.Set("hits", stats.hits);
+  dict.Set("misses", stats.misses);
+  dict.Set("evictions", stats.evictions);
+  dict.Set("invalidations", stats.invalidations);
+  dict.Set("size", stats.size);
+  dict.Set("mappedRequests", stats.mapped_requests);
+  dict.Set("streamedRequests", stats.streamed_requests);
+  return dict.GetHandle();
+}
+
 void Initialize(v8::Local<v8::Object> exports, v8::Local<v8::Value> unused,
                 v8::Local<v8::Context> context, void* priv) {
   mate::Dictionary dict(context->GetIsolate(), exports);
   dict.SetMethod("createArchive", &Archive::Create);
+  dict.SetMethod("invalidateArchive", &asar::InvalidateAsarArchive);
+  dict.SetMethod("invalidateStaleArchives", &asar::InvalidateStaleAsarArchives);
+  dict.SetMethod("getArchiveCacheStats", &GetArchiveCacheStats);
   dict.SetMethod("initAsarSupport", &InitAsarSupport);
 }
 
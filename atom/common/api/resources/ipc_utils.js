@@ -24,12 +24,65 @@ if (!ipcRenderer) {
     return ipc.send('ipc-message-host', $Array.slice(args))
   }
 
+  // |message| is sent as a structured clone, ArrayBuffers in |transfer| are
+  // sent beside it
+  ipcRenderer.postMessage = function (channel, message, transfer) {
+    return ipc.postMessage(channel, message, transfer)
+  }
+
+  ipcRenderer.postMessageSync = function (channel, message, transfer) {
+    return ipc.postMessageSync(channel, message, transfer)
+  }
+
   ipcRenderer.emit = function () {
     if (arguments[1]) {
       arguments[1].sender = ipcRenderer
     }
     return $Function.apply(EventEmitter.prototype.emit, ipcRenderer, arguments)
   }
+  // Ends of app.createMessageChannel channels connected to this page, the
+  // messages don't go through the main process
+  var workerPorts = {}
+
+  var WorkerPort = function (id) {
+    this.id = id
+    this.onmessage = null
+    this.onclose = null
+  }
+  WorkerPort.prototype = new EventEmitter
+
+  WorkerPort.prototype.postMessage = function (message) {
+    return ipc.workerPortPostMessage(this.id, message)
+  }
+
+  WorkerPort.prototype.close = function () {
+    ipc.workerPortClose(this.id)
+  }
+
+  ipcRenderer.on('ELECTRON_WORKER_PORT_CONNECT', function (event, id) {
+    var port = new WorkerPort(id)
+    workerPorts[id] = port
+    ipcRenderer.emit('worker-port', {}, port)
+  })
+
+  ipcRenderer.on('ELECTRON_WORKER_PORT_MESSAGE', function (event, id, data) {
+    var port = workerPorts[id]
+    if (!port)
+      return
+    var messageEvent = {data: data}
+    port.emit('message', messageEvent)
+    port.onmessage && port.onmessage(messageEvent)
+  })
+
+  ipcRenderer.on('ELECTRON_WORKER_PORT_CLOSE', function (event, id) {
+    var port = workerPorts[id]
+    if (!port)
+      return
+    delete workerPorts[id]
+    port.emit('close', {})
+    port.onclose && port.onclose({})
+  })
+
   atom.v8.setHiddenValue('ipc', ipcRenderer)
 }
 
@@ -52,5 +105,7 @@ exports.$set('once', ipcRenderer.once.bind(ipcRenderer))
 exports.$set('send', ipcRenderer.send.bind(ipcRenderer))
 exports.$set('sendSync', ipcRenderer.sendSync.bind(ipcRenderer))
 exports.$set('sendToHost', ipcRenderer.sendToHost.bind(ipcRenderer))
+exports.$set('postMessage', ipcRenderer.postMessage.bind(ipcRenderer))
+exports.$set('postMessageSync', ipcRenderer.postMessageSync.bind(ipcRenderer))
 exports.$set('emit', ipcRenderer.emit.bind(ipcRenderer))
 
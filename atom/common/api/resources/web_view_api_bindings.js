@@ -73,6 +73,8 @@ var WEB_VIEW_API_METHODS = [
   // Returns Chrome's internal process ID for the guest web page's current
   // process.
   'getProcessId',
+  // Limits the DOM events fired on the webview to the given event names.
+  'setEventFilter',
 ].concat(asyncMethods).concat(syncMethods)
 
 asyncMethods.forEach((method) => {
@@ -151,6 +153,16 @@ WebViewImpl.prototype.attachGuest = function (guestInstanceId) {
 WebViewImpl.prototype.setTabId = function (tabID) {
   this.tabID = tabID
   GuestViewInternal.registerEvents(this, tabID)
+  if (this.eventFilter_) {
+    GuestViewInternal.setEventFilter(tabID, this.eventFilter_)
+  }
+}
+
+WebViewImpl.prototype.setEventFilter = function (events) {
+  this.eventFilter_ = Array.isArray(events) ? events : null
+  if (this.tabID) {
+    GuestViewInternal.setEventFilter(this.tabID, this.eventFilter_)
+  }
 }
 
 WebViewImpl.prototype.getId = function () {
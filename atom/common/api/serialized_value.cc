@@ -0,0 +1,96 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "atom/common/api/serialized_value.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <utility>
+
+namespace atom {
+
+SerializedValue::SerializedValue() {}
+
+SerializedValue::SerializedValue(const SerializedValue& other) = default;
+
+SerializedValue::~SerializedValue() {}
+
+bool GetTransferList(v8::Isolate* isolate,
+                     v8::Local<v8::Value> transfer_list,
+                     std::vector<v8::Local<v8::ArrayBuffer>>* out) {
+  if (transfer_list.IsEmpty() || transfer_list->IsUndefined())
+    return true;
+
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  if (transfer_list->IsArray()) {
+    v8::Local<v8::Array> array = transfer_list.As<v8::Array>();
+    for (uint32_t i = 0; i < array->Length(); ++i) {
+      v8::Local<v8::Value> buffer;
+      if (!array->Get(context, i).ToLocal(&buffer))
+        return false;
+      if (!buffer->IsArrayBuffer())
+        break;
+      out->push_back(buffer.As<v8::ArrayBuffer>());
+    }
+    if (out->size() == array->Length())
+      return true;
+  }
+
+  isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8(
+      isolate, "`transferList` must be an array of ArrayBuffers")));
+  return false;
+}
+
+bool SerializeValue(v8::Isolate* isolate,
+                    v8::Local<v8::Value> value,
+                    v8::Local<v8::Value> transfer_list,
+                    SerializedValue* out) {
+  std::vector<v8::Local<v8::ArrayBuffer>> transfer;
+  if (!GetTransferList(isolate, transfer_list, &transfer))
+    return false;
+
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::ValueSerializer serializer(isolate);
+  serializer.WriteHeader();
+  for (size_t i = 0; i < transfer.size(); ++i)
+    serializer.TransferArrayBuffer(static_cast<uint32_t>(i), transfer[i]);
+
+  if (!serializer.WriteValue(context, value).FromMaybe(false))
+    return false;
+
+  std::pair<uint8_t*, size_t> buffer = serializer.Release();
+  out->data.assign(buffer.first, buffer.first + buffer.second);
+  free(buffer.first);
+
+  out->array_buffers.resize(transfer.size());
+  for (size_t i = 0; i < transfer.size(); ++i) {
+    v8::ArrayBuffer::Contents contents = transfer[i]->GetContents();
+    const uint8_t* bytes = static_cast<const uint8_t*>(contents.Data());
+    out->array_buffers[i].assign(bytes, bytes + contents.ByteLength());
+  }
+  return true;
+}
+
+v8::MaybeLocal<v8::Value> DeserializeValue(v8::Isolate* isolate,
+                                           const SerializedValue& value) {
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::ValueDeserializer deserializer(
+      isolate, value.data.data(), value.data.size());
+  if (!deserializer.ReadHeader(context).FromMaybe(false))
+    return v8::MaybeLocal<v8::Value>();
+
+  for (size_t i = 0; i < value.array_buffers.size(); ++i) {
+    const std::vector<uint8_t>& bytes = value.array_buffers[i];
+    v8::Local<v8::ArrayBuffer> buffer =
+        v8::ArrayBuffer::New(isolate, bytes.size());
+    if (!bytes.empty())
+      memcpy(buffer->GetContents().Data(), bytes.data(), bytes.size());
+    deserializer.TransferArrayBuffer(static_cast<uint32_t>(i), buffer);
+  }
+
+  return deserializer.ReadValue(context);
+}
+
+}  // namespace atom
@@ -0,0 +1,49 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_API_SERIALIZED_VALUE_H_
+#define ATOM_COMMON_API_SERIALIZED_VALUE_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "v8/include/v8.h"
+
+namespace atom {
+
+// A value written with v8::ValueSerializer. The contents of transferred
+// ArrayBuffers are kept beside the serialized data instead of inside it.
+struct SerializedValue {
+  SerializedValue();
+  SerializedValue(const SerializedValue& other);
+  ~SerializedValue();
+
+  std::vector<uint8_t> data;
+  std::vector<std::vector<uint8_t>> array_buffers;
+};
+
+// Reads |transfer_list|, which is empty, undefined or an array of
+// ArrayBuffers, into |out|. Returns false with an exception pending in
+// |isolate| if it is anything else.
+bool GetTransferList(v8::Isolate* isolate,
+                     v8::Local<v8::Value> transfer_list,
+                     std::vector<v8::Local<v8::ArrayBuffer>>* out);
+
+// Serializes |value| with the structured clone algorithm. |transfer_list|
+// is empty, undefined or an array of ArrayBuffers to send beside the data.
+// Returns false with an exception pending in |isolate| if |value| can't be
+// cloned.
+bool SerializeValue(v8::Isolate* isolate,
+                    v8::Local<v8::Value> value,
+                    v8::Local<v8::Value> transfer_list,
+                    SerializedValue* out);
+
+// Reads a value written by SerializeValue in the current context.
+v8::MaybeLocal<v8::Value> DeserializeValue(v8::Isolate* isolate,
+                                           const SerializedValue& value);
+
+}  // namespace atom
+
+#endif  // ATOM_COMMON_API_SERIALIZED_VALUE_H_
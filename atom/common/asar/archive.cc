@@ -4,6 +4,9 @@
 
 #include "atom/common/asar/archive.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -11,11 +14,13 @@
 #include "atom/common/asar/scoped_temporary_file.h"
 #include "base/files/file.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/json/json_reader.h"
 #include "base/logging.h"
 #include "base/pickle.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/values.h"
+#include "third_party/zlib/zlib.h"
 
 #if defined(OS_WIN)
 #include "atom/node/osfhandle.h"
@@ -33,64 +38,10 @@ const char kSeparators[] = "\\/";
 const char kSeparators[] = "/";
 #endif
 
-bool GetNodeFromPath(std::string path,
-                     const base::DictionaryValue* root,
-                     const base::DictionaryValue** out);
-
-// Gets the "files" from "dir".
-bool GetFilesNode(const base::DictionaryValue* root,
-                  const base::DictionaryValue* dir,
-                  const base::DictionaryValue** out) {
-  // Test for symbol linked directory.
-  std::string link;
-  if (dir->GetStringWithoutPathExpansion("link", &link)) {
-    const base::DictionaryValue* linked_node = nullptr;
-    if (!GetNodeFromPath(link, root, &linked_node))
-      return false;
-    dir = linked_node;
-  }
-
-  return dir->GetDictionaryWithoutPathExpansion("files", out);
-}
-
-// Gets sub-file "name" from "dir".
-bool GetChildNode(const base::DictionaryValue* root,
-                  const std::string& name,
-                  const base::DictionaryValue* dir,
-                  const base::DictionaryValue** out) {
-  if (name == "") {
-    *out = root;
-    return true;
-  }
-
-  const base::DictionaryValue* files = nullptr;
-  return GetFilesNode(root, dir, &files) &&
-         files->GetDictionaryWithoutPathExpansion(name, out);
-}
-
-// Gets the node of "path" from "root".
-bool GetNodeFromPath(std::string path,
-                     const base::DictionaryValue* root,
-                     const base::DictionaryValue** out) {
-  if (path == "") {
-    *out = root;
-    return true;
-  }
-
-  const base::DictionaryValue* dir = root;
-  for (size_t delimiter_position = path.find_first_of(kSeparators);
-       delimiter_position != std::string::npos;
-       delimiter_position = path.find_first_of(kSeparators)) {
-    const base::DictionaryValue* child = nullptr;
-    if (!GetChildNode(root, path.substr(0, delimiter_position), dir, &child))
-      return false;
-
-    dir = child;
-    path.erase(0, delimiter_position + 1);
-  }
-
-  return GetChildNode(root, path, dir, out);
-}
+// Values of Node::link_target that do not refer to a node.
+const uint32_t kNoNode = static_cast<uint32_t>(-1);
+const uint32_t kUnresolved = static_cast<uint32_t>(-2);
+const uint32_t kResolving = static_cast<uint32_t>(-3);
 
 bool FillFileInfoWithNode(Archive::FileInfo* info,
                           uint32_t header_size,
@@ -112,11 +63,53 @@ bool FillFileInfoWithNode(Archive::FileInfo* info,
 
   node->GetBoolean("executable", &info->executable);
 
+  std::string compression;
+  if (node->GetString("compression", &compression)) {
+    int compressed_size;
+    if (compression != "gzip" ||
+        !node->GetInteger("compressedSize", &compressed_size))
+      return false;
+    info->compressed = true;
+    info->compressed_size = static_cast<uint32_t>(compressed_size);
+  }
+
   return true;
 }
 
+// Inflates the gzip stream |input| into |output|, which must come out as
+// |size| bytes.
+bool InflateGzip(base::StringPiece input, uint32_t size, std::string* output) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // Adding 16 to the window bits makes zlib expect a gzip header.
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+    return false;
+
+  output->resize(size);
+  char empty;
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = static_cast<uInt>(input.size());
+  stream.next_out = reinterpret_cast<Bytef*>(size ? &(*output)[0] : &empty);
+  stream.avail_out = size;
+  int result = inflate(&stream, Z_FINISH);
+  bool success = result == Z_STREAM_END && stream.total_out == size;
+  inflateEnd(&stream);
+  return success;
+}
+
 }  // namespace
 
+Archive::Node::Node()
+    : type(INVALID),
+      name_offset(0),
+      name_size(0),
+      link_offset(0),
+      link_size(0),
+      link_target(kNoNode),
+      first_child(0),
+      child_count(0) {
+}
+
 Archive::Archive(const base::FilePath& path)
     : path_(path),
       file_(path_, base::File::FLAG_OPEN | base::File::FLAG_READ),
@@ -151,6 +144,11 @@ bool Archive::Init() {
     return false;
   }
 
+  if (!file_.GetInfo(&file_info_)) {
+    PLOG(ERROR) << "Failed to get info of " << path_.value();
+    return false;
+  }
+
   std::vector<char> buf;
   int len;
 
@@ -191,80 +189,248 @@ bool Archive::Init() {
   }
 
   header_size_ = 8 + size;
-  header_.reset(static_cast<base::DictionaryValue*>(value.release()));
+  if (!Compile(static_cast<base::DictionaryValue*>(value.get()))) {
+    LOG(ERROR) << "Failed to compile header of " << path_.value();
+    nodes_.clear();
+    names_.clear();
+    return false;
+  }
   return true;
 }
 
-bool Archive::GetFileInfo(const base::FilePath& path, FileInfo* info) {
-  if (!header_)
+bool Archive::Map() {
+  if (mapped_file_)
+    return true;
+  if (nodes_.empty())
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  std::shared_ptr<base::MemoryMappedFile> mapped_file(
+      new base::MemoryMappedFile);
+  if (!mapped_file->Initialize(file_.Duplicate())) {
+    LOG(WARNING) << "Failed to map " << path_.value();
     return false;
+  }
 
-  std::string link;
-  if (node->GetString("link", &link))
-    return GetFileInfo(base::FilePath::FromUTF8Unsafe(link), info);
+  mapped_file_ = mapped_file;
+  return true;
+}
+
+bool Archive::Compile(const base::DictionaryValue* root) {
+  typedef std::pair<base::StringPiece, const base::DictionaryValue*> Entry;
+
+  // The dictionary each node was created from, indexed like |nodes_|.
+  std::vector<const base::DictionaryValue*> dicts;
+  // Names repeat a lot (index.js, package.json...), so store each one once.
+  std::unordered_map<std::string, uint32_t> interned;
+  auto intern = [this, &interned](const std::string& name) {
+    auto result = interned.insert(
+        std::make_pair(name, static_cast<uint32_t>(names_.size())));
+    if (result.second)
+      names_.append(name);
+    return result.first->second;
+  };
+
+  nodes_.push_back(Node());
+  dicts.push_back(root);
+  std::vector<Entry> children;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    const base::DictionaryValue* dict = dicts[i];
+
+    std::string link;
+    const base::DictionaryValue* files = nullptr;
+    if (dict->GetStringWithoutPathExpansion("link", &link)) {
+      Node& node = nodes_[i];
+      node.type = Node::LINK;
+      node.link_offset = intern(link);
+      node.link_size = static_cast<uint32_t>(link.size());
+      node.link_target = kUnresolved;
+    } else if (dict->GetDictionaryWithoutPathExpansion("files", &files)) {
+      children.clear();
+      for (base::DictionaryValue::Iterator it(*files); !it.IsAtEnd();
+           it.Advance()) {
+        const base::DictionaryValue* child = nullptr;
+        if (!it.value().GetAsDictionary(&child))
+          return false;
+        children.push_back(Entry(it.key(), child));
+      }
+      // Lookups binary search the children by name.
+      std::sort(children.begin(), children.end(),
+                [](const Entry& a, const Entry& b) {
+                  return a.first < b.first;
+                });
+
+      if (nodes_.size() + children.size() >= kResolving)
+        return false;
+      nodes_[i].type = Node::DIRECTORY;
+      nodes_[i].first_child = static_cast<uint32_t>(nodes_.size());
+      nodes_[i].child_count = static_cast<uint32_t>(children.size());
+      for (const Entry& entry : children) {
+        Node child;
+        child.name_offset = intern(entry.first.as_string());
+        child.name_size = static_cast<uint32_t>(entry.first.size());
+        nodes_.push_back(child);
+        dicts.push_back(entry.second);
+      }
+    } else if (FillFileInfoWithNode(&nodes_[i].info, header_size_, dict)) {
+      nodes_[i].type = Node::FILE;
+    }
+  }
 
-  return FillFileInfoWithNode(info, header_size_, node);
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (nodes_[i].type == Node::LINK)
+      ResolveLink(static_cast<uint32_t>(i));
+  }
+  return true;
 }
 
-bool Archive::Stat(const base::FilePath& path, Stats* stats) {
-  if (!header_)
+uint32_t Archive::ResolveLink(uint32_t index) {
+  uint32_t target = nodes_[index].link_target;
+  if (target == kResolving)  // Cyclic links.
+    return kNoNode;
+  if (target != kUnresolved)
+    return target;
+
+  nodes_[index].link_target = kResolving;
+  if (!GetNode(NodeLink(nodes_[index]), &target))
+    target = kNoNode;
+  else if (nodes_[target].type == Node::LINK)
+    target = ResolveLink(target);
+  nodes_[index].link_target = target;
+  return target;
+}
+
+bool Archive::GetChildNode(uint32_t dir, base::StringPiece name,
+                           uint32_t* out) {
+  if (name.empty()) {
+    *out = 0;
+    return true;
+  }
+
+  if (nodes_[dir].type == Node::LINK) {
+    dir = ResolveLink(dir);
+    if (dir == kNoNode)
+      return false;
+  }
+
+  const Node& node = nodes_[dir];
+  if (node.type != Node::DIRECTORY)
+    return false;
+
+  auto begin = nodes_.begin() + node.first_child;
+  auto end = begin + node.child_count;
+  auto it = std::lower_bound(begin, end, name,
+                             [this](const Node& child, base::StringPiece key) {
+                               return NodeName(child) < key;
+                             });
+  if (it == end || NodeName(*it) != name)
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  *out = static_cast<uint32_t>(it - nodes_.begin());
+  return true;
+}
+
+bool Archive::GetNode(base::StringPiece path, uint32_t* out) {
+  if (nodes_.empty())
     return false;
 
-  if (node->HasKey("link")) {
-    stats->is_file = false;
-    stats->is_link = true;
+  uint32_t node = 0;
+  if (path.empty()) {
+    *out = node;
     return true;
   }
 
-  if (node->HasKey("files")) {
-    stats->is_file = false;
-    stats->is_directory = true;
-    return true;
+  size_t start = 0;
+  while (true) {
+    size_t delimiter_position = path.find_first_of(kSeparators, start);
+    base::StringPiece name = path.substr(
+        start, delimiter_position == base::StringPiece::npos ?
+            base::StringPiece::npos : delimiter_position - start);
+    if (!GetChildNode(node, name, &node))
+      return false;
+    if (delimiter_position == base::StringPiece::npos)
+      break;
+    start = delimiter_position + 1;
   }
 
-  return FillFileInfoWithNode(stats, header_size_, node);
+  *out = node;
+  return true;
+}
+
+bool Archive::GetFileInfo(const base::FilePath& path, FileInfo* info) {
+  uint32_t index;
+  if (!GetNode(path.AsUTF8Unsafe(), &index))
+    return false;
+
+  if (nodes_[index].type == Node::LINK) {
+    index = nodes_[index].link_target;
+    if (index == kNoNode)
+      return false;
+  }
+
+  const Node& node = nodes_[index];
+  if (node.type != Node::FILE)
+    return false;
+
+  *info = node.info;
+  return true;
+}
+
+bool Archive::Stat(const base::FilePath& path, Stats* stats) {
+  uint32_t index;
+  if (!GetNode(path.AsUTF8Unsafe(), &index))
+    return false;
+
+  const Node& node = nodes_[index];
+  switch (node.type) {
+    case Node::LINK:
+      stats->is_file = false;
+      stats->is_link = true;
+      return true;
+    case Node::DIRECTORY:
+      stats->is_file = false;
+      stats->is_directory = true;
+      return true;
+    case Node::FILE:
+      *static_cast<FileInfo*>(stats) = node.info;
+      return true;
+    case Node::INVALID:
+      break;
+  }
+  return false;
 }
 
 bool Archive::Readdir(const base::FilePath& path,
                       std::vector<base::FilePath>* list) {
-  if (!header_)
+  uint32_t index;
+  if (!GetNode(path.AsUTF8Unsafe(), &index))
     return false;
 
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
-    return false;
+  if (nodes_[index].type == Node::LINK) {
+    index = nodes_[index].link_target;
+    if (index == kNoNode)
+      return false;
+  }
 
-  const base::DictionaryValue* files;
-  if (!GetFilesNode(header_.get(), node, &files))
+  const Node& node = nodes_[index];
+  if (node.type != Node::DIRECTORY)
     return false;
 
-  base::DictionaryValue::Iterator iter(*files);
-  while (!iter.IsAtEnd()) {
-    list->push_back(base::FilePath::FromUTF8Unsafe(iter.key()));
-    iter.Advance();
+  list->reserve(list->size() + node.child_count);
+  for (uint32_t i = 0; i < node.child_count; ++i) {
+    list->push_back(base::FilePath::FromUTF8Unsafe(
+        NodeName(nodes_[node.first_child + i])));
   }
   return true;
 }
 
 bool Archive::Realpath(const base::FilePath& path, base::FilePath* realpath) {
-  if (!header_)
-    return false;
-
-  const base::DictionaryValue* node;
-  if (!GetNodeFromPath(path.AsUTF8Unsafe(), header_.get(), &node))
+  uint32_t index;
+  if (!GetNode(path.AsUTF8Unsafe(), &index))
     return false;
 
-  std::string link;
-  if (node->GetString("link", &link)) {
-    *realpath = base::FilePath::FromUTF8Unsafe(link);
+  const Node& node = nodes_[index];
+  if (node.type == Node::LINK) {
+    *realpath = base::FilePath::FromUTF8Unsafe(NodeLink(node));
     return true;
   }
 
@@ -273,6 +439,7 @@ bool Archive::Realpath(const base::FilePath& path, base::FilePath* realpath) {
 }
 
 bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
+  base::AutoLock auto_lock(external_files_lock_);
   auto it = external_files_.find(path.value());
   if (it != external_files_.end()) {
     *out = it->second->path();
@@ -290,8 +457,14 @@ bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
 
   std::unique_ptr<ScopedTemporaryFile> temp_file(new ScopedTemporaryFile);
   base::FilePath::StringType ext = path.Extension();
-  if (!temp_file->InitFromFile(&file_, ext, info.offset, info.size))
+  if (info.compressed) {
+    std::string contents;
+    if (!ReadEntry(info, &contents) ||
+        !temp_file->InitFromContents(ext, contents))
+      return false;
+  } else if (!temp_file->InitFromFile(&file_, ext, info.offset, info.size)) {
     return false;
+  }
 
 #if defined(OS_POSIX)
   if (info.executable) {
@@ -305,8 +478,68 @@ bool Archive::CopyFileOut(const base::FilePath& path, base::FilePath* out) {
   return true;
 }
 
+bool Archive::GetMappedContents(const base::FilePath& path,
+                                base::StringPiece* contents) {
+  if (!mapped_file_)
+    return false;
+
+  FileInfo info;
+  if (!GetFileInfo(path, &info) || info.unpacked || info.compressed)
+    return false;
+
+  if (info.offset > mapped_file_->length() ||
+      info.size > mapped_file_->length() - info.offset)
+    return false;
+
+  *contents = base::StringPiece(
+      reinterpret_cast<const char*>(mapped_file_->data()) + info.offset,
+      info.size);
+  return true;
+}
+
+bool Archive::ReadFile(const base::FilePath& path, std::string* contents) {
+  FileInfo info;
+  if (!GetFileInfo(path, &info) || info.unpacked)
+    return false;
+  return ReadEntry(info, contents);
+}
+
+bool Archive::ReadEntry(const FileInfo& info, std::string* contents) {
+  uint32_t stored_size = info.stored_size();
+  base::StringPiece stored;
+  std::string buffer;
+  if (mapped_file_ &&
+      info.offset <= mapped_file_->length() &&
+      stored_size <= mapped_file_->length() - info.offset) {
+    stored = base::StringPiece(
+        reinterpret_cast<const char*>(mapped_file_->data()) + info.offset,
+        stored_size);
+  } else {
+    buffer.resize(stored_size);
+    if (stored_size &&
+        file_.Read(info.offset, &buffer[0], stored_size) !=
+            static_cast<int>(stored_size))
+      return false;
+    stored = buffer;
+  }
+
+  if (!info.compressed) {
+    stored.CopyToString(contents);
+    return true;
+  }
+  return InflateGzip(stored, info.size, contents);
+}
+
 int Archive::GetFD() const {
   return fd_;
 }
 
+bool Archive::IsStale() const {
+  base::File::Info info;
+  if (!base::GetFileInfo(path_, &info))
+    return true;
+  return info.size != file_info_.size ||
+         info.last_modified != file_info_.last_modified;
+}
+
 }  // namespace asar
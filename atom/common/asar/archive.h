@@ -6,14 +6,18 @@
 #define ATOM_COMMON_ASAR_ARCHIVE_H_
 
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "base/files/file.h"
 #include "base/files/file_path.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
 
 namespace base {
 class DictionaryValue;
+class MemoryMappedFile;
 }
 
 namespace asar {
@@ -21,14 +25,28 @@ namespace asar {
 class ScopedTemporaryFile;
 
 // This class represents an asar package, and provides methods to read
-// information from it.
+// information from it. Once initialized it can be used from any thread.
 class Archive {
  public:
   struct FileInfo {
-    FileInfo() : unpacked(false), executable(false), size(0), offset(0) {}
+    FileInfo()
+        : unpacked(false),
+          executable(false),
+          compressed(false),
+          size(0),
+          compressed_size(0),
+          offset(0) {}
+
+    // Number of bytes the file takes in the archive.
+    uint32_t stored_size() const { return compressed ? compressed_size : size; }
+
     bool unpacked;
     bool executable;
+    // Whether the file is stored as a gzip stream of |compressed_size| bytes,
+    // |size| is always the size of the inflated file.
+    bool compressed;
     uint32_t size;
+    uint32_t compressed_size;
     uint64_t offset;
   };
 
@@ -45,6 +63,10 @@ class Archive {
   // Read and parse the header.
   bool Init();
 
+  // Maps the whole archive into memory, so packed files can be read without
+  // any syscall or intermediate copy. Must be called after Init().
+  bool Map();
+
   // Get the info of a file.
   bool GetFileInfo(const base::FilePath& path, FileInfo* info);
 
@@ -61,20 +83,94 @@ class Archive {
   // For unpacked file, this method will return its real path.
   bool CopyFileOut(const base::FilePath& path, base::FilePath* out);
 
+  // Returns the contents of a packed file from the memory mapping. The data
+  // stays valid as long as mapped_file() is referenced. Fails for compressed
+  // files.
+  bool GetMappedContents(const base::FilePath& path,
+                         base::StringPiece* contents);
+
+  // Reads a packed file, inflating it if it is compressed.
+  bool ReadFile(const base::FilePath& path, std::string* contents);
+
   // Returns the file's fd.
   int GetFD() const;
 
+  // Whether the file on disk was modified or replaced since it was opened.
+  bool IsStale() const;
+
   base::FilePath path() const { return path_; }
-  base::DictionaryValue* header() const { return header_.get(); }
+  std::shared_ptr<base::MemoryMappedFile> mapped_file() const {
+    return mapped_file_;
+  }
 
  private:
+  // A node of the compiled header. Nodes are stored in breadth-first order so
+  // the children of a directory occupy the contiguous range
+  // [first_child, first_child + child_count) of |nodes_|, sorted by name.
+  struct Node {
+    enum Type : uint8_t {
+      FILE,
+      DIRECTORY,
+      LINK,
+      // A node that has neither "files" nor "link" and no valid file info.
+      INVALID,
+    };
+
+    Node();
+
+    Type type;
+    // Offset and length of the name in |names_|.
+    uint32_t name_offset;
+    uint32_t name_size;
+    // Offset and length of the link target in |names_|, for LINK nodes.
+    uint32_t link_offset;
+    uint32_t link_size;
+    // The node the link finally points to, resolved once in Init().
+    uint32_t link_target;
+    uint32_t first_child;
+    uint32_t child_count;
+    FileInfo info;
+  };
+
+  // Reads the packed file described by |info|.
+  bool ReadEntry(const FileInfo& info, std::string* contents);
+
+  // Flattens the parsed JSON header into |nodes_| and |names_|.
+  bool Compile(const base::DictionaryValue* root);
+
+  // Resolves |link_target| of the LINK node |index|, following chained links.
+  uint32_t ResolveLink(uint32_t index);
+
+  // Finds the node of |path|, returns false when it does not exist.
+  bool GetNode(base::StringPiece path, uint32_t* out);
+
+  // Returns the child of directory |dir| called |name|, following |dir| if it
+  // is a link to a directory.
+  bool GetChildNode(uint32_t dir, base::StringPiece name, uint32_t* out);
+
+  base::StringPiece NodeName(const Node& node) const {
+    return base::StringPiece(names_.data() + node.name_offset, node.name_size);
+  }
+  base::StringPiece NodeLink(const Node& node) const {
+    return base::StringPiece(names_.data() + node.link_offset, node.link_size);
+  }
+
   base::FilePath path_;
   base::File file_;
+  base::File::Info file_info_;
   int fd_;
   uint32_t header_size_;
-  std::unique_ptr<base::DictionaryValue> header_;
 
-  // Cached external temporary files.
+  // The compiled header, nodes_[0] is the root directory.
+  std::vector<Node> nodes_;
+  // Interned names and link targets referenced by |nodes_|.
+  std::string names_;
+
+  // Shared so strings handed out to V8 can outlive the archive.
+  std::shared_ptr<base::MemoryMappedFile> mapped_file_;
+
+  // Cached external temporary files, guarded by |external_files_lock_|.
+  base::Lock external_files_lock_;
   std::unordered_map
     <base::FilePath::StringType, std::unique_ptr<ScopedTemporaryFile>>
       external_files_;
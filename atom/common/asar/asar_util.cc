@@ -4,36 +4,202 @@
 
 #include "atom/common/asar/asar_util.h"
 
-#include <map>
+#include <functional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "atom/common/asar/archive.h"
+#include "base/containers/mru_cache.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/lazy_instance.h"
-#include "base/stl_util.h"
+#include "base/strings/string_util.h"
+#include "base/synchronization/lock.h"
 
 namespace asar {
 
 namespace {
 
-// The global instance of ArchiveMap, will be destroyed on exit.
-typedef std::map<base::FilePath, std::shared_ptr<Archive>> ArchiveMap;
-static base::LazyInstance<ArchiveMap> g_archive_map = LAZY_INSTANCE_INITIALIZER;
+// Archives are spread over shards by path so threads opening different
+// archives rarely wait for each other.
+const size_t kArchiveCacheShards = 8;
+// Each cached archive holds an fd and a mapping, cap how many stay open.
+const size_t kMaxArchivesPerShard = 16;
 
-const base::FilePath::CharType kAsarExtension[] = FILE_PATH_LITERAL(".asar");
+class ArchiveCache {
+ public:
+  ArchiveCache() : mapped_requests_(0), streamed_requests_(0) {}
 
-}  // namespace
+  std::shared_ptr<Archive> GetOrCreate(const base::FilePath& path) {
+    Shard& shard = GetShard(path);
+    {
+      base::AutoLock auto_lock(shard.lock);
+      auto it = shard.archives.Get(path);
+      if (it != shard.archives.end()) {
+        ++shard.stats.hits;
+        return it->second;
+      }
+      ++shard.stats.misses;
+    }
 
-std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path) {
-  ArchiveMap& archive_map = *g_archive_map.Pointer();
-  if (!ContainsKey(archive_map, path)) {
+    // Parse the header without holding the lock, it does blocking IO.
     std::shared_ptr<Archive> archive(new Archive(path));
     if (!archive->Init())
       return nullptr;
-    archive_map[path] = archive;
+    archive->Map();
+
+    base::AutoLock auto_lock(shard.lock);
+    // Another thread may have opened the same archive in the meantime.
+    auto it = shard.archives.Get(path);
+    if (it != shard.archives.end())
+      return it->second;
+    if (shard.archives.size() == shard.archives.max_size())
+      ++shard.stats.evictions;
+    shard.archives.Put(path, archive);
+    return archive;
+  }
+
+  bool Invalidate(const base::FilePath& path) {
+    Shard& shard = GetShard(path);
+    base::AutoLock auto_lock(shard.lock);
+    auto it = shard.archives.Peek(path);
+    if (it == shard.archives.end())
+      return false;
+    shard.archives.Erase(it);
+    ++shard.stats.invalidations;
+    return true;
+  }
+
+  int InvalidateStale() {
+    int count = 0;
+    for (Shard& shard : shards_) {
+      std::vector<std::pair<base::FilePath, std::shared_ptr<Archive>>> cached;
+      {
+        base::AutoLock auto_lock(shard.lock);
+        for (const auto& entry : shard.archives)
+          cached.push_back(entry);
+      }
+
+      // Checking the files on disk is blocking IO, do it without the lock.
+      for (const auto& entry : cached) {
+        if (!entry.second->IsStale())
+          continue;
+        base::AutoLock auto_lock(shard.lock);
+        auto it = shard.archives.Peek(entry.first);
+        if (it == shard.archives.end() || it->second != entry.second)
+          continue;
+        shard.archives.Erase(it);
+        ++shard.stats.invalidations;
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  ArchiveCacheStats GetStats() {
+    ArchiveCacheStats stats;
+    for (Shard& shard : shards_) {
+      base::AutoLock auto_lock(shard.lock);
+      stats.hits += shard.stats.hits;
+      stats.misses += shard.stats.misses;
+      stats.evictions += shard.stats.evictions;
+      stats.invalidations += shard.stats.invalidations;
+      stats.size += shard.archives.size();
+    }
+    base::AutoLock auto_lock(requests_lock_);
+    stats.mapped_requests = mapped_requests_;
+    stats.streamed_requests = streamed_requests_;
+    return stats;
+  }
+
+  void RecordRequest(bool mapped) {
+    base::AutoLock auto_lock(requests_lock_);
+    if (mapped)
+      ++mapped_requests_;
+    else
+      ++streamed_requests_;
   }
-  return archive_map[path];
+
+ private:
+  typedef base::MRUCache<base::FilePath, std::shared_ptr<Archive>> ArchiveMap;
+
+  struct Shard {
+    Shard() : archives(kMaxArchivesPerShard) {}
+
+    base::Lock lock;
+    ArchiveMap archives;
+    ArchiveCacheStats stats;
+  };
+
+  Shard& GetShard(const base::FilePath& path) {
+    size_t hash = std::hash<base::FilePath::StringType>()(path.value());
+    return shards_[hash % kArchiveCacheShards];
+  }
+
+  Shard shards_[kArchiveCacheShards];
+
+  base::Lock requests_lock_;
+  uint64_t mapped_requests_;
+  uint64_t streamed_requests_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArchiveCache);
+};
+
+// The global instance of ArchiveCache, will be destroyed on exit.
+static base::LazyInstance<ArchiveCache> g_archive_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+const base::FilePath::CharType kAsarExtension[] = FILE_PATH_LITERAL(".asar");
+
+// Exposes a range of a mapped archive to V8 without copying it.
+class MappedStringResource : public v8::String::ExternalOneByteStringResource {
+ public:
+  MappedStringResource(std::shared_ptr<base::MemoryMappedFile> mapped_file,
+                       base::StringPiece contents)
+      : mapped_file_(mapped_file), contents_(contents) {}
+
+  const char* data() const override { return contents_.data(); }
+  size_t length() const override { return contents_.size(); }
+
+ private:
+  std::shared_ptr<base::MemoryMappedFile> mapped_file_;
+  base::StringPiece contents_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedStringResource);
+};
+
+}  // namespace
+
+ArchiveCacheStats::ArchiveCacheStats()
+    : hits(0),
+      misses(0),
+      evictions(0),
+      invalidations(0),
+      size(0),
+      mapped_requests(0),
+      streamed_requests(0) {
+}
+
+std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path) {
+  return g_archive_cache.Get().GetOrCreate(path);
+}
+
+bool InvalidateAsarArchive(const base::FilePath& path) {
+  return g_archive_cache.Get().Invalidate(path);
+}
+
+int InvalidateStaleAsarArchives() {
+  return g_archive_cache.Get().InvalidateStale();
+}
+
+ArchiveCacheStats GetAsarArchiveCacheStats() {
+  return g_archive_cache.Get().GetStats();
+}
+
+void RecordAsarRequest(bool mapped) {
+  g_archive_cache.Get().RecordRequest(mapped);
 }
 
 bool GetAsarArchivePath(const base::FilePath& full_path,
@@ -78,13 +244,53 @@ bool ReadFileToString(const base::FilePath& path, std::string* contents) {
     return base::ReadFileToString(real_path, contents);
   }
 
-  base::File src(asar_path, base::File::FLAG_OPEN | base::File::FLAG_READ);
-  if (!src.IsValid())
+  // Copies from the mapping, or reads the archive, and inflates compressed
+  // files.
+  return archive->ReadFile(relative_path, contents);
+}
+
+bool ReadFileToV8String(v8::Isolate* isolate,
+                        const base::FilePath& path,
+                        v8::Local<v8::String>* contents) {
+  base::FilePath asar_path, relative_path;
+  if (GetAsarArchivePath(path, &asar_path, &relative_path)) {
+    std::shared_ptr<Archive> archive = GetOrCreateAsarArchive(asar_path);
+    if (!archive)
+      return false;
+
+    base::StringPiece mapped_contents;
+    if (archive->GetMappedContents(relative_path, &mapped_contents)) {
+      *contents = MappedContentsToV8String(isolate, *archive, mapped_contents);
+      return !contents->IsEmpty();
+    }
+  }
+
+  std::string source;
+  if (!ReadFileToString(path, &source))
     return false;
+  return v8::String::NewFromUtf8(isolate, source.data(),
+                                 v8::NewStringType::kNormal,
+                                 static_cast<int>(source.size()))
+      .ToLocal(contents);
+}
 
-  contents->resize(info.size);
-  return static_cast<int>(info.size) == src.Read(
-      info.offset, const_cast<char*>(contents->data()), contents->size());
+v8::Local<v8::String> MappedContentsToV8String(v8::Isolate* isolate,
+                                               const Archive& archive,
+                                               base::StringPiece contents) {
+  // External one-byte strings are Latin-1, so only ASCII can be shared as is.
+  v8::Local<v8::String> result;
+  if (base::IsStringASCII(contents)) {
+    v8::String::NewExternalOneByte(
+        isolate,
+        new MappedStringResource(archive.mapped_file(), contents))
+        .ToLocal(&result);
+  } else {
+    v8::String::NewFromUtf8(isolate, contents.data(),
+                            v8::NewStringType::kNormal,
+                            static_cast<int>(contents.size()))
+        .ToLocal(&result);
+  }
+  return result;
 }
 
 }  // namespace asar
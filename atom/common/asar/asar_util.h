@@ -8,6 +8,9 @@
 #include <memory>
 #include <string>
 
+#include "base/strings/string_piece.h"
+#include "v8/include/v8.h"
+
 namespace base {
 class FilePath;
 }
@@ -16,9 +19,40 @@ namespace asar {
 
 class Archive;
 
-// Gets or creates a new Archive from the path.
+// Counters of the process-wide archive cache.
+struct ArchiveCacheStats {
+  ArchiveCacheStats();
+
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t invalidations;
+  // Number of archives currently cached.
+  uint64_t size;
+  // Protocol requests for packed files served from the archive mapping, and
+  // those that had to read the archive file.
+  uint64_t mapped_requests;
+  uint64_t streamed_requests;
+};
+
+// Gets or creates a new Archive from the path. The cache is safe to use from
+// any thread, and only keeps the most recently used archives open.
 std::shared_ptr<Archive> GetOrCreateAsarArchive(const base::FilePath& path);
 
+// Drops the cached archive of |path|, the next lookup opens it again. Users
+// still holding the old archive keep reading the old file.
+bool InvalidateAsarArchive(const base::FilePath& path);
+
+// Drops every cached archive whose file on disk was modified or replaced since
+// it was opened, returns the number of dropped archives.
+int InvalidateStaleAsarArchives();
+
+// Returns the hit/miss counters of the archive cache.
+ArchiveCacheStats GetAsarArchiveCacheStats();
+
+// Counts a protocol request for a packed file, see ArchiveCacheStats.
+void RecordAsarRequest(bool mapped);
+
 // Separates the path to Archive out.
 bool GetAsarArchivePath(const base::FilePath& full_path,
                         base::FilePath* asar_path,
@@ -27,6 +61,18 @@ bool GetAsarArchivePath(const base::FilePath& full_path,
 // Same with base::ReadFileToString but supports asar Archive.
 bool ReadFileToString(const base::FilePath& path, std::string* contents);
 
+// Same with ReadFileToString but returns a V8 string, packed ASCII files of a
+// mapped archive are handed to V8 without being copied.
+bool ReadFileToV8String(v8::Isolate* isolate,
+                        const base::FilePath& path,
+                        v8::Local<v8::String>* contents);
+
+// Converts |contents| returned by Archive::GetMappedContents to a V8 string.
+// ASCII contents become an external string that keeps the mapping alive.
+v8::Local<v8::String> MappedContentsToV8String(v8::Isolate* isolate,
+                                               const Archive& archive,
+                                               base::StringPiece contents);
+
 }  // namespace asar
 
 #endif  // ATOM_COMMON_ASAR_ASAR_UTIL_H_
@@ -71,4 +71,18 @@ bool ScopedTemporaryFile::InitFromFile(base::File* src,
       static_cast<int>(size);
 }
 
+bool ScopedTemporaryFile::InitFromContents(
+    const base::FilePath::StringType& ext,
+    base::StringPiece contents) {
+  if (!Init(ext))
+    return false;
+
+  base::File dest(path_, base::File::FLAG_OPEN | base::File::FLAG_WRITE);
+  if (!dest.IsValid())
+    return false;
+
+  return dest.WriteAtCurrentPos(contents.data(), contents.size()) ==
+      static_cast<int>(contents.size());
+}
+
 }  // namespace asar
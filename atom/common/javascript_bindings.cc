@@ -4,14 +4,18 @@
 
 #include "atom/common/javascript_bindings.h"
 
+#include <utility>
 #include <vector>
 #include "atom/common/api/api_messages.h"
 #include "atom/common/api/atom_api_key_weak_map.h"
 #include "atom/common/api/remote_callback_freer.h"
 #include "atom/common/api/remote_object_freer.h"
+#include "atom/common/api/serialized_value.h"
 #include "atom/common/native_mate_converters/content_converter.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
 #include "atom/common/native_mate_converters/value_converter.h"
+#include "base/memory/shared_memory.h"
+#include "base/strings/utf_string_conversions.h"
 #include "brave/common/extensions/shared_memory_bindings.h"
 #include "content/public/renderer/render_frame.h"
 #include "content/public/renderer/render_view.h"
@@ -138,6 +142,84 @@ void JavascriptBindings::IPCSend(mate::Arguments* args,
     args->ThrowError("Unable to send AtomViewHostMsg_Message");
 }
 
+void JavascriptBindings::IPCPostMessage(mate::Arguments* args,
+                                        const base::string16& channel,
+                                        v8::Local<v8::Value> message) {
+  if (!is_valid() || !render_view())
+    return;
+
+  v8::Local<v8::Value> transfer_list;
+  args->GetNext(&transfer_list);
+  SerializedValue serialized;
+  if (!SerializeValue(args->isolate(), message, transfer_list, &serialized))
+    return;
+
+  bool success = render_view()->Send(new AtomViewHostMsg_Message_Serialized(
+      render_view()->GetRoutingID(), channel, serialized));
+
+  if (!success)
+    args->ThrowError("Unable to send AtomViewHostMsg_Message_Serialized");
+}
+
+v8::Local<v8::Value> JavascriptBindings::IPCPostMessageSync(
+    mate::Arguments* args,
+    const base::string16& channel,
+    v8::Local<v8::Value> message) {
+  v8::Isolate* isolate = args->isolate();
+  if (!is_valid() || !render_view())
+    return v8::Undefined(isolate);
+
+  v8::Local<v8::Value> transfer_list;
+  args->GetNext(&transfer_list);
+  SerializedValue serialized;
+  if (!SerializeValue(isolate, message, transfer_list, &serialized))
+    return v8::Undefined(isolate);
+
+  SerializedValue result;
+  IPC::SyncMessage* sync_message = new AtomViewHostMsg_Message_Serialized_Sync(
+      render_view()->GetRoutingID(), channel, serialized, &result);
+  if (!render_view()->Send(sync_message)) {
+    args->ThrowError("Unable to send AtomViewHostMsg_Message_Serialized_Sync");
+    return v8::Undefined(isolate);
+  }
+
+  // an empty result means the browser had nothing to reply with
+  v8::Local<v8::Value> value;
+  if (result.data.empty() ||
+      !DeserializeValue(isolate, result).ToLocal(&value))
+    return v8::Undefined(isolate);
+  return value;
+}
+
+bool JavascriptBindings::WorkerPortPostMessage(mate::Arguments* args,
+                                               int channel_id,
+                                               v8::Local<v8::Value> message) {
+  if (!is_valid() || !render_view())
+    return false;
+
+  v8::Isolate* isolate = args->isolate();
+  v8::ValueSerializer serializer(isolate);
+  serializer.WriteHeader();
+  if (!serializer.WriteValue(isolate->GetCurrentContext(), message)
+          .FromMaybe(false))
+    return false;
+
+  std::pair<uint8_t*, size_t> buffer = serializer.Release();
+  std::vector<uint8_t> data(buffer.first, buffer.first + buffer.second);
+  free(buffer.first);
+
+  return render_view()->Send(new AtomViewHostMsg_WorkerPortMessage(
+      render_view()->GetRoutingID(), channel_id, data));
+}
+
+void JavascriptBindings::WorkerPortClose(int channel_id) {
+  if (!is_valid() || !render_view())
+    return;
+
+  render_view()->Send(new AtomViewHostMsg_WorkerPortClose(
+      render_view()->GetRoutingID(), channel_id));
+}
+
 base::string16 JavascriptBindings::IPCSendSync(mate::Arguments* args,
                         const base::string16& channel,
                         const base::ListValue& arguments) {
@@ -170,6 +252,17 @@ void JavascriptBindings::GetBinding(
       base::Unretained(this)));
   ipc.SetMethod("sendSync", base::Bind(&JavascriptBindings::IPCSendSync,
       base::Unretained(this)));
+  ipc.SetMethod("postMessage", base::Bind(&JavascriptBindings::IPCPostMessage,
+      base::Unretained(this)));
+  ipc.SetMethod("postMessageSync",
+      base::Bind(&JavascriptBindings::IPCPostMessageSync,
+      base::Unretained(this)));
+  ipc.SetMethod("workerPortPostMessage",
+      base::Bind(&JavascriptBindings::WorkerPortPostMessage,
+      base::Unretained(this)));
+  ipc.SetMethod("workerPortClose",
+      base::Bind(&JavascriptBindings::WorkerPortClose,
+      base::Unretained(this)));
   binding.Set("ipc", ipc.GetHandle());
 
   mate::Dictionary v8(isolate, v8::Object::New(isolate));
@@ -218,6 +311,13 @@ bool JavascriptBindings::OnMessageReceived(const IPC::Message& message) {
   bool handled = false;  // don't swallow any of these messages
   IPC_BEGIN_MESSAGE_MAP(JavascriptBindings, message)
     IPC_MESSAGE_HANDLER(AtomViewMsg_Message, OnBrowserMessage)
+    IPC_MESSAGE_HANDLER(AtomViewMsg_Message_Serialized,
+                        OnSerializedBrowserMessage)
+    IPC_MESSAGE_HANDLER(AtomViewMsg_WorkerPortConnect, OnWorkerPortConnect)
+    IPC_MESSAGE_HANDLER(AtomViewMsg_WorkerPortClose, OnWorkerPortClose)
+    IPC_MESSAGE_HANDLER(AtomViewMsg_WorkerPortMessage, OnWorkerPortMessage)
+    IPC_MESSAGE_HANDLER(AtomViewMsg_WorkerPortMessage_Shared,
+                        OnSharedWorkerPortMessage)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
 
@@ -233,24 +333,8 @@ void JavascriptBindings::OnSharedBrowserMessage(const base::string16& channel,
   v8::HandleScope handle_scope(isolate);
   v8::Context::Scope context_scope(context()->v8_context());
 
-  std::vector<v8::Local<v8::Value>> args_vector;
-  args_vector.insert(args_vector.begin(),
-      extensions::SharedMemoryWrapper::CreateFrom(isolate, handle).ToV8());
-
-  // Insert the Event object, event.sender is ipc
-  mate::Dictionary event = mate::Dictionary::CreateEmpty(isolate);
-  args_vector.insert(args_vector.begin(), event.GetHandle());
-
-  std::vector<v8::Local<v8::Value>> concatenated_args =
-        { mate::StringToV8(isolate, channel) };
-      concatenated_args.reserve(1 + args_vector.size());
-      concatenated_args.insert(concatenated_args.end(),
-                                args_vector.begin(), args_vector.end());
-
-  context()->module_system()->CallModuleMethod("ipc_utils",
-                                  "emit",
-                                  concatenated_args.size(),
-                                  &concatenated_args.front());
+  EmitMessage(channel,
+      { extensions::SharedMemoryWrapper::CreateFrom(isolate, handle).ToV8() });
 }
 
 void JavascriptBindings::OnBrowserMessage(bool all_frames,
@@ -263,22 +347,103 @@ void JavascriptBindings::OnBrowserMessage(bool all_frames,
   v8::HandleScope handle_scope(isolate);
   v8::Context::Scope context_scope(context()->v8_context());
 
-  auto args_vector = ListValueToVector(isolate, args);
+  EmitMessage(channel, ListValueToVector(isolate, args));
+}
+
+void JavascriptBindings::OnSerializedBrowserMessage(
+    bool all_frames,
+    const base::string16& channel,
+    const SerializedValue& message) {
+  if (!is_valid())
+    return;
+
+  v8::Isolate* isolate = context()->isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(context()->v8_context());
+
+  v8::Local<v8::Value> value;
+  if (!DeserializeValue(isolate, message).ToLocal(&value))
+    return;
+
+  EmitMessage(channel, { value });
+}
+
+void JavascriptBindings::OnWorkerPortConnect(int channel_id) {
+  if (!is_valid())
+    return;
+
+  v8::Isolate* isolate = context()->isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(context()->v8_context());
+
+  EmitMessage(base::ASCIIToUTF16("ELECTRON_WORKER_PORT_CONNECT"),
+      { mate::ConvertToV8(isolate, channel_id) });
+}
+
+void JavascriptBindings::OnWorkerPortClose(int channel_id) {
+  if (!is_valid())
+    return;
+
+  v8::Isolate* isolate = context()->isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(context()->v8_context());
+
+  EmitMessage(base::ASCIIToUTF16("ELECTRON_WORKER_PORT_CLOSE"),
+      { mate::ConvertToV8(isolate, channel_id) });
+}
+
+void JavascriptBindings::OnWorkerPortMessage(
+    int channel_id,
+    const std::vector<uint8_t>& message) {
+  EmitWorkerPortMessage(channel_id, message.data(), message.size());
+}
+
+void JavascriptBindings::OnSharedWorkerPortMessage(
+    int channel_id,
+    const base::SharedMemoryHandle& handle,
+    uint32_t size) {
+  base::SharedMemory shared_memory(handle, true);
+  if (!shared_memory.Map(size))
+    return;
+
+  EmitWorkerPortMessage(channel_id,
+      static_cast<const uint8_t*>(shared_memory.memory()), size);
+}
+
+void JavascriptBindings::EmitWorkerPortMessage(int channel_id,
+                                               const uint8_t* data,
+                                               size_t size) {
+  if (!is_valid())
+    return;
+
+  v8::Isolate* isolate = context()->isolate();
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::Context> v8_context = context()->v8_context();
+  v8::Context::Scope context_scope(v8_context);
+
+  v8::ValueDeserializer deserializer(isolate, data, size);
+  v8::Local<v8::Value> value;
+  if (!deserializer.ReadHeader(v8_context).FromMaybe(false) ||
+      !deserializer.ReadValue(v8_context).ToLocal(&value))
+    return;
+
+  EmitMessage(base::ASCIIToUTF16("ELECTRON_WORKER_PORT_MESSAGE"),
+      { mate::ConvertToV8(isolate, channel_id), value });
+}
+
+void JavascriptBindings::EmitMessage(const base::string16& channel,
+                                     std::vector<v8::Local<v8::Value>> args) {
+  v8::Isolate* isolate = context()->isolate();
 
   // Insert the Event object, event.sender is ipc
   mate::Dictionary event = mate::Dictionary::CreateEmpty(isolate);
-  args_vector.insert(args_vector.begin(), event.GetHandle());
-
-  std::vector<v8::Local<v8::Value>> concatenated_args =
-        { mate::StringToV8(isolate, channel) };
-      concatenated_args.reserve(1 + args_vector.size());
-      concatenated_args.insert(concatenated_args.end(),
-                                args_vector.begin(), args_vector.end());
+  args.insert(args.begin(), event.GetHandle());
+  args.insert(args.begin(), mate::StringToV8(isolate, channel));
 
   context()->module_system()->CallModuleMethod("ipc_utils",
                                   "emit",
-                                  concatenated_args.size(),
-                                  &concatenated_args.front());
+                                  args.size(),
+                                  &args.front());
 }
 
 }  // namespace atom
@@ -5,6 +5,8 @@
 #ifndef ATOM_COMMON_JAVASCRIPT_BINDINGS_H_
 #define ATOM_COMMON_JAVASCRIPT_BINDINGS_H_
 
+#include <vector>
+
 #include "base/memory/shared_memory_handle.h"
 #include "content/public/renderer/render_view_observer.h"
 #include "extensions/renderer/object_backed_native_handler.h"
@@ -17,6 +19,8 @@ class Arguments;
 
 namespace atom {
 
+struct SerializedValue;
+
 class JavascriptBindings : public content::RenderViewObserver,
                            public extensions::ObjectBackedNativeHandler {
  public:
@@ -33,6 +37,16 @@ class JavascriptBindings : public content::RenderViewObserver,
   void IPCSend(mate::Arguments* args,
                         const base::string16& channel,
                         const base::ListValue& arguments);
+  void IPCPostMessage(mate::Arguments* args,
+                      const base::string16& channel,
+                      v8::Local<v8::Value> message);
+  v8::Local<v8::Value> IPCPostMessageSync(mate::Arguments* args,
+                                          const base::string16& channel,
+                                          v8::Local<v8::Value> message);
+  bool WorkerPortPostMessage(mate::Arguments* args,
+                             int channel_id,
+                             v8::Local<v8::Value> message);
+  void WorkerPortClose(int channel_id);
   v8::Local<v8::Value> GetHiddenValue(v8::Isolate* isolate,
                                     v8::Local<v8::String> key);
   void SetHiddenValue(v8::Isolate* isolate,
@@ -62,6 +76,18 @@ class JavascriptBindings : public content::RenderViewObserver,
                         const base::ListValue& args);
   void OnSharedBrowserMessage(const base::string16& channel,
                               const base::SharedMemoryHandle& handle);
+  void OnSerializedBrowserMessage(bool all_frames,
+                                  const base::string16& channel,
+                                  const SerializedValue& message);
+  void OnWorkerPortConnect(int channel_id);
+  void OnWorkerPortClose(int channel_id);
+  void OnWorkerPortMessage(int channel_id, const std::vector<uint8_t>& message);
+  void OnSharedWorkerPortMessage(int channel_id,
+                                 const base::SharedMemoryHandle& handle,
+                                 uint32_t size);
+  void EmitWorkerPortMessage(int channel_id, const uint8_t* data, size_t size);
+  void EmitMessage(const base::string16& channel,
+                   std::vector<v8::Local<v8::Value>> args);
 
   DISALLOW_COPY_AND_ASSIGN(JavascriptBindings);
 };
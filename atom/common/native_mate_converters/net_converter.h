@@ -5,6 +5,8 @@
 #ifndef ATOM_COMMON_NATIVE_MATE_CONVERTERS_NET_CONVERTER_H_
 #define ATOM_COMMON_NATIVE_MATE_CONVERTERS_NET_CONVERTER_H_
 
+#include <stdint.h>
+
 #include "base/memory/ref_counted.h"
 #include "native_mate/converter.h"
 
@@ -37,8 +39,20 @@ struct Converter<scoped_refptr<net::X509Certificate>> {
 
 namespace atom {
 
+// Properties set by FillRequestDetails.
+enum RequestDetailsField : uint32_t {
+  kRequestDetailsUrl = 1 << 1,
+  kRequestDetailsMethod = 1 << 2,
+  kRequestDetailsReferrer = 1 << 3,
+  kRequestDetailsUploadData = 1 << 4,
+};
+
 void FillRequestDetails(base::DictionaryValue* details,
                         const net::URLRequest* request);
+// Only sets the properties in |fields|, a bitmask of RequestDetailsField.
+void FillRequestDetails(base::DictionaryValue* details,
+                        const net::URLRequest* request,
+                        uint32_t fields);
 
 void GetUploadData(base::ListValue* upload_data_list,
                    const net::URLRequest* request);
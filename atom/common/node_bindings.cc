@@ -129,6 +129,7 @@ base::FilePath GetResourcesPath(bool is_browser) {
 
 NodeBindings::NodeBindings(bool is_browser)
     : is_browser_(is_browser),
+      poll_on_main_thread_(false),
       message_loop_(nullptr),
       uv_loop_(uv_default_loop()),
       embed_closed_(false),
@@ -140,7 +141,7 @@ NodeBindings::~NodeBindings() {
   // Quit the embed thread.
   embed_closed_ = true;
   // node never started
-  if (!uv_env_)
+  if (!uv_env_ || poll_on_main_thread_)
     return;
   uv_sem_post(&embed_sem_);
   WakeupEmbedThread();
@@ -229,6 +230,9 @@ void NodeBindings::PrepareMessageLoop() {
   // nothing to do.
   uv_async_init(uv_loop_, &dummy_uv_handle_, nullptr);
 
+  if (poll_on_main_thread_)
+    return;
+
   // Start worker that will interrupt main loop when having uv events.
   uv_sem_init(&embed_sem_, 0);
   uv_thread_create(&embed_thread_, EmbedThreadRunner, this);
@@ -266,7 +270,8 @@ void NodeBindings::UvRunOnce() {
     message_loop_->QuitWhenIdle();  // Quit from uv.
 
   // Tell the worker thread to continue polling.
-  uv_sem_post(&embed_sem_);
+  if (!poll_on_main_thread_)
+    uv_sem_post(&embed_sem_);
 }
 
 void NodeBindings::WakeupMainThread() {
@@ -63,6 +63,11 @@ class NodeBindings {
   // Are we running in browser.
   bool is_browser_;
 
+  // Whether the derived class watches uv's backend fd from the main thread's
+  // event loop, in which case there is no embed thread. Set in the
+  // constructor.
+  bool poll_on_main_thread_;
+
   // Main thread's MessageLoop.
   base::MessageLoop* message_loop_;
 
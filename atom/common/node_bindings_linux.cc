@@ -6,11 +6,110 @@
 
 #include <sys/epoll.h>
 
+#include "atom/common/options_switches.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/command_line.h"
+
+#if defined(USE_GLIB)
+#include <glib.h>
+#endif
+
 namespace atom {
 
+#if defined(USE_GLIB)
+
+namespace {
+
+struct UvGSource {
+  GSource source;
+  GPollFD poll_fd;
+  uv_loop_t* loop;
+  base::Closure* run_once;
+};
+
+// Wakes glib up in time for the next uv timer.
+gboolean UvSourcePrepare(GSource* source, gint* timeout_ms) {
+  uv_loop_t* loop = reinterpret_cast<UvGSource*>(source)->loop;
+  uv_update_time(loop);
+  *timeout_ms = uv_backend_timeout(loop);
+  return *timeout_ms == 0;
+}
+
+gboolean UvSourceCheck(GSource* source) {
+  UvGSource* uv_source = reinterpret_cast<UvGSource*>(source);
+  if (uv_source->poll_fd.revents & G_IO_IN)
+    return TRUE;
+  uv_update_time(uv_source->loop);
+  return uv_backend_timeout(uv_source->loop) == 0;
+}
+
+gboolean UvSourceDispatch(GSource* source,
+                          GSourceFunc unused_func,
+                          gpointer unused_data) {
+  reinterpret_cast<UvGSource*>(source)->run_once->Run();
+  return TRUE;
+}
+
+GSourceFuncs g_uv_source_funcs = {
+  UvSourcePrepare,
+  UvSourceCheck,
+  UvSourceDispatch,
+  nullptr
+};
+
+}  // namespace
+
+// Runs the uv loop on the main thread whenever the backend fd has events or
+// a timer is due. Watchers added while no uv callback runs still get picked
+// up, OnWatcherQueueChanged signals the dummy async handle which is polled by
+// the backend fd.
+class NodeBindingsLinux::UvSource {
+ public:
+  UvSource(uv_loop_t* loop, const base::Closure& run_once)
+      : run_once_(run_once),
+        source_(g_source_new(&g_uv_source_funcs, sizeof(UvGSource))) {
+    UvGSource* uv_source = reinterpret_cast<UvGSource*>(source_);
+    uv_source->poll_fd.fd = uv_backend_fd(loop);
+    uv_source->poll_fd.events = G_IO_IN;
+    uv_source->poll_fd.revents = 0;
+    uv_source->loop = loop;
+    uv_source->run_once = &run_once_;
+    g_source_add_poll(source_, &uv_source->poll_fd);
+    // Uv callbacks are not run from nested loops, like the tasks posted by
+    // the embed thread.
+    g_source_set_can_recurse(source_, FALSE);
+    g_source_attach(source_, g_main_context_default());
+  }
+
+  ~UvSource() {
+    g_source_destroy(source_);
+    g_source_unref(source_);
+  }
+
+ private:
+  base::Closure run_once_;
+  GSource* source_;
+
+  DISALLOW_COPY_AND_ASSIGN(UvSource);
+};
+
+#else
+
+class NodeBindingsLinux::UvSource {};
+
+#endif  // defined(USE_GLIB)
+
 NodeBindingsLinux::NodeBindingsLinux(bool is_browser)
     : NodeBindings(is_browser),
       epoll_(epoll_create(1)) {
+#if defined(USE_GLIB)
+  // Only the browser main thread runs a glib message pump.
+  poll_on_main_thread_ = is_browser &&
+      base::CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kUvPollOnMainThread);
+#endif
+
   int backend_fd = uv_backend_fd(uv_loop_);
   struct epoll_event ev = { 0 };
   ev.events = EPOLLIN;
@@ -26,6 +125,13 @@ void NodeBindingsLinux::RunMessageLoop() {
   uv_loop_->data = this;
   uv_loop_->on_watcher_queue_updated = OnWatcherQueueChanged;
 
+#if defined(USE_GLIB)
+  if (poll_on_main_thread_) {
+    uv_source_.reset(new UvSource(uv_loop_,
+        base::Bind(&NodeBindingsLinux::UvRunOnce, base::Unretained(this))));
+  }
+#endif
+
   NodeBindings::RunMessageLoop();
 }
 
@@ -5,6 +5,8 @@
 #ifndef ATOM_COMMON_NODE_BINDINGS_LINUX_H_
 #define ATOM_COMMON_NODE_BINDINGS_LINUX_H_
 
+#include <memory>
+
 #include "atom/common/node_bindings.h"
 #include "base/compiler_specific.h"
 
@@ -18,6 +20,10 @@ class NodeBindingsLinux : public NodeBindings {
   void RunMessageLoop() override;
 
  private:
+  // Watches uv's backend fd and timers from the glib main loop of the
+  // browser main thread, see --uv-poll-on-main-thread.
+  class UvSource;
+
   // Called when uv's watcher queue changes.
   static void OnWatcherQueueChanged(uv_loop_t* loop);
 
@@ -26,6 +32,8 @@ class NodeBindingsLinux : public NodeBindings {
   // Epoll to poll for uv's backend fd.
   int epoll_;
 
+  std::unique_ptr<UvSource> uv_source_;
+
   DISALLOW_COPY_AND_ASSIGN(NodeBindingsLinux);
 };
 
@@ -124,6 +124,10 @@ const char kCipherSuiteBlacklist[] = "cipher-suite-blacklist";
 // The browser process app model ID
 const char kAppUserModelId[] = "app-user-model-id";
 
+// Run node's libuv loop from the browser main thread's event loop instead of
+// polling it on a separate thread (Linux only).
+const char kUvPollOnMainThread[] = "uv-poll-on-main-thread";
+
 // The command line switch versions of the options.
 const char kBackgroundColor[] = "background-color";
 const char kZoomFactor[]      = "zoom-factor";
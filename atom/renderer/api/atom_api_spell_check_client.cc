@@ -5,9 +5,12 @@
 #include "atom/renderer/api/atom_api_spell_check_client.h"
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
+#include "atom/common/native_mate_converters/callback.h"
 #include "atom/common/native_mate_converters/string16_converter.h"
+#include "base/bind.h"
 #include "base/logging.h"
 #include "native_mate/converter.h"
 #include "native_mate/dictionary.h"
@@ -21,6 +24,9 @@ namespace api {
 
 namespace {
 
+// Number of word verdicts remembered by each client.
+const size_t kWordCacheSize = 10000;
+
 bool HasWordCharacters(const base::string16& text, int index) {
   const base::char16* data = text.data();
   int length = text.length();
@@ -36,20 +42,37 @@ bool HasWordCharacters(const base::string16& text, int index) {
 
 }  // namespace
 
+SpellCheckClient::Word::Word() : start(0), length(0) {}
+
+SpellCheckClient::Word::Word(const Word& other) = default;
+
+SpellCheckClient::Word::~Word() {}
+
+SpellCheckClient::PendingRequest::PendingRequest()
+    : completion(nullptr), words_checked(false) {}
+
+SpellCheckClient::PendingRequest::~PendingRequest() {}
+
 SpellCheckClient::SpellCheckClient(const std::string& language,
                                    bool auto_spell_correct_turned_on,
                                    v8::Isolate* isolate,
                                    v8::Local<v8::Object> provider)
     : isolate_(isolate),
-      provider_(isolate, provider) {
+      provider_(isolate, provider),
+      word_cache_(kWordCacheSize),
+      next_request_id_(0),
+      weak_factory_(this) {
   character_attributes_.SetDefaultLanguage(language);
 
-  // Persistent the method.
+  // Persistent the methods.
   mate::Dictionary dict(isolate, provider);
   dict.Get("spellCheck", &spell_check_);
+  dict.Get("spellCheckWords", &spell_check_words_);
 }
 
-SpellCheckClient::~SpellCheckClient() {}
+SpellCheckClient::~SpellCheckClient() {
+  cancelAllPendingRequests();
+}
 
 void SpellCheckClient::checkSpelling(
     const blink::WebString& text,
@@ -75,9 +98,20 @@ void SpellCheckClient::requestCheckingOfText(
     return;
   }
 
-  std::vector<blink::WebTextCheckingResult> results;
-  SpellCheckText(text, false, &results);
-  completionCallback->didFinishCheckingText(results);
+  if (spell_check_words_.IsEmpty()) {
+    std::vector<blink::WebTextCheckingResult> results;
+    SpellCheckText(text, false, &results);
+    completionCallback->didFinishCheckingText(results);
+    return;
+  }
+
+  std::unique_ptr<PendingRequest> request(new PendingRequest);
+  request->completion = completionCallback;
+  SplitText(text, &request->words);
+
+  int request_id = next_request_id_++;
+  pending_requests_[request_id] = std::move(request);
+  RequestWords(request_id);
 }
 
 void SpellCheckClient::showSpellingUI(bool show) {
@@ -91,47 +125,39 @@ void SpellCheckClient::updateSpellingUIWithMisspelledWord(
     const blink::WebString& word) {
 }
 
+void SpellCheckClient::cancelAllPendingRequests() {
+  std::map<int, std::unique_ptr<PendingRequest>> requests;
+  requests.swap(pending_requests_);
+  for (const auto& request : requests)
+    request.second->completion->didCancelCheckingText();
+}
+
 void SpellCheckClient::SpellCheckText(
     const base::string16& text,
     bool stop_at_first_result,
     std::vector<blink::WebTextCheckingResult>* results) {
-  if (text.length() == 0 || spell_check_.IsEmpty())
+  if (text.length() == 0 ||
+      (spell_check_.IsEmpty() && spell_check_words_.IsEmpty()))
     return;
 
-  base::string16 word;
-  int word_start;
-  int word_length;
-  if (!text_iterator_.IsInitialized() &&
-      !text_iterator_.Initialize(&character_attributes_, true)) {
-      // We failed to initialize text_iterator_, return as spelled correctly.
-      VLOG(1) << "Failed to initialize SpellcheckWordIterator";
-      return;
-  }
-
-  base::string16 in_word(text);
-  text_iterator_.SetText(in_word.c_str(), in_word.size());
-  SpellcheckWordIterator::WordIteratorStatus status;
-  while (true) {
-    status = text_iterator_.GetNextWord(&word, &word_start, &word_length);
-    if (status == SpellcheckWordIterator::IS_END_OF_TEXT) {
-      return;
-    } else if (status == SpellcheckWordIterator::IS_SKIPPABLE) {
-      continue;
-    }
-
+  std::vector<Word> words;
+  SplitText(text, &words);
+  for (const Word& word : words) {
     // Found a word (or a contraction) that the spellchecker can check the
     // spelling of.
-    if (SpellCheckWord(word))
+    if (SpellCheckWord(word.text))
       continue;
 
     // If the given word is a concatenated word of two or more valid words
     // (e.g. "hello:hello"), we should treat it as a valid word.
-    if (IsValidContraction(word))
+    std::vector<base::string16> contraction_words;
+    GetContractionWords(word.text, &contraction_words);
+    if (IsValidContraction(contraction_words))
       continue;
 
     blink::WebTextCheckingResult result;
-    result.location = word_start;
-    result.length = word_length;
+    result.location = word.start;
+    result.length = word.length;
     results->push_back(result);
 
     if (stop_at_first_result)
@@ -140,6 +166,11 @@ void SpellCheckClient::SpellCheckText(
 }
 
 bool SpellCheckClient::SpellCheckWord(const base::string16& word_to_check) {
+  auto cached = word_cache_.Get(word_to_check);
+  if (cached != word_cache_.end())
+    return cached->second;
+
+  // Providers that only check batches of words are not asked synchronously.
   if (spell_check_.IsEmpty())
     return true;
 
@@ -158,22 +189,183 @@ bool SpellCheckClient::SpellCheckWord(const base::string16& word_to_check) {
     return true;
   }
 
-  if (result->IsBoolean())
-    return result->BooleanValue();
-  else
-    return true;
+  bool correct = result->IsBoolean() ? result->BooleanValue() : true;
+  word_cache_.Put(word_to_check, correct);
+  return correct;
+}
+
+void SpellCheckClient::SplitText(const base::string16& text,
+                                 std::vector<Word>* words) {
+  if (!text_iterator_.IsInitialized() &&
+      !text_iterator_.Initialize(&character_attributes_, true)) {
+      // We failed to initialize text_iterator_, return as spelled correctly.
+      VLOG(1) << "Failed to initialize SpellcheckWordIterator";
+      return;
+  }
+
+  text_iterator_.SetText(text.c_str(), text.size());
+  Word word;
+  while (true) {
+    SpellcheckWordIterator::WordIteratorStatus status =
+        text_iterator_.GetNextWord(&word.text, &word.start, &word.length);
+    if (status == SpellcheckWordIterator::IS_END_OF_TEXT) {
+      return;
+    } else if (status == SpellcheckWordIterator::IS_SKIPPABLE) {
+      continue;
+    }
+
+    words->push_back(word);
+  }
+}
+
+void SpellCheckClient::RequestWords(int request_id) {
+  PendingRequest* request = pending_requests_[request_id].get();
+  request->unknown_words.clear();
+  for (Word& word : request->words) {
+    if (!request->words_checked) {
+      AddRequestWord(request, word.text);
+      continue;
+    }
+
+    // The parts of a contraction are only checked once the whole word is
+    // known to be misspelled.
+    if (request->verdicts[word.text])
+      continue;
+    GetContractionWords(word.text, &word.contraction_words);
+    for (const base::string16& contraction_word : word.contraction_words)
+      AddRequestWord(request, contraction_word);
+  }
+
+  if (request->unknown_words.empty()) {
+    ContinueRequest(request_id);
+    return;
+  }
+
+  v8::HandleScope handle_scope(isolate_);
+  v8::Local<v8::Object> provider = provider_.NewHandle();
+  v8::Context::Scope context_scope(provider->CreationContext());
+  v8::MicrotasksScope microtasks(
+      isolate_, v8::MicrotasksScope::kDoNotRunMicrotasks);
+
+  base::Callback<void(const std::vector<base::string16>&)> callback =
+      base::Bind(&SpellCheckClient::OnWordsChecked,
+                 weak_factory_.GetWeakPtr(), request_id);
+  v8::Local<v8::Value> args[] = {
+    mate::ConvertToV8(isolate_, request->unknown_words),
+    mate::ConvertToV8(isolate_, callback),
+  };
+  // The provider may already have answered when the call returns.
+  v8::TryCatch try_catch(isolate_);
+  spell_check_words_.NewHandle()->Call(provider, arraysize(args), args);
+  if (!try_catch.HasCaught() && !try_catch.HasTerminated())
+    return;
+
+  auto it = pending_requests_.find(request_id);
+  if (it != pending_requests_.end()) {
+    std::unique_ptr<PendingRequest> failed = std::move(it->second);
+    pending_requests_.erase(it);
+    failed->completion->didCancelCheckingText();
+  }
+}
+
+void SpellCheckClient::OnWordsChecked(
+    int request_id,
+    const std::vector<base::string16>& misspelled) {
+  auto it = pending_requests_.find(request_id);
+  if (it == pending_requests_.end())
+    return;
+
+  PendingRequest* request = it->second.get();
+  for (const base::string16& word : misspelled) {
+    auto verdict = request->verdicts.find(word);
+    if (verdict != request->verdicts.end())
+      verdict->second = false;
+  }
+  for (const base::string16& word : request->unknown_words)
+    word_cache_.Put(word, request->verdicts[word]);
+
+  ContinueRequest(request_id);
+}
+
+void SpellCheckClient::AddRequestWord(PendingRequest* request,
+                                      const base::string16& word) {
+  if (request->verdicts.count(word))
+    return;
+  auto cached = word_cache_.Get(word);
+  if (cached != word_cache_.end()) {
+    request->verdicts[word] = cached->second;
+  } else {
+    // Words the provider does not report as misspelled are correct.
+    request->verdicts[word] = true;
+    request->unknown_words.push_back(word);
+  }
+}
+
+void SpellCheckClient::ContinueRequest(int request_id) {
+  auto it = pending_requests_.find(request_id);
+  if (it == pending_requests_.end())
+    return;
+
+  if (it->second->words_checked) {
+    FinishRequest(request_id);
+    return;
+  }
+
+  // Check the parts of the misspelled contractions next.
+  it->second->words_checked = true;
+  RequestWords(request_id);
+}
+
+void SpellCheckClient::FinishRequest(int request_id) {
+  auto it = pending_requests_.find(request_id);
+  if (it == pending_requests_.end())
+    return;
+
+  std::unique_ptr<PendingRequest> request = std::move(it->second);
+  pending_requests_.erase(it);
+
+  std::vector<blink::WebTextCheckingResult> results;
+  for (const Word& word : request->words) {
+    if (request->verdicts[word.text])
+      continue;
+
+    // Same as IsValidContraction.
+    bool valid_contraction = true;
+    for (const base::string16& contraction_word : word.contraction_words)
+      valid_contraction = valid_contraction &&
+          request->verdicts[contraction_word];
+    if (valid_contraction)
+      continue;
+
+    blink::WebTextCheckingResult result;
+    result.location = word.start;
+    result.length = word.length;
+    results.push_back(result);
+  }
+  request->completion->didFinishCheckingText(results);
 }
 
 // Returns whether or not the given string is a valid contraction.
 // This function is a fall-back when the SpellcheckWordIterator class
 // returns a concatenated word which is not in the selected dictionary
 // (e.g. "in'n'out") but each word is valid.
-bool SpellCheckClient::IsValidContraction(const base::string16& contraction) {
+bool SpellCheckClient::IsValidContraction(
+    const std::vector<base::string16>& words) {
+  for (const base::string16& word : words) {
+    if (!SpellCheckWord(word))
+      return false;
+  }
+  return true;
+}
+
+void SpellCheckClient::GetContractionWords(
+    const base::string16& contraction,
+    std::vector<base::string16>* words) {
   if (!contraction_iterator_.IsInitialized() &&
       !contraction_iterator_.Initialize(&character_attributes_, false)) {
     // We failed to initialize the word iterator, return as spelled correctly.
     VLOG(1) << "Failed to initialize contraction_iterator_";
-    return true;
+    return;
   }
 
   contraction_iterator_.SetText(contraction.c_str(), contraction.length());
@@ -185,15 +377,11 @@ bool SpellCheckClient::IsValidContraction(const base::string16& contraction) {
   while (true) {
     SpellcheckWordIterator::WordIteratorStatus status =
         contraction_iterator_.GetNextWord(&word, &word_start, &word_length);
-    if (status == SpellcheckWordIterator::IS_END_OF_TEXT) {
-      return true;
-    } else if (status == SpellcheckWordIterator::IS_SKIPPABLE) {
-      return true;
-    }
-    if (!SpellCheckWord(word))
-      return false;
+    if (status == SpellcheckWordIterator::IS_END_OF_TEXT ||
+        status == SpellcheckWordIterator::IS_SKIPPABLE)
+      return;
+    words->push_back(word);
   }
-  return true;
 }
 
 }  // namespace api
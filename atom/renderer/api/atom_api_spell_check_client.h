@@ -5,10 +5,14 @@
 #ifndef ATOM_RENDERER_API_ATOM_API_SPELL_CHECK_CLIENT_H_
 #define ATOM_RENDERER_API_ATOM_API_SPELL_CHECK_CLIENT_H_
 
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "base/callback.h"
+#include "base/containers/mru_cache.h"
+#include "base/memory/weak_ptr.h"
 #include "components/spellcheck/renderer/spellcheck.h"
 #include "components/spellcheck/renderer/spellcheck_worditerator.h"
 #include "native_mate/scoped_persistent.h"
@@ -18,6 +22,10 @@ namespace atom {
 
 namespace api {
 
+// Checks spelling with a JS provider. A provider with a
+// `spellCheckWords(words, callback)` method gets all unknown words of a text
+// in one call and answers asynchronously, otherwise `spellCheck(word)` is
+// called for every word. Verdicts are kept in an LRU cache either way.
 class SpellCheckClient : public blink::WebSpellCheckClient {
  public:
   SpellCheckClient(const std::string& language,
@@ -27,6 +35,35 @@ class SpellCheckClient : public blink::WebSpellCheckClient {
   virtual ~SpellCheckClient();
 
  private:
+  // A word found by |text_iterator_| and, once it is known to be misspelled,
+  // the words it consists of if it is a contraction.
+  struct Word {
+    Word();
+    Word(const Word& other);
+    ~Word();
+
+    base::string16 text;
+    int start;
+    int length;
+    std::vector<base::string16> contraction_words;
+  };
+
+  // A requestCheckingOfText waiting for `spellCheckWords`.
+  struct PendingRequest {
+    PendingRequest();
+    ~PendingRequest();
+
+    blink::WebTextCheckingCompletion* completion;
+    std::vector<Word> words;
+    // Verdicts of the words known when the request was made plus those
+    // passed to the provider.
+    std::map<base::string16, bool> verdicts;
+    std::vector<base::string16> unknown_words;
+    // Whether the whole words have been checked and the parts of misspelled
+    // contractions are next.
+    bool words_checked;
+  };
+
   // blink::WebSpellCheckClient:
   void checkSpelling(
       const blink::WebString& text,
@@ -42,7 +79,7 @@ class SpellCheckClient : public blink::WebSpellCheckClient {
   bool isShowingSpellingUI() override;
   void updateSpellingUIWithMisspelledWord(
       const blink::WebString& word) override;
-  void cancelAllPendingRequests() { }
+  void cancelAllPendingRequests();
 
   // Check the spelling of text.
   void SpellCheckText(const base::string16& text,
@@ -52,14 +89,41 @@ class SpellCheckClient : public blink::WebSpellCheckClient {
   // Call JavaScript to check spelling a word.
   bool SpellCheckWord(const base::string16& word_to_check);
 
+  // Splits |text| into words.
+  void SplitText(const base::string16& text, std::vector<Word>* words);
+
+  // Calls `spellCheckWords` with the words of a pending request that are
+  // not in the cache, or continues the request if there are none.
+  void RequestWords(int request_id);
+
+  // Called by the provider with the misspelled words of a request.
+  void OnWordsChecked(int request_id,
+                      const std::vector<base::string16>& misspelled);
+
+  // Adds the verdict of |word| to |request| if it is cached, otherwise
+  // queues it for the provider.
+  void AddRequestWord(PendingRequest* request, const base::string16& word);
+
+  // Requests the parts of misspelled contractions after the whole words,
+  // then finishes the request.
+  void ContinueRequest(int request_id);
+
+  // Passes the misspelled words of a request to its completion.
+  void FinishRequest(int request_id);
+
   // Find a possible correctly spelled word for a misspelled word. Computes an
   // empty string if input misspelled word is too long, there is ambiguity, or
   // the correct spelling cannot be determined.
   base::string16 GetAutoCorrectionWord(const base::string16& word);
 
-  // Returns whether or not the given word is a contraction of valid words
-  // (e.g. "word:word").
-  bool IsValidContraction(const base::string16& word);
+  // Returns whether or not the words of a contraction, from
+  // GetContractionWords, are valid (e.g. "word:word").
+  bool IsValidContraction(const std::vector<base::string16>& words);
+
+  // Splits |contraction| into the words that have to be spelled correctly
+  // for it to be valid.
+  void GetContractionWords(const base::string16& contraction,
+                           std::vector<base::string16>* words);
 
   // Represents character attributes used for filtering out characters which
   // are not supported by this SpellCheck object.
@@ -78,6 +142,15 @@ class SpellCheckClient : public blink::WebSpellCheckClient {
   v8::Isolate* isolate_;
   mate::ScopedPersistent<v8::Object> provider_;
   mate::ScopedPersistent<v8::Function> spell_check_;
+  mate::ScopedPersistent<v8::Function> spell_check_words_;
+
+  // Recent verdicts, true for correctly spelled words.
+  base::MRUCache<base::string16, bool> word_cache_;
+
+  std::map<int, std::unique_ptr<PendingRequest>> pending_requests_;
+  int next_request_id_;
+
+  base::WeakPtrFactory<SpellCheckClient> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(SpellCheckClient);
 };
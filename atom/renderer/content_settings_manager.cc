@@ -4,11 +4,14 @@
 
 #include "atom/renderer/content_settings_manager.h"
 
+#include <algorithm>
+#include <functional>
 #include <string>
 #include <vector>
 #include "atom/common/api/api_messages.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
 #include "base/values.h"
-#include "components/content_settings/core/common/content_settings_pattern.h"
 #include "content/public/common/url_constants.h"
 #include "content/public/renderer/render_thread.h"
 #include "url/gurl.h"
@@ -16,7 +19,85 @@
 
 namespace atom {
 
-ContentSettingsManager::ContentSettingsManager() {
+namespace {
+
+// Upper bound on cached origin pair results.
+const size_t kMaxCachedResults = 1000;
+
+// Returns the host a rule with |pattern| can match, or an empty string if
+// the pattern can match any host or its host can't be compared directly
+// with a canonical url host (wildcards, IPv6 literals, non-ascii).
+std::string GetIndexHost(const std::string& pattern) {
+  base::StringPiece host(pattern);
+  size_t scheme_end = host.find("://");
+  if (scheme_end != base::StringPiece::npos)
+    host = host.substr(scheme_end + 3);
+  if (host.starts_with("[*.]"))
+    host = host.substr(4);
+  host = host.substr(0, host.find_first_of(":/"));
+  if (host.empty() ||
+      host.ends_with(".") ||
+      host.find_first_of("*[]%") != base::StringPiece::npos ||
+      !base::IsStringASCII(host))
+    return std::string();
+  return base::ToLowerASCII(host);
+}
+
+}  // namespace
+
+ContentSettingsManager::CompiledRuleSet::CompiledRuleSet() {}
+
+ContentSettingsManager::CompiledRuleSet::~CompiledRuleSet() {}
+
+ContentSetting ContentSettingsManager::CompiledRuleSet::Match(
+    const GURL& primary_url,
+    const GURL& secondary_url) const {
+  std::vector<size_t> candidates(unindexed);
+
+  // a rule for example.com can match example.com and its subdomains
+  base::StringPiece host(primary_url.host_piece());
+  if (host.ends_with("."))
+    host.remove_suffix(1);
+  while (!host.empty()) {
+    auto it = host_index.find(host.as_string());
+    if (it != host_index.end())
+      candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    size_t dot = host.find('.');
+    if (dot == base::StringPiece::npos)
+      break;
+    host = host.substr(dot + 1);
+  }
+
+  // the last matching rule wins
+  std::sort(candidates.begin(), candidates.end(), std::greater<size_t>());
+
+  ContentSettingsPattern first_party_pattern;
+  bool first_party_pattern_created = false;
+  for (size_t index : candidates) {
+    const CompiledRule& rule = rules[index];
+    if (!rule.primary_pattern.Matches(primary_url))
+      continue;
+
+    if (rule.first_party) {
+      if (!first_party_pattern_created) {
+        first_party_pattern = ContentSettingsPattern::FromString(
+            "[*.]" + primary_url.HostNoBrackets());
+        first_party_pattern_created = true;
+      }
+      if (!first_party_pattern.Matches(secondary_url))
+        continue;
+    } else if (rule.has_secondary_pattern &&
+               !rule.secondary_pattern.Matches(secondary_url)) {
+      continue;
+    }
+
+    return rule.setting;
+  }
+  return CONTENT_SETTING_DEFAULT;
+}
+
+ContentSettingsManager::ContentSettingsManager()
+    : content_settings_version_(0) {
   content::RenderThread::Get()->AddObserver(this);
 }
 
@@ -37,6 +118,8 @@ bool ContentSettingsManager::OnControlMessageReceived(
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(ContentSettingsManager, message)
     IPC_MESSAGE_HANDLER(AtomMsg_UpdateContentSettings, OnUpdateContentSettings)
+    IPC_MESSAGE_HANDLER(AtomMsg_UpdateContentSettingsDelta,
+                        OnUpdateContentSettingsDelta)
     IPC_MESSAGE_HANDLER(AtomMsg_UpdateWebKitPrefs, OnUpdateWebKitPrefs)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
@@ -49,8 +132,142 @@ void ContentSettingsManager::OnUpdateWebKitPrefs(
 }
 
 void ContentSettingsManager::OnUpdateContentSettings(
+    int version,
     const base::DictionaryValue& content_settings) {
   content_settings_ = content_settings.CreateDeepCopy();
+  content_settings_version_ = version;
+
+  compiled_rules_.clear();
+  result_cache_.clear();
+  for (base::DictionaryValue::Iterator it(*content_settings_);
+      !it.IsAtEnd();
+      it.Advance()) {
+    CompileRules(it.key());
+  }
+}
+
+void ContentSettingsManager::OnUpdateContentSettingsDelta(
+    int base_version,
+    const base::ListValue& changes) {
+  if (!content_settings_ || base_version != content_settings_version_) {
+    content::RenderThread::Get()->Send(new AtomHostMsg_RequestContentSettings);
+    return;
+  }
+
+  result_cache_.clear();
+  for (const auto& value : changes) {
+    const base::DictionaryValue* change = nullptr;
+    if (!value->GetAsDictionary(&change) ||
+        !ApplyContentSettingsChange(*change)) {
+      // the settings no longer match the browser so wait for all of them
+      content_settings_version_ = 0;
+      content::RenderThread::Get()->Send(
+          new AtomHostMsg_RequestContentSettings);
+      return;
+    }
+  }
+  content_settings_version_ = base_version + 1;
+}
+
+bool ContentSettingsManager::ApplyContentSettingsChange(
+    const base::DictionaryValue& change) {
+  std::string content_type;
+  std::string op;
+  if (!change.GetString("type", &content_type) ||
+      !change.GetString("op", &op))
+    return false;
+
+  if (op == "remove") {
+    content_settings_->RemoveWithoutPathExpansion(content_type, nullptr);
+  } else if (op == "set") {
+    const base::Value* value = nullptr;
+    if (!change.Get("value", &value))
+      return false;
+    content_settings_->SetWithoutPathExpansion(content_type,
+                                               value->CreateDeepCopy());
+  } else if (op == "splice") {
+    base::ListValue* rules = nullptr;
+    const base::ListValue* inserted_rules = nullptr;
+    int start = 0;
+    int delete_count = 0;
+    if (!content_settings_->GetListWithoutPathExpansion(content_type,
+                                                        &rules) ||
+        !change.GetInteger("start", &start) ||
+        !change.GetInteger("deleteCount", &delete_count) ||
+        !change.GetList("rules", &inserted_rules) ||
+        start < 0 || delete_count < 0 ||
+        static_cast<size_t>(start + delete_count) > rules->GetSize())
+      return false;
+
+    for (int i = 0; i < delete_count; ++i)
+      rules->Remove(start, nullptr);
+    for (size_t i = 0; i < inserted_rules->GetSize(); ++i) {
+      const base::Value* rule = nullptr;
+      inserted_rules->Get(i, &rule);
+      rules->Insert(start + i, rule->CreateDeepCopy());
+    }
+  } else {
+    return false;
+  }
+
+  CompileRules(content_type);
+  return true;
+}
+
+void ContentSettingsManager::CompileRules(const std::string& content_type) {
+  compiled_rules_.erase(content_type);
+
+  const base::ListValue* rules = nullptr;
+  if (!content_settings_->GetListWithoutPathExpansion(content_type, &rules))
+    return;
+
+  std::unique_ptr<CompiledRuleSet> rule_set(new CompiledRuleSet);
+  for (const auto& value : *rules) {
+    const base::DictionaryValue* rule = nullptr;
+    std::string pattern_string;
+    std::string setting_string;
+    if (!value->GetAsDictionary(&rule) ||
+        !rule->GetString("primaryPattern", &pattern_string) ||
+        !rule->GetString("setting", &setting_string)) {
+      // skip invalid entries
+      // TODO(bridiver) should also send an ipc error message
+      continue;
+    }
+
+    CompiledRule compiled;
+    compiled.primary_pattern =
+        ContentSettingsPattern::FromString(pattern_string);
+    // an invalid pattern never matches
+    if (!compiled.primary_pattern.IsValid())
+      continue;
+
+    std::string secondary_pattern_string;
+    rule->GetString("secondaryPattern", &secondary_pattern_string);
+    compiled.first_party = secondary_pattern_string == "[firstParty]";
+    compiled.has_secondary_pattern =
+        !compiled.first_party && !secondary_pattern_string.empty();
+    if (compiled.has_secondary_pattern) {
+      compiled.secondary_pattern =
+          ContentSettingsPattern::FromString(secondary_pattern_string);
+      if (!compiled.secondary_pattern.IsValid())
+        continue;
+    }
+
+    if (setting_string != "block" && setting_string != "deny") {
+      compiled.setting = ContentSetting::CONTENT_SETTING_ALLOW;
+    } else {
+      compiled.setting = ContentSetting::CONTENT_SETTING_BLOCK;
+    }
+
+    size_t index = rule_set->rules.size();
+    rule_set->rules.push_back(compiled);
+    std::string host = GetIndexHost(pattern_string);
+    if (host.empty())
+      rule_set->unindexed.push_back(index);
+    else
+      rule_set->host_index[host].push_back(index);
+  }
+  compiled_rules_[content_type] = std::move(rule_set);
 }
 
 ContentSetting ContentSettingsManager::GetSetting(
@@ -95,47 +312,32 @@ ContentSetting ContentSettingsManager::GetContentSettingFromRules(
     ? ContentSetting::CONTENT_SETTING_ALLOW
     : ContentSetting::CONTENT_SETTING_BLOCK;
 
-  const base::ListValue* rules = nullptr;
-  if (!content_settings_->GetList(content_type, &rules))
+  auto rule_set = compiled_rules_.find(content_type);
+  if (rule_set == compiled_rules_.end())
     return result;
 
-  // all rules are evaluated in order and the
-  // most specific matching rule will apply
-  for (base::ListValue::const_iterator it = rules->begin();
-       it != rules->end(); ++it) {
-    base::DictionaryValue* rule;
-    std::string pattern_string;
-    std::string setting_string;
-    if (!(*it)->GetAsDictionary(&rule) ||
-        !rule->GetString("primaryPattern", &pattern_string) ||
-        !rule->GetString("setting", &setting_string)) {
-      // skip invalid entries
-      // TODO(bridiver) should also send an ipc error message
-      ++it;
+  // patterns only look at the path of file urls so http(s) results can be
+  // shared by every url with the same origins
+  ContentSetting setting;
+  if (primary_url.SchemeIsHTTPOrHTTPS() &&
+      secondary_url.SchemeIsHTTPOrHTTPS()) {
+    std::string key = content_type + " " +
+        primary_url.GetOrigin().spec() + " " +
+        secondary_url.GetOrigin().spec();
+    auto cached = result_cache_.find(key);
+    if (cached != result_cache_.end()) {
+      setting = cached->second;
     } else {
-      std::string secondary_pattern_string;
-      rule->GetString("secondaryPattern", &secondary_pattern_string);
-
-      ContentSetting setting = result;
-      if (setting_string != "block" && setting_string != "deny") {
-        setting = ContentSetting::CONTENT_SETTING_ALLOW;
-      } else {
-        setting = ContentSetting::CONTENT_SETTING_BLOCK;
-      }
-
-      if (secondary_pattern_string == "[firstParty]") {
-        secondary_pattern_string = "[*.]" + primary_url.HostNoBrackets();
-      }
-
-      if (ContentSettingsPattern::FromString(
-            pattern_string).Matches(primary_url) &&
-          // if there is a secondary resource pattern it has to match as well
-          (secondary_pattern_string.empty() ||
-            ContentSettingsPattern::FromString(
-              secondary_pattern_string).Matches(secondary_url)))
-        result = setting;
+      setting = rule_set->second->Match(primary_url, secondary_url);
+      if (result_cache_.size() >= kMaxCachedResults)
+        result_cache_.clear();
+      result_cache_[key] = setting;
     }
+  } else {
+    setting = rule_set->second->Match(primary_url, secondary_url);
   }
-  return result;
+
+  return setting == CONTENT_SETTING_DEFAULT ? result : setting;
 }
+
 }  // namespace atom
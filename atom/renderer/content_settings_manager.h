@@ -5,11 +5,13 @@
 #ifndef ATOM_RENDERER_CONTENT_SETTINGS_MANAGER_H_
 #define ATOM_RENDERER_CONTENT_SETTINGS_MANAGER_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 #include "base/values.h"
 #include "components/content_settings/core/common/content_settings.h"
+#include "components/content_settings/core/common/content_settings_pattern.h"
 #include "content/public/common/web_preferences.h"
 #include "content/public/renderer/render_thread_observer.h"
 
@@ -41,6 +43,36 @@ class ContentSettingsManager : public content::RenderThreadObserver {
   std::vector<std::string> GetContentTypes();
 
  private:
+  struct CompiledRule {
+    ContentSettingsPattern primary_pattern;
+    ContentSettingsPattern secondary_pattern;
+    bool has_secondary_pattern;
+    // "[firstParty]" secondary pattern, matched against the primary host
+    bool first_party;
+    ContentSetting setting;
+  };
+
+  // The rules for one content type, in the order they were received. Rules
+  // whose primary pattern names a host are indexed by that host, the rest
+  // are checked for every url.
+  struct CompiledRuleSet {
+    CompiledRuleSet();
+    ~CompiledRuleSet();
+
+    // Returns the setting of the last matching rule or
+    // CONTENT_SETTING_DEFAULT if no rule matches.
+    ContentSetting Match(const GURL& primary_url,
+                         const GURL& secondary_url) const;
+
+    std::vector<CompiledRule> rules;
+    std::map<std::string, std::vector<size_t>> host_index;
+    std::vector<size_t> unindexed;
+  };
+
+  // Recompiles the rules of |content_type| after its value changed.
+  void CompileRules(const std::string& content_type);
+  bool ApplyContentSettingsChange(const base::DictionaryValue& change);
+
   ContentSetting GetContentSettingFromRules(
     const GURL& primary_url,
     const GURL& secondary_url,
@@ -53,11 +85,19 @@ class ContentSettingsManager : public content::RenderThreadObserver {
   void OnUpdateWebKitPrefs(
       const content::WebPreferences& web_preferences);
   void OnUpdateContentSettings(
+      int version,
       const base::DictionaryValue& content_settings);
+  void OnUpdateContentSettingsDelta(
+      int base_version,
+      const base::ListValue& changes);
 
 
   content::WebPreferences web_preferences_;
   std::unique_ptr<base::DictionaryValue> content_settings_;
+  int content_settings_version_;
+  std::map<std::string, std::unique_ptr<CompiledRuleSet>> compiled_rules_;
+  // rule results for http(s) origin pairs, cleared when the rules change
+  std::map<std::string, ContentSetting> result_cache_;
 
   DISALLOW_COPY_AND_ASSIGN(ContentSettingsManager);
 };
@@ -14,6 +14,7 @@
 #include "base/path_service.h"
 #include "base/strings/utf_string_conversions.h"
 #include "brave/browser/notifications/platform_notification_service_impl.h"
+#include "brave/common/workers/worker_channel.h"
 #include "brave/grit/brave_resources.h"
 #include "brightray/browser/brightray_paths.h"
 #include "chrome/browser/content_settings/host_content_settings_map_factory.h"
@@ -185,6 +186,7 @@ void BraveContentBrowserClient::RenderProcessWillLaunch(
   host->AddFilter(new printing::PrintingMessageFilter(id, profile));
   host->AddFilter(new TtsMessageFilter(host->GetBrowserContext()));
   host->AddFilter(new PluginInfoMessageFilter(id, profile));
+  host->AddFilter(new WorkerChannelMessageFilter(id));
 
 #if BUILDFLAG(ENABLE_EXTENSIONS)
   extensions_part_->RenderProcessWillLaunch(host);
@@ -14,6 +14,9 @@ namespace brave {
 
 namespace {
 
+// Bounds the cache for pages that request permissions from many origins.
+const size_t kMaxCachedDecisions = 1000;
+
 bool WebContentsDestroyed(int render_process_id, int render_frame_id) {
   if (render_process_id == MSG_ROUTING_NONE)
     return false;
@@ -38,7 +41,9 @@ bool WebContentsDestroyed(int render_process_id, int render_frame_id) {
 }  // namespace
 
 BravePermissionManager::BravePermissionManager()
-    : request_id_(0) {
+    : request_id_(0),
+      cache_hits_(0),
+      cache_misses_(0) {
 }
 
 BravePermissionManager::~BravePermissionManager() {
@@ -54,9 +59,85 @@ void BravePermissionManager::SetPermissionRequestHandler(
     }
     pending_requests_.clear();
   }
+  // Decisions of the previous handler don't hold for this one.
+  decisions_.clear();
   request_handler_ = handler;
 }
 
+void BravePermissionManager::SetDecisionCacheTTL(base::TimeDelta ttl) {
+  decision_ttl_ = ttl;
+  if (decision_ttl_.is_zero())
+    decisions_.clear();
+}
+
+void BravePermissionManager::ClearDecisionCache(
+    const GURL& requesting_origin) {
+  if (requesting_origin.is_empty()) {
+    decisions_.clear();
+    return;
+  }
+
+  GURL origin = requesting_origin.GetOrigin();
+  for (auto it = decisions_.begin(); it != decisions_.end();) {
+    if (std::get<1>(it->first) == origin)
+      it = decisions_.erase(it);
+    else
+      ++it;
+  }
+}
+
+BravePermissionManager::CacheStats
+BravePermissionManager::GetDecisionCacheStats() const {
+  CacheStats stats;
+  stats.hits = cache_hits_;
+  stats.misses = cache_misses_;
+  stats.size = decisions_.size();
+  return stats;
+}
+
+bool BravePermissionManager::GetCachedDecision(
+    const DecisionKey& key,
+    blink::mojom::PermissionStatus* status) {
+  if (decision_ttl_.is_zero())
+    return false;
+
+  auto it = decisions_.find(key);
+  if (it != decisions_.end() &&
+      it->second.expiration <= base::TimeTicks::Now()) {
+    decisions_.erase(it);
+    it = decisions_.end();
+  }
+  if (it == decisions_.end()) {
+    cache_misses_++;
+    return false;
+  }
+
+  cache_hits_++;
+  *status = it->second.status;
+  return true;
+}
+
+void BravePermissionManager::CacheDecision(
+    const DecisionKey& key,
+    blink::mojom::PermissionStatus status) {
+  if (decision_ttl_.is_zero() ||
+      status == blink::mojom::PermissionStatus::ASK)
+    return;
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (decisions_.size() >= kMaxCachedDecisions) {
+    for (auto it = decisions_.begin(); it != decisions_.end();) {
+      if (it->second.expiration <= now)
+        it = decisions_.erase(it);
+      else
+        ++it;
+    }
+    if (decisions_.size() >= kMaxCachedDecisions)
+      decisions_.clear();
+  }
+  decisions_[key] = { status, now + decision_ttl_ };
+}
+
 int BravePermissionManager::RequestPermission(
     content::PermissionType permission,
     content::RenderFrameHost* render_frame_host,
@@ -86,6 +167,14 @@ int BravePermissionManager::RequestPermission(
   }
 
   if (!request_handler_.is_null()) {
+    DecisionKey key(permission, requesting_origin.GetOrigin(),
+                    url.GetOrigin());
+    blink::mojom::PermissionStatus status;
+    if (GetCachedDecision(key, &status)) {
+      response_callback.Run(status);
+      return kNoPendingOperation;
+    }
+
     ++request_id_;
     auto callback = base::Bind(&BravePermissionManager::OnPermissionResponse,
                                base::Unretained(this),
@@ -94,7 +183,7 @@ int BravePermissionManager::RequestPermission(
                                response_callback);
 
     pending_requests_[request_id_] =
-        { render_process_id, render_frame_id, callback };
+        { render_process_id, render_frame_id, callback, key, false };
 
     request_handler_.Run(requesting_origin, url, permission, callback);
     return request_id_;
@@ -111,6 +200,8 @@ void BravePermissionManager::OnPermissionResponse(
     blink::mojom::PermissionStatus status) {
   auto request = pending_requests_.find(request_id);
   if (request != pending_requests_.end()) {
+    if (!request->second.cancelled)
+      CacheDecision(request->second.key, status);
     if (!WebContentsDestroyed(
         request->second.render_process_id, request->second.render_frame_id))
       callback.Run(status);
@@ -123,6 +214,7 @@ void BravePermissionManager::CancelPermissionRequest(int request_id) {
   if (request != pending_requests_.end()) {
     if (!WebContentsDestroyed(
         request->second.render_process_id, request->second.render_frame_id)) {
+      request->second.cancelled = true;
       request->second.callback.Run(blink::mojom::PermissionStatus::DENIED);
     } else {
       pending_requests_.erase(request);
@@ -130,4 +222,27 @@ void BravePermissionManager::CancelPermissionRequest(int request_id) {
   }
 }
 
+void BravePermissionManager::ResetPermission(
+    content::PermissionType permission,
+    const GURL& requesting_origin,
+    const GURL& embedding_origin) {
+  decisions_.erase(DecisionKey(permission, requesting_origin.GetOrigin(),
+                               embedding_origin.GetOrigin()));
+  atom::AtomPermissionManager::ResetPermission(
+      permission, requesting_origin, embedding_origin);
+}
+
+blink::mojom::PermissionStatus BravePermissionManager::GetPermissionStatus(
+    content::PermissionType permission,
+    const GURL& requesting_origin,
+    const GURL& embedding_origin) {
+  blink::mojom::PermissionStatus status;
+  if (GetCachedDecision(DecisionKey(permission, requesting_origin.GetOrigin(),
+                                    embedding_origin.GetOrigin()),
+                        &status))
+    return status;
+  return atom::AtomPermissionManager::GetPermissionStatus(
+      permission, requesting_origin, embedding_origin);
+}
+
 }  // namespace brave
@@ -6,10 +6,13 @@
 #define BRAVE_BROWSER_BRAVE_PERMISSION_MANAGER_H_
 
 #include <map>
+#include <tuple>
 #include <vector>
 
 #include "atom/browser/atom_permission_manager.h"
 #include "base/callback.h"
+#include "base/time/time.h"
+#include "url/gurl.h"
 
 namespace content {
 class WebContents;
@@ -30,9 +33,26 @@ class BravePermissionManager : public atom::AtomPermissionManager {
                           content::PermissionType,
                           const ResponseCallback&)>;
 
+  struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t size = 0;
+  };
+
   // Handler to dispatch permission requests in JS.
   void SetPermissionRequestHandler(const RequestHandler& handler);
 
+  // Decisions of the request handler are reused for |ttl| for the same
+  // permission, requesting origin and embedding origin. A zero |ttl| turns
+  // the cache off, which is the default.
+  void SetDecisionCacheTTL(base::TimeDelta ttl);
+
+  // Forgets the cached decisions for |requesting_origin|, or all of them if
+  // it is empty.
+  void ClearDecisionCache(const GURL& requesting_origin);
+
+  CacheStats GetDecisionCacheStats() const;
+
   // content::PermissionManager:
   int RequestPermission(
       content::PermissionType permission,
@@ -50,20 +70,49 @@ class BravePermissionManager : public atom::AtomPermissionManager {
 
   // content::PermissionManager:
   void CancelPermissionRequest(int request_id) override;
+  void ResetPermission(content::PermissionType permission,
+                       const GURL& requesting_origin,
+                       const GURL& embedding_origin) override;
+  blink::mojom::PermissionStatus GetPermissionStatus(
+      content::PermissionType permission,
+      const GURL& requesting_origin,
+      const GURL& embedding_origin) override;
 
  private:
+  // (permission, requesting origin, embedding origin).
+  using DecisionKey = std::tuple<content::PermissionType, GURL, GURL>;
+
+  struct Decision {
+    blink::mojom::PermissionStatus status;
+    base::TimeTicks expiration;
+  };
+
   struct RequestInfo {
     int render_process_id;
     int render_frame_id;
     ResponseCallback callback;
+    DecisionKey key;
+    // Cancelled requests are answered without a decision to cache.
+    bool cancelled;
   };
 
+  // Returns true and sets |status| if there is a live decision for |key|.
+  bool GetCachedDecision(const DecisionKey& key,
+                         blink::mojom::PermissionStatus* status);
+  void CacheDecision(const DecisionKey& key,
+                     blink::mojom::PermissionStatus status);
+
   RequestHandler request_handler_;
 
   std::map<int, RequestInfo> pending_requests_;
 
   int request_id_;
 
+  base::TimeDelta decision_ttl_;
+  std::map<DecisionKey, Decision> decisions_;
+  uint64_t cache_hits_;
+  uint64_t cache_misses_;
+
   DISALLOW_COPY_AND_ASSIGN(BravePermissionManager);
 };
 
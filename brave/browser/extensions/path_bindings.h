@@ -10,6 +10,7 @@
 
 #include "base/compiler_specific.h"
 #include "base/macros.h"
+#include "brave/common/extensions/asar_source_map.h"
 #include "extensions/renderer/module_system.h"
 #include "extensions/renderer/object_backed_native_handler.h"
 #include "v8/include/v8.h"
@@ -19,15 +20,16 @@ namespace brave {
 class PathBindings : public extensions::ObjectBackedNativeHandler {
  public:
   PathBindings(extensions::ScriptContext* context,
-      extensions::SourceMap* source_map);
+      AsarSourceMap* source_map);
   ~PathBindings() override;
 
  private:
   void Append(const v8::FunctionCallbackInfo<v8::Value>& args);
   void DirName(const v8::FunctionCallbackInfo<v8::Value>& args);
   void Require(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void Compile(const v8::FunctionCallbackInfo<v8::Value>& args);
 
-  const extensions::SourceMap* source_map_;
+  const AsarSourceMap* source_map_;
 
   DISALLOW_COPY_AND_ASSIGN(PathBindings);
 };
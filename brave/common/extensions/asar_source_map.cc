@@ -4,11 +4,22 @@
 
 #include "brave/common/extensions/asar_source_map.h"
 
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "atom/common/asar/archive.h"
 #include "atom/common/asar/asar_util.h"
-#include "base/callback.h"
-#include "base/bind.h"
 #include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/json/string_escape.h"
+#include "base/lazy_instance.h"
+#include "base/pickle.h"
 #include "base/strings/string_split.h"
+#include "base/synchronization/lock.h"
 #include "gin/converter.h"
 
 namespace brave {
@@ -17,17 +28,16 @@ namespace {
 
 static const char commonjs[] = "muon/module_system/commonjs";
 
-bool IsAsarPath(const base::FilePath& path) {
-  base::FilePath archive;
-  base::FilePath relative;
-  return asar::GetAsarArchivePath(path, &archive, &relative);
-}
+// The arguments of the module system wrapper that compiled modules get
+// besides those of the commonjs wrapper.
+static const char kModuleSystemArguments[] =
+    "exports, define, requireNative, requireAsync, privates, "
+    "$Array, $Function, $JSON, $Object, $RegExp, $String, $Error, $Promise";
 
-bool ReadFromPath(
-    base::Callback<bool(const base::FilePath& path, std::string* contents)>,
-    const base::FilePath& file,
-    const base::FilePath& path,
-    std::string* source) {
+// Returns the files a module |file| may be loaded from under |path|, in the
+// order they are tried.
+std::vector<base::FilePath> GetModuleCandidates(const base::FilePath& file,
+                                                const base::FilePath& path) {
   base::FilePath file_path = path.Append(file);
   if (!file_path.MatchesExtension(FILE_PATH_LITERAL(".js")))
     file_path = file_path.AddExtension(FILE_PATH_LITERAL("js"));
@@ -42,28 +52,112 @@ bool ReadFromPath(
       .Append(file)
       .AddExtension(FILE_PATH_LITERAL("js"));
 
-  return asar::ReadFileToString(file_path, source) ||
-      asar::ReadFileToString(module_path1, source) ||
-      asar::ReadFileToString(module_path2, source);
+  return { file_path, module_path1, module_path2 };
 }
 
-bool ReadFromSearchPaths(const std::vector<base::FilePath>& search_paths,
-                        const base::FilePath& file_path,
-                        std::string* source) {
-  for (size_t i = 0; i < search_paths.size(); ++i) {
-    if (IsAsarPath(search_paths[i])) {
-      if (!ReadFromPath(base::Bind(&asar::ReadFileToString),
-          file_path, search_paths[i], source))
-        continue;
-    } else {
-      if (!ReadFromPath(base::Bind(&base::ReadFileToString),
-          file_path, search_paths[i], source))
-        continue;
+bool ModuleFileExists(const base::FilePath& path) {
+  base::FilePath asar_path, relative_path;
+  if (!asar::GetAsarArchivePath(path, &asar_path, &relative_path))
+    return base::PathExists(path) && !base::DirectoryExists(path);
+
+  std::shared_ptr<asar::Archive> archive =
+      asar::GetOrCreateAsarArchive(asar_path);
+  asar::Archive::FileInfo info;
+  return archive && archive->GetFileInfo(relative_path, &info);
+}
+
+// V8 code cache of compiled modules, shared by the isolates of all workers.
+class CodeCache {
+ public:
+  CodeCache() {}
+
+  bool Get(const base::FilePath& path, std::string* data) {
+    base::AutoLock auto_lock(lock_);
+    auto it = entries_.find(path);
+    if (it == entries_.end())
+      return false;
+    *data = it->second;
+    return true;
+  }
+
+  void Put(const base::FilePath& path, const uint8_t* data, int length) {
+    base::AutoLock auto_lock(lock_);
+    entries_[path].assign(reinterpret_cast<const char*>(data), length);
+    generation_++;
+  }
+
+  void Remove(const base::FilePath& path) {
+    base::AutoLock auto_lock(lock_);
+    entries_.erase(path);
+    generation_++;
+  }
+
+  // Changes whenever an entry is added or dropped.
+  int generation() {
+    base::AutoLock auto_lock(lock_);
+    return generation_;
+  }
+
+  // Serializes the entries for the files in |paths|.
+  void Write(const std::set<base::FilePath>& paths, base::Pickle* pickle) {
+    base::AutoLock auto_lock(lock_);
+    pickle->WriteInt(kCodeCacheFileVersion);
+    pickle->WriteUInt32(v8::ScriptCompiler::CachedDataVersionTag());
+    std::vector<const std::pair<const base::FilePath, std::string>*> written;
+    for (const auto& path : paths) {
+      auto it = entries_.find(path);
+      if (it != entries_.end())
+        written.push_back(&*it);
+    }
+    pickle->WriteInt(static_cast<int>(written.size()));
+    for (const auto* entry : written) {
+      pickle->WriteString(entry->first.AsUTF8Unsafe());
+      pickle->WriteData(entry->second.data(),
+                        static_cast<int>(entry->second.size()));
+    }
+  }
+
+  // Adds the entries written by Write() that are not cached yet. Returns
+  // false if |pickle| is not a code cache file of this V8 version.
+  bool Read(const base::Pickle& pickle, std::set<base::FilePath>* paths) {
+    base::PickleIterator iter(pickle);
+    int version;
+    uint32_t tag;
+    int count;
+    if (!iter.ReadInt(&version) || version != kCodeCacheFileVersion ||
+        !iter.ReadUInt32(&tag) ||
+        tag != v8::ScriptCompiler::CachedDataVersionTag() ||
+        !iter.ReadInt(&count))
+      return false;
+
+    base::AutoLock auto_lock(lock_);
+    for (int i = 0; i < count; ++i) {
+      std::string path;
+      const char* data;
+      int length;
+      if (!iter.ReadString(&path) || !iter.ReadData(&data, &length))
+        return false;
+      base::FilePath file_path = base::FilePath::FromUTF8Unsafe(path);
+      paths->insert(file_path);
+      // V8 rejects the data if the file changed since, CompileModule drops it
+      // then.
+      if (!entries_.count(file_path))
+        entries_[file_path].assign(data, length);
     }
     return true;
   }
-  return false;
-}
+
+ private:
+  static const int kCodeCacheFileVersion = 1;
+
+  base::Lock lock_;
+  std::map<base::FilePath, std::string> entries_;
+  int generation_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeCache);
+};
+
+base::LazyInstance<CodeCache>::Leaky g_code_cache = LAZY_INSTANCE_INITIALIZER;
 
 const base::FilePath GetFilePath(const std::string& name) {
   std::vector<std::string> components = base::SplitString(
@@ -97,7 +191,8 @@ const base::FilePath GetFilePath(const std::string& name) {
 
 AsarSourceMap::AsarSourceMap(
     const std::vector<base::FilePath>& search_paths)
-    : search_paths_(search_paths) {
+    : search_paths_(search_paths),
+      code_cache_generation_(-1) {
 }
 
 AsarSourceMap::~AsarSourceMap() {
@@ -106,19 +201,28 @@ AsarSourceMap::~AsarSourceMap() {
 v8::Local<v8::String> AsarSourceMap::GetSource(
     v8::Isolate* isolate,
     const std::string& name) const {
-  std::string source;
-  if (ReadFromSearchPaths(search_paths_, GetFilePath(name), &source)) {
+  base::FilePath path;
+  if (Resolve(name, &path)) {
     if (name != commonjs) {
-      source =
-          "const fn = function (require, module, console) { " + source + " };"
-          "require('" +
+      // The module body is compiled by CompileModule so it can use the code
+      // cache, the module system only runs this small stub.
+      std::string module_path =
+          base::GetQuotedJSONString(GetFilePath(name).AsUTF8Unsafe());
+      return gin::StringToV8(isolate,
+          std::string("require('") +
             commonjs +
-          "').require(fn, exports, '" +
-          GetFilePath(name).AsUTF8Unsafe() +
-          "', this);";
+          "').require(function (require, module, console) {"
+            "return requireNative('path').compile(" + module_path + ")"
+              ".call(this, require, module, console, " +
+                    kModuleSystemArguments + ");"
+          "}, exports, " +
+          module_path +
+          ", this);");
     }
 
-    return gin::StringToV8(isolate, source);
+    v8::Local<v8::String> source;
+    if (asar::ReadFileToV8String(isolate, path, &source))
+      return source;
   }
 
   NOTREACHED() << "No module is registered with name \"" << name << "\"";
@@ -126,8 +230,135 @@ v8::Local<v8::String> AsarSourceMap::GetSource(
 }
 
 bool AsarSourceMap::Contains(const std::string& name) const {
-  std::string source;
-  return ReadFromSearchPaths(search_paths_, GetFilePath(name), &source);
+  base::FilePath path;
+  return Resolve(name, &path);
+}
+
+v8::MaybeLocal<v8::Function> AsarSourceMap::CompileModule(
+    v8::Local<v8::Context> context,
+    const std::string& name) const {
+  v8::Isolate* isolate = context->GetIsolate();
+  base::FilePath path;
+  v8::Local<v8::String> body;
+  if (!Resolve(name, &path) ||
+      !asar::ReadFileToV8String(isolate, path, &body))
+    return v8::MaybeLocal<v8::Function>();
+
+  // The module used to be inlined in the strict mode module system wrapper,
+  // keep the same scope by passing the wrapper's arguments explicitly.
+  v8::Local<v8::String> source = v8::String::Concat(
+      v8::String::Concat(
+          gin::StringToV8(isolate,
+              std::string("(function (require, module, console, ") +
+                  kModuleSystemArguments + ") {"
+              "'use strict';"),
+          body),
+      gin::StringToV8(isolate, "\n})"));
+  v8::ScriptOrigin origin(gin::StringToV8(isolate, path.AsUTF8Unsafe()));
+  compiled_.insert(path);
+
+  std::string cached_data;
+  v8::ScriptCompiler::CompileOptions options =
+      v8::ScriptCompiler::kProduceCodeCache;
+  std::unique_ptr<v8::ScriptCompiler::Source> script_source;
+  if (g_code_cache.Get().Get(path, &cached_data)) {
+    options = v8::ScriptCompiler::kConsumeCodeCache;
+    script_source.reset(new v8::ScriptCompiler::Source(source, origin,
+        new v8::ScriptCompiler::CachedData(
+            reinterpret_cast<const uint8_t*>(cached_data.data()),
+            static_cast<int>(cached_data.size()))));
+  } else {
+    script_source.reset(new v8::ScriptCompiler::Source(source, origin));
+  }
+
+  v8::Local<v8::Script> script;
+  if (!v8::ScriptCompiler::Compile(context, script_source.get(), options)
+          .ToLocal(&script))
+    return v8::MaybeLocal<v8::Function>();
+
+  const v8::ScriptCompiler::CachedData* data =
+      script_source->GetCachedData();
+  if (options == v8::ScriptCompiler::kProduceCodeCache) {
+    if (data && data->data)
+      g_code_cache.Get().Put(path, data->data, data->length);
+  } else if (data && data->rejected) {
+    // The file changed since the cache was produced, redo it next time.
+    g_code_cache.Get().Remove(path);
+  }
+
+  v8::Local<v8::Value> result;
+  if (!script->Run(context).ToLocal(&result) || !result->IsFunction())
+    return v8::MaybeLocal<v8::Function>();
+  return result.As<v8::Function>();
+}
+
+bool AsarSourceMap::LoadCodeCache(const base::FilePath& file) {
+  code_cache_file_ = file;
+  code_cache_generation_ = -1;
+
+  std::string contents;
+  if (!base::ReadFileToString(file, &contents))
+    return false;
+
+  int generation = g_code_cache.Get().generation();
+  base::Pickle pickle(contents.data(), static_cast<int>(contents.size()));
+  std::set<base::FilePath> paths;
+  if (!g_code_cache.Get().Read(pickle, &paths))
+    return false;
+
+  // Files cached by an earlier run are written back even if this run only
+  // compiles some of them.
+  compiled_.insert(paths.begin(), paths.end());
+  code_cache_generation_ = generation;
+  return true;
+}
+
+bool AsarSourceMap::SaveCodeCache() {
+  if (code_cache_file_.empty())
+    return false;
+
+  // Nothing was compiled or dropped since the file was read.
+  int generation = g_code_cache.Get().generation();
+  if (generation == code_cache_generation_)
+    return true;
+
+  base::Pickle pickle;
+  g_code_cache.Get().Write(compiled_, &pickle);
+  if (!base::CreateDirectory(code_cache_file_.DirName()) ||
+      !base::ImportantFileWriter::WriteFileAtomically(code_cache_file_,
+          base::StringPiece(static_cast<const char*>(pickle.data()),
+                            pickle.size())))
+    return false;
+
+  code_cache_generation_ = generation;
+  return true;
+}
+
+bool AsarSourceMap::Resolve(const std::string& name,
+                            base::FilePath* path) const {
+  auto it = resolved_.find(name);
+  if (it == resolved_.end()) {
+    base::FilePath resolved;
+    base::FilePath file_path = GetFilePath(name);
+    for (const base::FilePath& search_path : search_paths_) {
+      for (const base::FilePath& candidate :
+           GetModuleCandidates(file_path, search_path)) {
+        if (ModuleFileExists(candidate)) {
+          resolved = candidate;
+          break;
+        }
+      }
+      if (!resolved.empty())
+        break;
+    }
+    // Misses are cached too, the module system probes a lot of names.
+    it = resolved_.insert(std::make_pair(name, resolved)).first;
+  }
+
+  if (it->second.empty())
+    return false;
+  *path = it->second;
+  return true;
 }
 
 }  // namespace brave
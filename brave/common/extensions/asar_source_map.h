@@ -5,6 +5,8 @@
 #ifndef BRAVE_COMMON_EXTENSIONS_ASAR_SOURCE_MAP_H_
 #define BRAVE_COMMON_EXTENSIONS_ASAR_SOURCE_MAP_H_
 
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -24,8 +26,31 @@ class AsarSourceMap : public extensions::SourceMap {
                                  const std::string& name) const override;
   bool Contains(const std::string& name) const override;
 
+  // Compiles the commonjs module |name| into a function, reusing the code
+  // cache produced when any isolate compiled the same file before.
+  v8::MaybeLocal<v8::Function> CompileModule(v8::Local<v8::Context> context,
+                                             const std::string& name) const;
+
+  // Adds the code cache saved in |file| to the shared cache and saves to
+  // |file| from then on. Returns false if |file| is missing or was written
+  // by another V8 version. Does blocking IO.
+  bool LoadCodeCache(const base::FilePath& file);
+
+  // Writes the code cache of every module compiled through this source map,
+  // or loaded from the code cache file, to the code cache file. Does blocking
+  // IO.
+  bool SaveCodeCache();
+
  private:
+  // Finds the file |name| is loaded from. Both hits and misses are cached so
+  // Contains() and GetSource() probe the search paths only once per name.
+  bool Resolve(const std::string& name, base::FilePath* path) const;
+
   std::vector<base::FilePath> search_paths_;
+  mutable std::map<std::string, base::FilePath> resolved_;
+  mutable std::set<base::FilePath> compiled_;
+  base::FilePath code_cache_file_;
+  int code_cache_generation_;
 
   DISALLOW_COPY_AND_ASSIGN(AsarSourceMap);
 };
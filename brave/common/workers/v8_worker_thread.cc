@@ -10,6 +10,8 @@
 #include "base/run_loop.h"
 #include "base/threading/thread_local.h"
 #include "brave/common/workers/worker_bindings.h"
+#include "brave/common/workers/worker_channel.h"
+#include "brave/common/workers/worker_pool.h"
 #include "content/child/worker_thread_registry.h"
 #include "content/public/browser/browser_thread.h"
 
@@ -43,10 +45,12 @@ void Kill(V8WorkerThread* worker) {
 
 V8WorkerThread::V8WorkerThread(const std::string& name,
                               const std::string& module_name,
-                              atom::api::App* app) :
+                              atom::api::App* app,
+                              WorkerPool* pool) :
     base::Thread(name),
     module_name_(module_name),
-    app_(app) {
+    app_(app),
+    pool_(pool) {
 }
 
 V8WorkerThread::~V8WorkerThread() {
@@ -93,17 +97,26 @@ void V8WorkerThread::Run(base::RunLoop* run_loop) {
   base::ThreadRestrictions::SetIOAllowed(true);
   content::WorkerThreadRegistry::Instance()->DidStartCurrentWorkerThread();
   env()->OnMessageLoopCreated();
-  LoadModule();
+  if (!code_cache_path_.empty())
+    env()->mutable_source_map()->LoadCodeCache(code_cache_path_);
+  bool loaded = LoadModule();
+  if (loaded && !code_cache_path_.empty())
+    env()->mutable_source_map()->SaveCodeCache();
   BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
       base::Bind(&NotifyStart,
                   base::Unretained(app()),
                   GetThreadId()));
+  if (loaded && pool_)
+    pool_->OnWorkerStarted(this);
   Thread::Run(run_loop);
 }
 
 // Called just after the message loop ends
 void V8WorkerThread::CleanUp() {
   content::WorkerThreadRegistry::Instance()->WillStopCurrentWorkerThread();
+  if (pool_)
+    pool_->OnWorkerStopped(this);
+  WorkerChannelRegistry::GetInstance()->OnWorkerStopped(GetThreadId());
   memory_pressure_listener_.reset();
   env()->OnMessageLoopDestroying();
   js_env_.reset();
@@ -115,7 +128,7 @@ void V8WorkerThread::OnMemoryPressure(
   env()->isolate()->LowMemoryNotification();
 }
 
-void V8WorkerThread::LoadModule() {
+bool V8WorkerThread::LoadModule() {
   if (!env()->source_map().Contains(module_name_)) {
     BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
         base::Bind(&NotifyError,
@@ -123,11 +136,12 @@ void V8WorkerThread::LoadModule() {
                     GetThreadId(),
                     "No source for require(" + module_name_ + ")"));
     base::MessageLoop::current()->QuitNow();
-    return;
+    return false;
   }
 
   ModuleSystem::NativesEnabledScope natives_enabled(env()->module_system());
   env()->module_system()->Require(module_name_);
+  return true;
 }
 
 }  // namespace brave
@@ -8,7 +8,9 @@
 #include <memory>
 #include <string>
 
+#include "base/files/file_path.h"
 #include "base/memory/memory_pressure_listener.h"
+#include "base/memory/ref_counted.h"
 #include "base/threading/thread.h"
 
 namespace atom {
@@ -20,10 +22,13 @@ class App;
 
 namespace brave {
 
+class WorkerPool;
+
 class V8WorkerThread : public base::Thread {
  public:
   explicit V8WorkerThread(const std::string& name,
-      const std::string& module_name, atom::api::App* app);
+      const std::string& module_name, atom::api::App* app,
+      WorkerPool* pool = nullptr);
   ~V8WorkerThread() override;
 
   static V8WorkerThread* current();
@@ -36,14 +41,24 @@ class V8WorkerThread : public base::Thread {
   atom::api::App* app() const { return app_; }
   atom::JavascriptEnvironment* env() const { return js_env_.get(); }
   const std::string& module_name() const { return module_name_; }
+  WorkerPool* pool() const { return pool_.get(); }
+
+  // Loads the code cache of the module from |path| before running it and
+  // saves it there afterwards, see AsarSourceMap::LoadCodeCache. Must be
+  // called before Start().
+  void set_code_cache_path(const base::FilePath& path) {
+    code_cache_path_ = path;
+  }
 
  private:
-  void LoadModule();
+  bool LoadModule();
   void OnMemoryPressure(
     base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
 
   const std::string module_name_;
   atom::api::App* app_;
+  scoped_refptr<WorkerPool> pool_;
+  base::FilePath code_cache_path_;
   std::unique_ptr<atom::JavascriptEnvironment> js_env_;
   std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
 };
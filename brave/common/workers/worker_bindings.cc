@@ -4,11 +4,14 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "brave/common/workers/worker_bindings.h"
 
 #include "atom/browser/api/atom_api_app.h"
 #include "brave/common/workers/v8_worker_thread.h"
+#include "brave/common/workers/worker_channel.h"
+#include "brave/common/workers/worker_message.h"
 #include "content/child/worker_thread_registry.h"
 #include "content/public/browser/browser_thread.h"
 #include "extensions/renderer/script_context.h"
@@ -31,30 +34,70 @@ bool SetReadOnlyProperty(v8::Local<v8::Context> context,
       static_cast<v8::PropertyAttribute>(v8::ReadOnly)));
 }
 
-void OnMessageInternal(const std::pair<uint8_t*, size_t>& buf) {
-  v8::Isolate* isolate = v8::Isolate::GetCurrent();
-  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+v8::Local<v8::String> ToV8String(v8::Isolate* isolate, const char* str) {
+  return v8::String::NewFromUtf8(isolate, str,
+      v8::NewStringType::kNormal).ToLocalChecked();
+}
+
+// Ports are kept in a private object on the global keyed by channel id.
+v8::Local<v8::Object> GetPorts(v8::Local<v8::Context> context) {
+  v8::Isolate* isolate = context->GetIsolate();
+  v8::Local<v8::Private> key =
+      v8::Private::ForApi(isolate, ToV8String(isolate, "workerPorts"));
+  v8::Local<v8::Object> global = context->Global();
+  v8::Local<v8::Value> ports;
+  if (global->GetPrivate(context, key).ToLocal(&ports) && ports->IsObject())
+    return ports.As<v8::Object>();
+
+  v8::Local<v8::Object> new_ports = v8::Object::New(isolate);
+  global->SetPrivate(context, key, new_ports);
+  return new_ports;
+}
+
+void CallHandler(v8::Local<v8::Context> context,
+                 v8::Local<v8::Object> object,
+                 const char* name,
+                 v8::Local<v8::Value> event) {
+  v8::Local<v8::Value> handler;
+  if (!object->Get(context, ToV8String(context->GetIsolate(), name))
+          .ToLocal(&handler) || !handler->IsFunction())
+    return;
 
-  v8::ValueDeserializer deserializer(
-      isolate, buf.first, buf.second);
-  deserializer.SetSupportsLegacyWireFormat(true);
-  if (deserializer.ReadHeader(context).FromMaybe(false)) {
-    v8::Local<v8::Value> message =
-        deserializer.ReadValue(context).ToLocalChecked();
-    v8::Local<v8::Object> global = context->Global();
-    v8::Local<v8::Value> onmessage =
-        global->Get(context, v8::String::NewFromUtf8(isolate, "onmessage",
-                                                v8::NewStringType::kNormal)
-                                 .ToLocalChecked()).ToLocalChecked();
-    if (onmessage->IsFunction()) {
-      v8::Local<v8::Function> onmessage_fun =
-          v8::Local<v8::Function>::Cast(onmessage);
-
-      v8::Local<v8::Value> argv[] = {message};
-      (void)onmessage_fun->Call(context, global, 1, argv);
-    }
+  v8::Local<v8::Value> argv[] = {event};
+  (void)handler.As<v8::Function>()->Call(context, object, 1, argv);
+}
+
+void PortPostMessage(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  if (args.Length() < 1) {
+    isolate->ThrowException(
+        ToV8String(isolate, "`message` is a required field"));
+    return;
   }
-  free(buf.first);
+
+  auto message = WorkerMessage::Create(isolate, args[0], args[1]);
+  if (!message)
+    return;
+
+  int channel_id = args.Data().As<v8::Integer>()->Value();
+  args.GetReturnValue().Set(
+      WorkerChannelRegistry::GetInstance()->PostMessage(
+          channel_id,
+          WorkerChannelRegistry::Endpoint::ForWorker(
+              base::PlatformThread::CurrentId()),
+          std::move(message)));
+}
+
+void PortClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  int channel_id = args.Data().As<v8::Integer>()->Value();
+  WorkerChannelRegistry::GetInstance()->Close(
+      channel_id,
+      WorkerChannelRegistry::Endpoint::ForWorker(
+          base::PlatformThread::CurrentId()));
+}
+
+void OnMessageInternal(std::unique_ptr<WorkerMessage> message) {
+  WorkerBindings::DispatchMessage(v8::Isolate::GetCurrent(), message.get());
 }
 
 }  // namespace
@@ -79,6 +122,12 @@ WorkerBindings::WorkerBindings(extensions::ScriptContext* context,
           v8::NewStringType::kNormal).ToLocalChecked(),
       v8::Null(isolate));
 
+  // onconnect handler for app.createMessageChannel ports
+  SetProperty(v8_context, v8_context->Global(),
+      v8::String::NewFromUtf8(isolate, "onconnect",
+          v8::NewStringType::kNormal).ToLocalChecked(),
+      v8::Null(isolate));
+
   // pathname
   v8::Local<v8::Object> location = v8::Object::New(isolate);
   SetReadOnlyProperty(v8_context, location,
@@ -166,20 +215,14 @@ void WorkerBindings::Close(
 }
 
 void WorkerBindings::PostMessageOnUIThread(
-    const std::pair<uint8_t*, size_t>& buf) {
-  v8::ValueDeserializer deserializer(
-      worker_->app()->isolate(), buf.first, buf.second);
-  deserializer.SetSupportsLegacyWireFormat(true);
-  if (deserializer.ReadHeader(
-      worker_->app()->isolate()->GetCurrentContext()).FromMaybe(false)) {
-    v8::Local<v8::Value> val = deserializer.ReadValue(
-        worker_->app()->isolate()->GetCurrentContext()).ToLocalChecked();
+    std::unique_ptr<WorkerMessage> message) {
+  v8::Local<v8::Value> val;
+  if (message->Read(worker_->app()->isolate()).ToLocal(&val)) {
     worker_->app()->Emit("worker-post-message", worker_->GetThreadId(), val);
   } else {
     worker_->app()->Emit("worker-onerror", worker_->GetThreadId(),
         "`postMessage` could not deserialize message buffer");
   }
-  free(buf.first);
 }
 
 void WorkerBindings::PostMessage(
@@ -190,46 +233,119 @@ void WorkerBindings::PostMessage(
     return;
   }
 
-  if (args.Length() > 1) {
-    context()->isolate()->ThrowException(v8::String::NewFromUtf8(
-        context()->isolate(), "`transferList` is not supported yet"));
+  auto message = WorkerMessage::Create(context()->isolate(), args[0], args[1]);
+  if (!message)
     return;
-  }
 
-  v8::ValueSerializer serializer(context()->isolate());
-  serializer.WriteHeader();
-  if (serializer.WriteValue(
-      context()->v8_context(), args[0]).FromMaybe(false)) {
-    std::pair<uint8_t*, size_t> buffer = serializer.Release();
+  BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
+      base::Bind(&WorkerBindings::PostMessageOnUIThread,
+                  base::Unretained(this),
+                  base::Passed(&message)));
+}
 
-    BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
-        base::Bind(&WorkerBindings::PostMessageOnUIThread,
-                    base::Unretained(this),
-                    std::move(buffer)));
-  } else {
-    context()->isolate()->ThrowException(v8::String::NewFromUtf8(
-        context()->isolate(), "`postMessage` could not serialize message"));
+// static
+bool WorkerBindings::DispatchMessage(v8::Isolate* isolate,
+                                     WorkerMessage* message) {
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  v8::Local<v8::Value> data;
+  if (!message->Read(isolate).ToLocal(&data))
+    return false;
+
+  v8::Local<v8::Object> global = context->Global();
+  v8::Local<v8::Value> onmessage =
+      global->Get(context, v8::String::NewFromUtf8(isolate, "onmessage",
+                                              v8::NewStringType::kNormal)
+                               .ToLocalChecked()).ToLocalChecked();
+  if (onmessage->IsFunction()) {
+    v8::Local<v8::Function> onmessage_fun =
+        v8::Local<v8::Function>::Cast(onmessage);
+
+    v8::Local<v8::Value> argv[] = {data};
+    (void)onmessage_fun->Call(context, global, 1, argv);
   }
+  return true;
+}
+
+// static
+void WorkerBindings::OnPortConnect(int channel_id) {
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Integer> id = v8::Integer::New(isolate, channel_id);
+
+  v8::Local<v8::Object> port = v8::Object::New(isolate);
+  SetReadOnlyProperty(context, port, ToV8String(isolate, "id"), id);
+  SetProperty(context, port, ToV8String(isolate, "onmessage"),
+      v8::Null(isolate));
+  SetProperty(context, port, ToV8String(isolate, "onclose"),
+      v8::Null(isolate));
+  SetProperty(context, port, ToV8String(isolate, "postMessage"),
+      v8::Function::New(context, &PortPostMessage, id).ToLocalChecked());
+  SetProperty(context, port, ToV8String(isolate, "close"),
+      v8::Function::New(context, &PortClose, id).ToLocalChecked());
+  GetPorts(context)->Set(context, id, port);
+
+  v8::Local<v8::Array> ports = v8::Array::New(isolate, 1);
+  ports->Set(context, 0, port);
+  v8::Local<v8::Object> event = v8::Object::New(isolate);
+  SetProperty(context, event, ToV8String(isolate, "ports"), ports);
+  CallHandler(context, context->Global(), "onconnect", event);
+}
+
+// static
+void WorkerBindings::OnPortMessage(
+    int channel_id,
+    std::unique_ptr<WorkerMessage> message) {
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  v8::Local<v8::Value> port;
+  if (!GetPorts(context)->Get(context, channel_id).ToLocal(&port) ||
+      !port->IsObject())
+    return;
+
+  v8::Local<v8::Value> data;
+  if (!message->Read(isolate).ToLocal(&data))
+    return;
+
+  v8::Local<v8::Object> event = v8::Object::New(isolate);
+  SetProperty(context, event, ToV8String(isolate, "data"), data);
+  CallHandler(context, port.As<v8::Object>(), "onmessage", event);
+}
+
+// static
+void WorkerBindings::OnPortClose(int channel_id) {
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  v8::Local<v8::Object> ports = GetPorts(context);
+  v8::Local<v8::Value> port;
+  if (!ports->Get(context, channel_id).ToLocal(&port) || !port->IsObject())
+    return;
+
+  ports->Delete(context, channel_id);
+  CallHandler(context, port.As<v8::Object>(), "onclose",
+              v8::Object::New(isolate));
 }
 
 // static
 bool WorkerBindings::OnMessage(v8::Isolate* isolate,
                                 base::PlatformThreadId thread_id,
-                                v8::Local<v8::Value> message) {
-  v8::ValueSerializer serializer(isolate);
-  serializer.WriteHeader();
-  if (serializer.WriteValue(
-      isolate->GetCurrentContext(), message).FromMaybe(false)) {
-    std::pair<uint8_t*, size_t> buffer = serializer.Release();
-
-    base::TaskRunner* task_runner =
-        content::WorkerThreadRegistry::Instance()->GetTaskRunnerFor(thread_id);
-    task_runner->PostTask(FROM_HERE,
-        base::Bind(&OnMessageInternal,
-        std::move(buffer)));
-    return true;
-  }
-  return false;
+                                v8::Local<v8::Value> message,
+                                v8::Local<v8::Value> transfer_list) {
+  auto worker_message = WorkerMessage::Create(isolate, message, transfer_list);
+  if (!worker_message)
+    return false;
+
+  base::TaskRunner* task_runner =
+      content::WorkerThreadRegistry::Instance()->GetTaskRunnerFor(thread_id);
+  task_runner->PostTask(FROM_HERE,
+      base::Bind(&OnMessageInternal,
+      base::Passed(&worker_message)));
+  return true;
 }
 
 }  // namespace brave
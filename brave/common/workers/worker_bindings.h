@@ -5,8 +5,8 @@
 #ifndef BRAVE_COMMON_WORKERS_WORKER_BINDINGS_H_
 #define BRAVE_COMMON_WORKERS_WORKER_BINDINGS_H_
 
+#include <memory>
 #include <string>
-#include <utility>
 
 #include "base/compiler_specific.h"
 #include "base/macros.h"
@@ -16,18 +16,35 @@
 namespace brave {
 
 class V8WorkerThread;
+class WorkerMessage;
 
 class WorkerBindings : public extensions::ObjectBackedNativeHandler {
  public:
   WorkerBindings(extensions::ScriptContext* context, V8WorkerThread* worker);
   ~WorkerBindings() override;
+  // Posts |message| to the `onmessage` handler of worker |thread_id|. The
+  // ArrayBuffers in |transfer_list| are moved to the worker. Returns false
+  // with an exception pending in |isolate| if |message| can't be cloned.
   static bool OnMessage(v8::Isolate* isolate,
                         base::PlatformThreadId thread_id,
-                        v8::Local<v8::Value> message);
+                        v8::Local<v8::Value> message,
+                        v8::Local<v8::Value> transfer_list);
+
+  // Reads |message| and passes it to the `onmessage` handler of the current
+  // context. Returns false if the message could not be deserialized.
+  static bool DispatchMessage(v8::Isolate* isolate, WorkerMessage* message);
+
+  // Called on the worker thread for the ends of WorkerChannelRegistry
+  // channels that belong to it. A new channel is passed to the `onconnect`
+  // handler as `event.ports[0]`.
+  static void OnPortConnect(int channel_id);
+  static void OnPortMessage(int channel_id,
+                            std::unique_ptr<WorkerMessage> message);
+  static void OnPortClose(int channel_id);
 
  private:
   void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
-  void PostMessageOnUIThread(const std::pair<uint8_t*, size_t>& buffer);
+  void PostMessageOnUIThread(std::unique_ptr<WorkerMessage> message);
   void PostMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
   void OnErrorOnUIThread(const std::string& message, const std::string& stack);
   void OnError(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -0,0 +1,307 @@
+// Copyright 2017 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "brave/common/workers/worker_channel.h"
+
+#include <string.h>
+
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "atom/common/api/api_messages.h"
+#include "base/bind.h"
+#include "base/memory/shared_memory.h"
+#include "brave/common/workers/worker_bindings.h"
+#include "brave/common/workers/worker_message.h"
+#include "content/child/worker_thread_registry.h"
+
+namespace brave {
+
+namespace {
+
+// Messages at least this large are sent to renderers in shared memory.
+const size_t kSharedMemoryThreshold = 64 * 1024;
+
+base::LazyInstance<WorkerChannelRegistry>::Leaky g_worker_channel_registry =
+    LAZY_INSTANCE_INITIALIZER;
+
+void PostToWorker(base::PlatformThreadId worker_id, const base::Closure& task) {
+  content::WorkerThreadRegistry::Instance()->
+      GetTaskRunnerFor(worker_id)->PostTask(FROM_HERE, task);
+}
+
+}  // namespace
+
+// static
+WorkerChannelRegistry::Endpoint WorkerChannelRegistry::Endpoint::ForWorker(
+    base::PlatformThreadId worker_id) {
+  return { worker_id, -1, -1 };
+}
+
+// static
+WorkerChannelRegistry::Endpoint WorkerChannelRegistry::Endpoint::ForRenderer(
+    int render_process_id, int routing_id) {
+  return { base::kInvalidThreadId, render_process_id, routing_id };
+}
+
+bool WorkerChannelRegistry::Endpoint::operator==(const Endpoint& other) const {
+  return worker_id == other.worker_id &&
+      render_process_id == other.render_process_id &&
+      routing_id == other.routing_id;
+}
+
+// static
+WorkerChannelRegistry* WorkerChannelRegistry::GetInstance() {
+  return g_worker_channel_registry.Pointer();
+}
+
+WorkerChannelRegistry::WorkerChannelRegistry() : next_channel_id_(1) {
+}
+
+WorkerChannelRegistry::~WorkerChannelRegistry() {
+}
+
+int WorkerChannelRegistry::Connect(const Endpoint& a, const Endpoint& b) {
+  if (a == b)
+    return -1;
+
+  int channel_id;
+  {
+    base::AutoLock auto_lock(lock_);
+    for (const Endpoint& end : { a, b }) {
+      if (!end.is_worker() && !filters_.count(end.render_process_id))
+        return -1;
+    }
+    channel_id = next_channel_id_++;
+    channels_[channel_id] = { { a, b } };
+  }
+
+  NotifyConnect(channel_id, a);
+  NotifyConnect(channel_id, b);
+  return channel_id;
+}
+
+void WorkerChannelRegistry::Close(int channel_id) {
+  Close(channel_id, nullptr);
+}
+
+void WorkerChannelRegistry::Close(int channel_id, const Endpoint& closer) {
+  Close(channel_id, &closer);
+}
+
+void WorkerChannelRegistry::Close(int channel_id, const Endpoint* closer) {
+  Channel channel;
+  {
+    base::AutoLock auto_lock(lock_);
+    auto it = channels_.find(channel_id);
+    if (it == channels_.end())
+      return;
+    if (closer && !(it->second.ends[0] == *closer) &&
+        !(it->second.ends[1] == *closer))
+      return;
+    channel = it->second;
+    channels_.erase(it);
+  }
+
+  NotifyClose(channel_id, channel.ends[0]);
+  NotifyClose(channel_id, channel.ends[1]);
+}
+
+bool WorkerChannelRegistry::PostMessage(
+    int channel_id,
+    const Endpoint& sender,
+    std::unique_ptr<WorkerMessage> message) {
+  Endpoint receiver;
+  scoped_refptr<WorkerChannelMessageFilter> filter;
+  {
+    base::AutoLock auto_lock(lock_);
+    auto it = channels_.find(channel_id);
+    if (it == channels_.end())
+      return false;
+
+    const Channel& channel = it->second;
+    if (channel.ends[0] == sender)
+      receiver = channel.ends[1];
+    else if (channel.ends[1] == sender)
+      receiver = channel.ends[0];
+    else
+      return false;
+
+    if (!receiver.is_worker()) {
+      if (message->has_buffers())
+        return false;
+      auto filter_it = filters_.find(receiver.render_process_id);
+      if (filter_it == filters_.end())
+        return false;
+      filter = filter_it->second;
+    }
+  }
+
+  if (receiver.is_worker()) {
+    PostToWorker(receiver.worker_id,
+        base::Bind(&WorkerBindings::OnPortMessage,
+                   channel_id, base::Passed(&message)));
+  } else {
+    filter->SendPortMessage(receiver.routing_id, channel_id,
+                            std::move(message));
+  }
+  return true;
+}
+
+void WorkerChannelRegistry::OnWorkerStopped(base::PlatformThreadId worker_id) {
+  std::map<int, Channel> closed;
+  {
+    base::AutoLock auto_lock(lock_);
+    closed = TakeChannels([worker_id](const Endpoint& end) {
+      return end.worker_id == worker_id;
+    });
+  }
+
+  for (const auto& channel : closed) {
+    NotifyClose(channel.first, channel.second.ends[0]);
+    NotifyClose(channel.first, channel.second.ends[1]);
+  }
+}
+
+void WorkerChannelRegistry::AddFilter(int render_process_id,
+                                      WorkerChannelMessageFilter* filter) {
+  base::AutoLock auto_lock(lock_);
+  filters_[render_process_id] = filter;
+}
+
+void WorkerChannelRegistry::RemoveFilter(int render_process_id,
+                                         WorkerChannelMessageFilter* filter) {
+  std::map<int, Channel> closed;
+  {
+    base::AutoLock auto_lock(lock_);
+    auto it = filters_.find(render_process_id);
+    // The render process host may already use a new filter for a relaunched
+    // renderer.
+    if (it == filters_.end() || it->second.get() != filter)
+      return;
+    filters_.erase(it);
+    closed = TakeChannels([render_process_id](const Endpoint& end) {
+      return !end.is_worker() && end.render_process_id == render_process_id;
+    });
+  }
+
+  for (const auto& channel : closed) {
+    NotifyClose(channel.first, channel.second.ends[0]);
+    NotifyClose(channel.first, channel.second.ends[1]);
+  }
+}
+
+template <typename Predicate>
+std::map<int, WorkerChannelRegistry::Channel>
+WorkerChannelRegistry::TakeChannels(Predicate matches) {
+  std::map<int, Channel> taken;
+  for (auto it = channels_.begin(); it != channels_.end();) {
+    if (matches(it->second.ends[0]) || matches(it->second.ends[1])) {
+      taken.insert(*it);
+      it = channels_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return taken;
+}
+
+void WorkerChannelRegistry::NotifyConnect(int channel_id, const Endpoint& end) {
+  if (end.is_worker()) {
+    PostToWorker(end.worker_id,
+        base::Bind(&WorkerBindings::OnPortConnect, channel_id));
+    return;
+  }
+
+  scoped_refptr<WorkerChannelMessageFilter> filter =
+      GetFilter(end.render_process_id);
+  if (filter)
+    filter->Send(new AtomViewMsg_WorkerPortConnect(end.routing_id, channel_id));
+}
+
+void WorkerChannelRegistry::NotifyClose(int channel_id, const Endpoint& end) {
+  if (end.is_worker()) {
+    PostToWorker(end.worker_id,
+        base::Bind(&WorkerBindings::OnPortClose, channel_id));
+    return;
+  }
+
+  scoped_refptr<WorkerChannelMessageFilter> filter =
+      GetFilter(end.render_process_id);
+  if (filter)
+    filter->Send(new AtomViewMsg_WorkerPortClose(end.routing_id, channel_id));
+}
+
+scoped_refptr<WorkerChannelMessageFilter> WorkerChannelRegistry::GetFilter(
+    int render_process_id) {
+  base::AutoLock auto_lock(lock_);
+  auto it = filters_.find(render_process_id);
+  if (it == filters_.end())
+    return nullptr;
+  return it->second;
+}
+
+WorkerChannelMessageFilter::WorkerChannelMessageFilter(int render_process_id)
+    : BrowserMessageFilter(ShellMsgStart),
+      render_process_id_(render_process_id) {
+  WorkerChannelRegistry::GetInstance()->AddFilter(render_process_id_, this);
+}
+
+WorkerChannelMessageFilter::~WorkerChannelMessageFilter() {
+}
+
+void WorkerChannelMessageFilter::SendPortMessage(
+    int routing_id,
+    int channel_id,
+    std::unique_ptr<WorkerMessage> message) {
+  const std::vector<uint8_t>& data = message->data();
+  if (data.size() < kSharedMemoryThreshold) {
+    Send(new AtomViewMsg_WorkerPortMessage(routing_id, channel_id, data));
+    return;
+  }
+
+  base::SharedMemory shared_memory;
+  base::SharedMemoryHandle handle;
+  if (!shared_memory.CreateAndMapAnonymous(data.size()))
+    return;
+  memcpy(shared_memory.memory(), data.data(), data.size());
+  if (!shared_memory.ShareToProcess(PeerHandle(), &handle))
+    return;
+
+  Send(new AtomViewMsg_WorkerPortMessage_Shared(
+      routing_id, channel_id, handle, static_cast<uint32_t>(data.size())));
+}
+
+bool WorkerChannelMessageFilter::OnMessageReceived(
+    const IPC::Message& message) {
+  WorkerChannelRegistry* registry = WorkerChannelRegistry::GetInstance();
+  WorkerChannelRegistry::Endpoint sender =
+      WorkerChannelRegistry::Endpoint::ForRenderer(
+          render_process_id_, message.routing_id());
+
+  if (message.type() == AtomViewHostMsg_WorkerPortMessage::ID) {
+    AtomViewHostMsg_WorkerPortMessage::Param params;
+    if (AtomViewHostMsg_WorkerPortMessage::Read(&message, &params)) {
+      registry->PostMessage(std::get<0>(params), sender,
+          WorkerMessage::FromData(std::move(std::get<1>(params))));
+    }
+    return true;
+  }
+
+  if (message.type() == AtomViewHostMsg_WorkerPortClose::ID) {
+    AtomViewHostMsg_WorkerPortClose::Param params;
+    if (AtomViewHostMsg_WorkerPortClose::Read(&message, &params))
+      registry->Close(std::get<0>(params), sender);
+    return true;
+  }
+
+  return false;
+}
+
+void WorkerChannelMessageFilter::OnChannelClosing() {
+  WorkerChannelRegistry::GetInstance()->RemoveFilter(render_process_id_, this);
+}
+
+}  // namespace brave
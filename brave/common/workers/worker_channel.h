@@ -0,0 +1,119 @@
+// Copyright 2017 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BRAVE_COMMON_WORKERS_WORKER_CHANNEL_H_
+#define BRAVE_COMMON_WORKERS_WORKER_CHANNEL_H_
+
+#include <map>
+#include <memory>
+
+#include "base/lazy_instance.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/platform_thread.h"
+#include "content/public/browser/browser_message_filter.h"
+
+namespace brave {
+
+class WorkerChannelMessageFilter;
+class WorkerMessage;
+
+// Connects two V8 workers, or a V8 worker and a renderer, so that messages
+// between them go straight to the receiving worker thread or to the render
+// process IPC channel on the IO thread instead of through the UI thread.
+// Channels are created on the UI thread, messages can be posted from any
+// thread.
+class WorkerChannelRegistry {
+ public:
+  struct Endpoint {
+    static Endpoint ForWorker(base::PlatformThreadId worker_id);
+    static Endpoint ForRenderer(int render_process_id, int routing_id);
+
+    bool is_worker() const { return worker_id != base::kInvalidThreadId; }
+    bool operator==(const Endpoint& other) const;
+
+    base::PlatformThreadId worker_id;
+    int render_process_id;
+    int routing_id;
+  };
+
+  static WorkerChannelRegistry* GetInstance();
+
+  // Creates a channel between |a| and |b| and tells both ends about it.
+  // Returns the channel id, or -1 if an end can't be reached.
+  int Connect(const Endpoint& a, const Endpoint& b);
+
+  // Closes |channel_id| and tells both ends about it. The second form is
+  // used by the ends of the channel and ignores channels |closer| is not an
+  // end of.
+  void Close(int channel_id);
+  void Close(int channel_id, const Endpoint& closer);
+
+  // Posts |message| to the end of |channel_id| that is not |sender|.
+  // Returns false if |sender| is not an end of the channel, or if the other
+  // end is a renderer and |message| has transferred or shared buffers.
+  bool PostMessage(int channel_id,
+                   const Endpoint& sender,
+                   std::unique_ptr<WorkerMessage> message);
+
+  // Closes the channels of a worker or render process that went away.
+  void OnWorkerStopped(base::PlatformThreadId worker_id);
+  void AddFilter(int render_process_id, WorkerChannelMessageFilter* filter);
+  void RemoveFilter(int render_process_id, WorkerChannelMessageFilter* filter);
+
+ private:
+  friend struct base::DefaultLazyInstanceTraits<WorkerChannelRegistry>;
+
+  struct Channel {
+    Endpoint ends[2];
+  };
+
+  WorkerChannelRegistry();
+  ~WorkerChannelRegistry();
+
+  void Close(int channel_id, const Endpoint* closer);
+
+  // Takes all channels with an end matching |matches|. |lock_| must be held.
+  template <typename Predicate>
+  std::map<int, Channel> TakeChannels(Predicate matches);
+
+  void NotifyConnect(int channel_id, const Endpoint& end);
+  void NotifyClose(int channel_id, const Endpoint& end);
+  scoped_refptr<WorkerChannelMessageFilter> GetFilter(int render_process_id);
+
+  base::Lock lock_;
+  std::map<int, Channel> channels_;
+  std::map<int, scoped_refptr<WorkerChannelMessageFilter>> filters_;
+  int next_channel_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkerChannelRegistry);
+};
+
+// Carries worker channel messages to and from a render process on the IO
+// thread.
+class WorkerChannelMessageFilter : public content::BrowserMessageFilter {
+ public:
+  explicit WorkerChannelMessageFilter(int render_process_id);
+
+  // Sends |message| to the renderer, large messages are copied to shared
+  // memory. Called on any thread.
+  void SendPortMessage(int routing_id,
+                       int channel_id,
+                       std::unique_ptr<WorkerMessage> message);
+
+  // content::BrowserMessageFilter:
+  bool OnMessageReceived(const IPC::Message& message) override;
+  void OnChannelClosing() override;
+
+ private:
+  ~WorkerChannelMessageFilter() override;
+
+  int render_process_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkerChannelMessageFilter);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMMON_WORKERS_WORKER_CHANNEL_H_
@@ -0,0 +1,249 @@
+// Copyright 2017 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "brave/common/workers/worker_message.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <utility>
+
+#include "atom/common/api/serialized_value.h"
+#include "gin/array_buffer.h"
+
+// All isolates of the browser process are created by JavascriptEnvironment
+// with gin's shared ArrayBuffer allocator, so the memory of an ArrayBuffer
+// can be handed from one to another and freed by either.
+
+namespace brave {
+
+namespace {
+
+v8::Local<v8::String> ToV8String(v8::Isolate* isolate, const char* str) {
+  return v8::String::NewFromUtf8(isolate, str,
+      v8::NewStringType::kNormal).ToLocalChecked();
+}
+
+void ThrowCloneError(v8::Isolate* isolate, v8::Local<v8::String> message) {
+  isolate->ThrowException(v8::Exception::Error(message));
+}
+
+// Shared buffers point back at their SharedBufferContents with this.
+v8::Local<v8::Private> GetContentsKey(v8::Isolate* isolate) {
+  return v8::Private::ForApi(isolate,
+                             ToV8String(isolate, "sharedBufferContents"));
+}
+
+struct BufferReference {
+  v8::Global<v8::SharedArrayBuffer> handle;
+  scoped_refptr<SharedBufferContents> contents;
+};
+
+void OnBufferCollected(const v8::WeakCallbackInfo<BufferReference>& info) {
+  BufferReference* reference = info.GetParameter();
+  reference->handle.Reset();
+  delete reference;
+}
+
+}  // namespace
+
+// static
+scoped_refptr<SharedBufferContents> SharedBufferContents::From(
+    v8::Isolate* isolate,
+    v8::Local<v8::SharedArrayBuffer> buffer) {
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Value> contents;
+  if (buffer->GetPrivate(context, GetContentsKey(isolate)).ToLocal(&contents)
+      && contents->IsExternal()) {
+    return static_cast<SharedBufferContents*>(
+        contents.As<v8::External>()->Value());
+  }
+
+  if (buffer->IsExternal())
+    return nullptr;
+
+  v8::SharedArrayBuffer::Contents externalized = buffer->Externalize();
+  scoped_refptr<SharedBufferContents> shared(new SharedBufferContents(
+      externalized.Data(), externalized.ByteLength()));
+  shared->Adopt(isolate, buffer);
+  return shared;
+}
+
+SharedBufferContents::SharedBufferContents(void* data, size_t length)
+    : data_(data),
+      length_(length) {
+}
+
+SharedBufferContents::~SharedBufferContents() {
+  gin::ArrayBufferAllocator::SharedInstance()->Free(data_, length_);
+}
+
+v8::Local<v8::SharedArrayBuffer> SharedBufferContents::NewBuffer(
+    v8::Isolate* isolate) {
+  v8::Local<v8::SharedArrayBuffer> buffer =
+      v8::SharedArrayBuffer::New(isolate, data_, length_);
+  Adopt(isolate, buffer);
+  return buffer;
+}
+
+void SharedBufferContents::Adopt(v8::Isolate* isolate,
+                                 v8::Local<v8::SharedArrayBuffer> buffer) {
+  BufferReference* reference = new BufferReference;
+  reference->handle.Reset(isolate, buffer);
+  reference->contents = this;
+  reference->handle.SetWeak(reference, &OnBufferCollected,
+                            v8::WeakCallbackType::kParameter);
+  buffer->SetPrivate(isolate->GetCurrentContext(), GetContentsKey(isolate),
+                     v8::External::New(isolate, this));
+}
+
+// Gives the SharedArrayBuffers of a message the ids following those of the
+// transferred ArrayBuffers, some versions of v8::ValueDeserializer keep both
+// kinds in one table.
+class WorkerMessage::SerializerDelegate
+    : public v8::ValueSerializer::Delegate {
+ public:
+  SerializerDelegate(v8::Isolate* isolate, WorkerMessage* message)
+      : isolate_(isolate),
+        message_(message),
+        first_id_(static_cast<uint32_t>(message->array_buffers_.size())) {
+  }
+
+  // v8::ValueSerializer::Delegate:
+  void ThrowDataCloneError(v8::Local<v8::String> message) override {
+    ThrowCloneError(isolate_, message);
+  }
+
+  v8::Maybe<uint32_t> GetSharedArrayBufferId(
+      v8::Isolate* isolate,
+      v8::Local<v8::SharedArrayBuffer> buffer) override {
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      if (buffers_[i] == buffer)
+        return v8::Just(first_id_ + static_cast<uint32_t>(i));
+    }
+
+    scoped_refptr<SharedBufferContents> contents =
+        SharedBufferContents::From(isolate, buffer);
+    if (!contents) {
+      ThrowDataCloneError(
+          ToV8String(isolate, "A SharedArrayBuffer could not be shared"));
+      return v8::Nothing<uint32_t>();
+    }
+
+    buffers_.push_back(buffer);
+    message_->shared_array_buffers_.push_back(contents);
+    return v8::Just(first_id_ + static_cast<uint32_t>(buffers_.size() - 1));
+  }
+
+ private:
+  v8::Isolate* isolate_;
+  WorkerMessage* message_;
+  const uint32_t first_id_;
+  std::vector<v8::Local<v8::SharedArrayBuffer>> buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(SerializerDelegate);
+};
+
+WorkerMessage::WorkerMessage() {
+}
+
+WorkerMessage::~WorkerMessage() {
+  // Transferred contents nobody read.
+  for (const ArrayBufferContents& contents : array_buffers_)
+    gin::ArrayBufferAllocator::SharedInstance()->Free(contents.data,
+                                                      contents.length);
+}
+
+// static
+std::unique_ptr<WorkerMessage> WorkerMessage::Create(
+    v8::Isolate* isolate,
+    v8::Local<v8::Value> value,
+    v8::Local<v8::Value> transfer_list) {
+  std::vector<v8::Local<v8::ArrayBuffer>> transfer;
+  if (!atom::GetTransferList(isolate, transfer_list, &transfer))
+    return nullptr;
+
+  for (size_t i = 0; i < transfer.size(); ++i) {
+    bool duplicate = false;
+    for (size_t j = 0; j < i; ++j)
+      duplicate = duplicate || transfer[i] == transfer[j];
+    if (duplicate || !transfer[i]->IsNeuterable()) {
+      ThrowCloneError(isolate,
+          ToV8String(isolate, "An ArrayBuffer could not be transferred"));
+      return nullptr;
+    }
+  }
+
+  std::unique_ptr<WorkerMessage> message(new WorkerMessage);
+  message->array_buffers_.resize(transfer.size());
+
+  SerializerDelegate delegate(isolate, message.get());
+  v8::ValueSerializer serializer(isolate, &delegate);
+  serializer.WriteHeader();
+  for (size_t i = 0; i < transfer.size(); ++i)
+    serializer.TransferArrayBuffer(static_cast<uint32_t>(i), transfer[i]);
+
+  if (!serializer.WriteValue(isolate->GetCurrentContext(), value)
+          .FromMaybe(false)) {
+    message->array_buffers_.clear();
+    return nullptr;
+  }
+
+  std::pair<uint8_t*, size_t> buffer = serializer.Release();
+  message->data_.assign(buffer.first, buffer.first + buffer.second);
+  free(buffer.first);
+
+  for (size_t i = 0; i < transfer.size(); ++i) {
+    ArrayBufferContents& contents = message->array_buffers_[i];
+    if (transfer[i]->IsExternal()) {
+      // The memory belongs to someone else, move a copy of it.
+      v8::ArrayBuffer::Contents external = transfer[i]->GetContents();
+      contents.length = external.ByteLength();
+      contents.data = gin::ArrayBufferAllocator::SharedInstance()->
+          AllocateUninitialized(contents.length);
+      memcpy(contents.data, external.Data(), contents.length);
+    } else {
+      v8::ArrayBuffer::Contents externalized = transfer[i]->Externalize();
+      contents.data = externalized.Data();
+      contents.length = externalized.ByteLength();
+    }
+    transfer[i]->Neuter();
+  }
+  return message;
+}
+
+// static
+std::unique_ptr<WorkerMessage> WorkerMessage::FromData(
+    std::vector<uint8_t> data) {
+  std::unique_ptr<WorkerMessage> message(new WorkerMessage);
+  message->data_ = std::move(data);
+  return message;
+}
+
+v8::MaybeLocal<v8::Value> WorkerMessage::Read(v8::Isolate* isolate) {
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::ValueDeserializer deserializer(isolate, data_.data(), data_.size());
+  deserializer.SetSupportsLegacyWireFormat(true);
+  if (!deserializer.ReadHeader(context).FromMaybe(false))
+    return v8::MaybeLocal<v8::Value>();
+
+  for (size_t i = 0; i < array_buffers_.size(); ++i) {
+    deserializer.TransferArrayBuffer(static_cast<uint32_t>(i),
+        v8::ArrayBuffer::New(isolate, array_buffers_[i].data,
+                             array_buffers_[i].length,
+                             v8::ArrayBufferCreationMode::kInternalized));
+  }
+  uint32_t first_shared_id = static_cast<uint32_t>(array_buffers_.size());
+  array_buffers_.clear();
+
+  for (size_t i = 0; i < shared_array_buffers_.size(); ++i) {
+    deserializer.TransferSharedArrayBuffer(
+        first_shared_id + static_cast<uint32_t>(i),
+        shared_array_buffers_[i]->NewBuffer(isolate));
+  }
+
+  return deserializer.ReadValue(context);
+}
+
+}  // namespace brave
@@ -0,0 +1,100 @@
+// Copyright 2017 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BRAVE_COMMON_WORKERS_WORKER_MESSAGE_H_
+#define BRAVE_COMMON_WORKERS_WORKER_MESSAGE_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "v8/include/v8.h"
+
+namespace brave {
+
+// The memory of a SharedArrayBuffer used by several isolates of this
+// process. Every SharedArrayBuffer object pointing at it holds a reference,
+// the memory is freed once all of them are collected.
+class SharedBufferContents
+    : public base::RefCountedThreadSafe<SharedBufferContents> {
+ public:
+  // Returns the contents of |buffer|, externalizing it the first time it is
+  // shared. Returns null if |buffer| was externalized by someone else.
+  static scoped_refptr<SharedBufferContents> From(
+      v8::Isolate* isolate,
+      v8::Local<v8::SharedArrayBuffer> buffer);
+
+  // Creates a SharedArrayBuffer in |isolate| pointing at this memory.
+  v8::Local<v8::SharedArrayBuffer> NewBuffer(v8::Isolate* isolate);
+
+ private:
+  friend class base::RefCountedThreadSafe<SharedBufferContents>;
+
+  SharedBufferContents(void* data, size_t length);
+  ~SharedBufferContents();
+
+  // Keeps |this| alive for as long as |buffer| is.
+  void Adopt(v8::Isolate* isolate, v8::Local<v8::SharedArrayBuffer> buffer);
+
+  void* data_;
+  size_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedBufferContents);
+};
+
+// A value cloned from one V8 isolate of this process to another, such as
+// between the main process and a V8WorkerThread. Unlike atom::SerializedValue
+// the contents of transferred ArrayBuffers are moved instead of copied, and
+// SharedArrayBuffers point at the same memory on both sides so they can be
+// used with Atomics.
+class WorkerMessage {
+ public:
+  ~WorkerMessage();
+
+  // Serializes |value| in the current context of |isolate|. |transfer_list|
+  // is empty, undefined or an array of ArrayBuffers, which are neutered.
+  // Returns null with an exception pending in |isolate| on failure.
+  static std::unique_ptr<WorkerMessage> Create(
+      v8::Isolate* isolate,
+      v8::Local<v8::Value> value,
+      v8::Local<v8::Value> transfer_list);
+
+  // Wraps data written by v8::ValueSerializer in another process.
+  static std::unique_ptr<WorkerMessage> FromData(std::vector<uint8_t> data);
+
+  // Reads the message in the current context of |isolate|. The transferred
+  // ArrayBuffers are handed over to |isolate|, so a message is read at most
+  // once.
+  v8::MaybeLocal<v8::Value> Read(v8::Isolate* isolate);
+
+  const std::vector<uint8_t>& data() const { return data_; }
+
+  // Whether the message refers to memory that can't leave this process.
+  bool has_buffers() const {
+    return !array_buffers_.empty() || !shared_array_buffers_.empty();
+  }
+
+ private:
+  class SerializerDelegate;
+
+  struct ArrayBufferContents {
+    void* data;
+    size_t length;
+  };
+
+  WorkerMessage();
+
+  std::vector<uint8_t> data_;
+  std::vector<ArrayBufferContents> array_buffers_;
+  std::vector<scoped_refptr<SharedBufferContents>> shared_array_buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkerMessage);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMMON_WORKERS_WORKER_MESSAGE_H_
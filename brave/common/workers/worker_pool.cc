@@ -0,0 +1,271 @@
+// Copyright 2017 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "brave/common/workers/worker_pool.h"
+
+#include <utility>
+
+#include "atom/browser/javascript_environment.h"
+#include "base/bind.h"
+#include "base/strings/string_number_conversions.h"
+#include "brave/common/workers/v8_worker_thread.h"
+#include "brave/common/workers/worker_bindings.h"
+#include "brave/common/workers/worker_message.h"
+#include "content/public/browser/browser_thread.h"
+#include "v8/include/v8.h"
+
+using content::BrowserThread;
+
+namespace brave {
+
+WorkerPool::Worker::Worker()
+    : thread(nullptr),
+      started(false),
+      idle(false) {
+}
+
+WorkerPool::Worker::Worker(Worker&& other) = default;
+
+WorkerPool::Worker::~Worker() {
+}
+
+WorkerPool::WorkerPool(const std::string& module_name,
+                       size_t size,
+                       size_t max_queue_depth,
+                       atom::api::App* app)
+    : module_name_(module_name),
+      max_queue_depth_(max_queue_depth),
+      app_(app),
+      workers_(size),
+      next_worker_(0),
+      stopped_(false) {
+}
+
+WorkerPool::~WorkerPool() {
+}
+
+bool WorkerPool::Start() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  base::AutoLock auto_lock(lock_);
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    auto thread = new V8WorkerThread(
+        module_name_ + "_pool_worker_" + base::SizeTToString(i),
+        module_name_, app_, this);
+    thread->set_code_cache_path(code_cache_path_);
+    if (!thread->Start()) {
+      delete thread;
+      continue;
+    }
+    workers_[i].thread = thread;
+    workers_[i].task_runner = thread->task_runner();
+  }
+
+  for (const auto& worker : workers_) {
+    if (worker.thread)
+      return true;
+  }
+  stopped_ = true;
+  return false;
+}
+
+void WorkerPool::Stop() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  base::AutoLock auto_lock(lock_);
+  if (stopped_)
+    return;
+  stopped_ = true;
+
+  for (auto& worker : workers_) {
+    stats_.rejected += worker.messages.size();
+    worker.messages.clear();
+    if (worker.thread) {
+      worker.task_runner->PostTask(FROM_HERE,
+          base::Bind(&V8WorkerThread::Shutdown));
+    }
+  }
+}
+
+bool WorkerPool::PostMessage(std::unique_ptr<WorkerMessage> message) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  base::AutoLock auto_lock(lock_);
+  if (stopped_ || workers_.empty()) {
+    stats_.rejected++;
+    return false;
+  }
+
+  size_t queued = 0;
+  for (const auto& worker : workers_)
+    queued += worker.messages.size();
+  if (max_queue_depth_ && queued >= max_queue_depth_) {
+    stats_.rejected++;
+    return false;
+  }
+
+  // Prefer a worker that is waiting for messages, otherwise go round-robin
+  // and let idle workers steal from the busy ones.
+  size_t index = workers_.size();
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (workers_[i].started && workers_[i].idle) {
+      index = i;
+      break;
+    }
+  }
+  if (index == workers_.size()) {
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      size_t candidate = (next_worker_ + i) % workers_.size();
+      if (workers_[candidate].thread) {
+        index = candidate;
+        break;
+      }
+    }
+    if (index == workers_.size()) {
+      stats_.rejected++;
+      return false;
+    }
+    next_worker_ = (index + 1) % workers_.size();
+  }
+
+  workers_[index].messages.push_back(std::move(message));
+  WakeUp(index);
+  return true;
+}
+
+WorkerPool::Stats WorkerPool::GetStats() const {
+  base::AutoLock auto_lock(lock_);
+  Stats stats = stats_;
+  for (const auto& worker : workers_) {
+    stats.queued += worker.messages.size();
+    if (worker.thread)
+      stats.workers++;
+    if (worker.thread && worker.started && worker.idle)
+      stats.idle_workers++;
+  }
+  return stats;
+}
+
+std::vector<base::PlatformThreadId> WorkerPool::GetWorkerIds() const {
+  base::AutoLock auto_lock(lock_);
+  std::vector<base::PlatformThreadId> ids;
+  for (const auto& worker : workers_) {
+    if (worker.thread)
+      ids.push_back(worker.thread->GetThreadId());
+  }
+  return ids;
+}
+
+void WorkerPool::OnWorkerStarted(V8WorkerThread* worker) {
+  base::AutoLock auto_lock(lock_);
+  size_t index = IndexOf(worker);
+  if (index == workers_.size())
+    return;
+
+  workers_[index].started = true;
+  workers_[index].idle = true;
+  WakeUp(index);
+}
+
+void WorkerPool::OnWorkerStopped(V8WorkerThread* worker) {
+  base::AutoLock auto_lock(lock_);
+  size_t index = IndexOf(worker);
+  if (index == workers_.size())
+    return;
+
+  // Whatever is left on the queue is picked up by the other workers.
+  workers_[index].thread = nullptr;
+  workers_[index].started = false;
+  workers_[index].idle = false;
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (workers_[i].thread && workers_[i].started && workers_[i].idle) {
+      WakeUp(i);
+      break;
+    }
+  }
+}
+
+void WorkerPool::WakeUp(size_t index) {
+  Worker& worker = workers_[index];
+  if (!worker.thread || !worker.started || !worker.idle)
+    return;
+
+  worker.idle = false;
+  worker.task_runner->PostTask(FROM_HERE,
+      base::Bind(&WorkerPool::RunNextMessage, this, index));
+}
+
+std::unique_ptr<WorkerMessage> WorkerPool::TakeMessage(size_t index) {
+  std::unique_ptr<WorkerMessage> message;
+  if (stopped_)
+    return message;
+
+  if (!workers_[index].messages.empty()) {
+    message = std::move(workers_[index].messages.front());
+    workers_[index].messages.pop_front();
+    return message;
+  }
+
+  // Steal the oldest message from the worker with the longest queue.
+  size_t victim = workers_.size();
+  size_t longest = 0;
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (workers_[i].messages.size() > longest) {
+      longest = workers_[i].messages.size();
+      victim = i;
+    }
+  }
+  if (victim == workers_.size())
+    return message;
+
+  message = std::move(workers_[victim].messages.front());
+  workers_[victim].messages.pop_front();
+  stats_.stolen++;
+  return message;
+}
+
+void WorkerPool::RunNextMessage(size_t index) {
+  V8WorkerThread* worker = V8WorkerThread::current();
+  if (!worker || !worker->env())
+    return;
+
+  std::unique_ptr<WorkerMessage> message;
+  {
+    base::AutoLock auto_lock(lock_);
+    if (workers_[index].thread != worker)
+      return;
+    message = TakeMessage(index);
+    if (!message) {
+      workers_[index].idle = true;
+      return;
+    }
+    stats_.running++;
+  }
+
+  {
+    v8::Isolate* isolate = worker->env()->isolate();
+    v8::HandleScope handle_scope(isolate);
+    v8::Context::Scope context_scope(worker->env()->context());
+    WorkerBindings::DispatchMessage(isolate, message.get());
+  }
+
+  base::AutoLock auto_lock(lock_);
+  stats_.running--;
+  stats_.completed++;
+  // Yield to other tasks on the thread (close, shutdown) between messages.
+  if (workers_[index].thread == worker) {
+    workers_[index].task_runner->PostTask(FROM_HERE,
+        base::Bind(&WorkerPool::RunNextMessage, this, index));
+  }
+}
+
+size_t WorkerPool::IndexOf(V8WorkerThread* worker) const {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (workers_[i].thread == worker)
+      return i;
+  }
+  return workers_.size();
+}
+
+}  // namespace brave
@@ -0,0 +1,120 @@
+// Copyright 2017 The Brave Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BRAVE_COMMON_WORKERS_WORKER_POOL_H_
+#define BRAVE_COMMON_WORKERS_WORKER_POOL_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/single_thread_task_runner.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/platform_thread.h"
+
+namespace atom {
+namespace api {
+class App;
+}
+}
+
+namespace brave {
+
+class V8WorkerThread;
+class WorkerMessage;
+
+// A fixed number of V8WorkerThreads running the same module. Messages are
+// queued on the workers round-robin, or on an idle worker if there is one,
+// and a worker that runs out of messages takes the oldest message queued on
+// the busiest worker.
+class WorkerPool : public base::RefCountedThreadSafe<WorkerPool> {
+ public:
+  struct Stats {
+    uint64_t queued = 0;
+    uint64_t running = 0;
+    uint64_t completed = 0;
+    uint64_t stolen = 0;
+    uint64_t rejected = 0;
+    uint64_t workers = 0;
+    uint64_t idle_workers = 0;
+  };
+
+  // |max_queue_depth| of 0 means the queue is unbounded.
+  WorkerPool(const std::string& module_name,
+             size_t size,
+             size_t max_queue_depth,
+             atom::api::App* app);
+
+  // See V8WorkerThread::set_code_cache_path. Must be called before Start().
+  void set_code_cache_path(const base::FilePath& path) {
+    code_cache_path_ = path;
+  }
+
+  // Starts the worker threads. Called on the UI thread.
+  bool Start();
+
+  // Stops the worker threads and drops queued messages. Called on the UI
+  // thread.
+  void Stop();
+
+  // Queues |message| for the next free worker, returns false if the pool is
+  // stopped or the queue is full. Called on the UI thread.
+  bool PostMessage(std::unique_ptr<WorkerMessage> message);
+
+  Stats GetStats() const;
+  std::vector<base::PlatformThreadId> GetWorkerIds() const;
+
+  // Called on the worker thread once its module is loaded and when it stops.
+  void OnWorkerStarted(V8WorkerThread* worker);
+  void OnWorkerStopped(V8WorkerThread* worker);
+
+ private:
+  friend class base::RefCountedThreadSafe<WorkerPool>;
+
+  struct Worker {
+    Worker();
+    Worker(Worker&& other);
+    ~Worker();
+
+    V8WorkerThread* thread;
+    scoped_refptr<base::SingleThreadTaskRunner> task_runner;
+    std::deque<std::unique_ptr<WorkerMessage>> messages;
+    bool started;
+    bool idle;
+  };
+
+  ~WorkerPool();
+
+  // Wakes up worker |index| if it is waiting for messages. |lock_| must be
+  // held.
+  void WakeUp(size_t index);
+
+  // Runs one message on worker |index| and schedules the next one.
+  void RunNextMessage(size_t index);
+
+  // Takes the next message for worker |index|. |lock_| must be held.
+  std::unique_ptr<WorkerMessage> TakeMessage(size_t index);
+
+  size_t IndexOf(V8WorkerThread* worker) const;
+
+  const std::string module_name_;
+  const size_t max_queue_depth_;
+  atom::api::App* app_;
+  base::FilePath code_cache_path_;
+
+  mutable base::Lock lock_;
+  std::vector<Worker> workers_;
+  size_t next_worker_;
+  bool stopped_;
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkerPool);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMMON_WORKERS_WORKER_POOL_H_
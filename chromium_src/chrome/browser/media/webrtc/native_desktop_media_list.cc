@@ -4,20 +4,27 @@
 
 #include "chrome/browser/media/webrtc/native_desktop_media_list.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <map>
 #include <set>
 #include <sstream>
 
+#include "base/containers/mru_cache.h"
 #include "base/hash.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/synchronization/lock.h"
 #include "base/threading/sequenced_worker_pool.h"
 #include "chrome/browser/media/webrtc/desktop_media_list_observer.h"
 #include "content/public/browser/browser_thread.h"
 #include "media/base/video_util.h"
 #include "third_party/libyuv/include/libyuv/scale_argb.h"
 #include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColorPriv.h"
 #include "third_party/webrtc/modules/desktop_capture/desktop_frame.h"
 #include "third_party/webrtc/modules/desktop_capture/desktop_capturer.h"
 #include "ui/base/l10n/l10n_util.h"
@@ -31,6 +38,31 @@ namespace {
 // Update the list every second.
 const int kDefaultUpdatePeriod = 1000;
 
+// Thumbnails of this many sources are kept for the next lists.
+const size_t kMaxCachedThumbnails = 64;
+
+// Returns a copy of the rows of |frame| that a thumbnail of |thumbnail_size|
+// is scaled from, about two per thumbnail row. The copy owns its pixels, so it
+// can be scaled on another thread while the capturer reuses its buffers, and
+// hashing it reads only a fraction of the frame.
+std::unique_ptr<webrtc::DesktopFrame> SampleDesktopFrame(
+    const webrtc::DesktopFrame& frame,
+    const gfx::Size& thumbnail_size) {
+  int height = frame.size().height();
+  int rows = std::min(height, std::max(1, 2 * thumbnail_size.height()));
+  std::unique_ptr<webrtc::DesktopFrame> sampled(new webrtc::BasicDesktopFrame(
+      webrtc::DesktopSize(frame.size().width(), rows)));
+
+  size_t row_bytes =
+      frame.size().width() * webrtc::DesktopFrame::kBytesPerPixel;
+  for (int y = 0; y < rows; ++y) {
+    int source_y = static_cast<int>(static_cast<int64_t>(y) * height / rows);
+    memcpy(sampled->data() + y * sampled->stride(),
+           frame.data() + source_y * frame.stride(), row_bytes);
+  }
+  return sampled;
+}
+
 // Returns a hash of a DesktopFrame content to detect when image for a desktop
 // media source has changed.
 uint32_t GetFrameHash(webrtc::DesktopFrame* frame) {
@@ -38,40 +70,87 @@ uint32_t GetFrameHash(webrtc::DesktopFrame* frame) {
   return base::SuperFastHash(reinterpret_cast<char*>(frame->data()), data_size);
 }
 
-gfx::ImageSkia ScaleDesktopFrame(std::unique_ptr<webrtc::DesktopFrame> frame,
-                                 gfx::Size size) {
+// Scales |frame|, which may be a sample of a frame of |frame_size|, to fit in
+// |size|.
+SkBitmap ScaleDesktopFrame(const webrtc::DesktopFrame& frame,
+                           const gfx::Size& frame_size,
+                           const gfx::Size& size) {
   gfx::Rect scaled_rect = media::ComputeLetterboxRegion(
-      gfx::Rect(0, 0, size.width(), size.height()),
-      gfx::Size(frame->size().width(), frame->size().height()));
+      gfx::Rect(0, 0, size.width(), size.height()), frame_size);
 
   SkBitmap result;
   result.allocN32Pixels(scaled_rect.width(), scaled_rect.height(), true);
   result.lockPixels();
 
   uint8* pixels_data = reinterpret_cast<uint8*>(result.getPixels());
-  libyuv::ARGBScale(frame->data(), frame->stride(),
-                    frame->size().width(), frame->size().height(),
+  libyuv::ARGBScale(frame.data(), frame.stride(),
+                    frame.size().width(), frame.size().height(),
                     pixels_data, result.rowBytes(),
                     scaled_rect.width(), scaled_rect.height(),
                     libyuv::kFilterBilinear);
 
-  // Set alpha channel values to 255 for all pixels.
+  // Set alpha channel values to 255 for all pixels, a whole pixel at a time
+  // so the loop is vectorized.
   // TODO(sergeyu): Fix screen/window capturers to capture alpha channel and
   // remove this code. Currently screen/window capturers (at least some
   // implementations) only capture R, G and B channels and set Alpha to 0.
   // crbug.com/264424
+  const uint32_t alpha = static_cast<uint32_t>(SK_A32_MASK) << SK_A32_SHIFT;
   for (int y = 0; y < result.height(); ++y) {
-    for (int x = 0; x < result.width(); ++x) {
-      pixels_data[result.rowBytes() * y + x * result.bytesPerPixel() + 3] =
-          0xff;
-    }
+    uint32_t* row = result.getAddr32(0, y);
+    for (int x = 0; x < result.width(); ++x)
+      row[x] |= alpha;
   }
 
   result.unlockPixels();
-
-  return gfx::ImageSkia::CreateFrom1xBitmap(result);
+  result.setImmutable();
+  return result;
 }
 
+// Thumbnails of the sources seen by earlier lists, so a list that finds a
+// source unchanged doesn't have to scale it again. Used on the capture and
+// the scaling threads.
+class ThumbnailCache {
+ public:
+  ThumbnailCache() : entries_(kMaxCachedThumbnails) {}
+
+  bool Get(const DesktopMediaID& id,
+           uint32_t hash,
+           const gfx::Size& thumbnail_size,
+           SkBitmap* thumbnail) {
+    base::AutoLock auto_lock(lock_);
+    auto it = entries_.Get(id);
+    if (it == entries_.end() || it->second.hash != hash ||
+        it->second.thumbnail_size != thumbnail_size)
+      return false;
+    *thumbnail = it->second.thumbnail;
+    return true;
+  }
+
+  void Put(const DesktopMediaID& id,
+           uint32_t hash,
+           const gfx::Size& thumbnail_size,
+           const SkBitmap& thumbnail) {
+    base::AutoLock auto_lock(lock_);
+    entries_.Put(id, Entry{hash, thumbnail_size, thumbnail});
+  }
+
+ private:
+  struct Entry {
+    uint32_t hash;
+    gfx::Size thumbnail_size;
+    SkBitmap thumbnail;
+  };
+
+  base::Lock lock_;
+  base::MRUCache<DesktopMediaID, Entry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThumbnailCache);
+};
+
+base::LazyInstance<ThumbnailCache>::Leaky g_thumbnail_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
 }  // namespace
 
 NativeDesktopMediaList::SourceDescription::SourceDescription(
@@ -81,6 +160,70 @@ NativeDesktopMediaList::SourceDescription::SourceDescription(
       name(name) {
 }
 
+// The thumbnails of one refresh being scaled on the blocking pool. Each
+// scaling task holds a reference, the list is told the refresh is finished
+// when the last one is released.
+class NativeDesktopMediaList::RefreshJob
+    : public base::RefCountedThreadSafe<RefreshJob> {
+ public:
+  RefreshJob(base::WeakPtr<NativeDesktopMediaList> media_list,
+             base::TimeTicks start_time)
+      : media_list_(media_list),
+        start_time_(start_time) {}
+
+  void AddStats(const RefreshStats& stats) {
+    base::AutoLock auto_lock(lock_);
+    stats_.sources += stats.sources;
+    stats_.captured += stats.captured;
+    stats_.unchanged += stats.unchanged;
+    stats_.cached += stats.cached;
+    stats_.scaled += stats.scaled;
+    stats_.capture_time += stats.capture_time;
+    stats_.hash_time += stats.hash_time;
+    stats_.scale_time += stats.scale_time;
+  }
+
+  // Called on the blocking pool.
+  void ScaleThumbnail(int index,
+                      const DesktopMediaID& id,
+                      uint32_t hash,
+                      const gfx::Size& frame_size,
+                      const gfx::Size& thumbnail_size,
+                      std::unique_ptr<webrtc::DesktopFrame> frame) {
+    base::TimeTicks scale_start = base::TimeTicks::Now();
+    SkBitmap thumbnail = ScaleDesktopFrame(*frame, frame_size, thumbnail_size);
+    g_thumbnail_cache.Get().Put(id, hash, thumbnail_size, thumbnail);
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&NativeDesktopMediaList::OnSourceThumbnail,
+                   media_list_, index,
+                   gfx::ImageSkia::CreateFrom1xBitmap(thumbnail)));
+
+    RefreshStats stats;
+    stats.scale_time = base::TimeTicks::Now() - scale_start;
+    AddStats(stats);
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<RefreshJob>;
+
+  ~RefreshJob() {
+    stats_.total_time = base::TimeTicks::Now() - start_time_;
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE,
+        base::Bind(&NativeDesktopMediaList::OnRefreshFinished,
+                   media_list_, stats_));
+  }
+
+  base::WeakPtr<NativeDesktopMediaList> media_list_;
+  const base::TimeTicks start_time_;
+
+  base::Lock lock_;
+  RefreshStats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(RefreshJob);
+};
+
 class NativeDesktopMediaList::Worker
     : public webrtc::DesktopCapturer::Callback {
  public:
@@ -129,6 +272,7 @@ NativeDesktopMediaList::Worker::~Worker() {}
 void NativeDesktopMediaList::Worker::Refresh(
     const gfx::Size& thumbnail_size,
     content::DesktopMediaID::Id view_dialog_id) {
+  base::TimeTicks start_time = base::TimeTicks::Now();
   std::vector<SourceDescription> sources;
 
   if (screen_capturer_) {
@@ -168,11 +312,16 @@ void NativeDesktopMediaList::Worker::Refresh(
       base::Bind(&NativeDesktopMediaList::OnSourcesList,
                  media_list_, sources));
 
+  scoped_refptr<RefreshJob> job(new RefreshJob(media_list_, start_time));
+  RefreshStats stats;
+  stats.sources = sources.size();
   ImageHashesMap new_image_hashes;
 
-  // Get a thumbnail for each source.
+  // Capture the sources one by one, the capturers can't be shared between
+  // threads, and scale the changed thumbnails on the blocking pool.
   for (size_t i = 0; i < sources.size(); ++i) {
     SourceDescription& source = sources[i];
+    base::TimeTicks capture_start = base::TimeTicks::Now();
     switch (source.id.type) {
       case DesktopMediaID::TYPE_SCREEN:
         if (!screen_capturer_->SelectSource(source.id.id))
@@ -189,32 +338,58 @@ void NativeDesktopMediaList::Worker::Refresh(
       default:
         NOTREACHED();
     }
+    base::TimeTicks capture_end = base::TimeTicks::Now();
+    stats.capture_time += capture_end - capture_start;
 
     // Expect that DesktopCapturer to always captures frames synchronously.
     // |current_frame_| may be NULL if capture failed (e.g. because window has
     // been closed).
-    if (current_frame_) {
-      uint32_t frame_hash = GetFrameHash(current_frame_.get());
-      new_image_hashes[source.id] = frame_hash;
-
-      // Scale the image only if it has changed.
-      ImageHashesMap::iterator it = image_hashes_.find(source.id);
-      if (it == image_hashes_.end() || it->second != frame_hash) {
-        gfx::ImageSkia thumbnail =
-            ScaleDesktopFrame(std::move(current_frame_), thumbnail_size);
-        BrowserThread::PostTask(
-            BrowserThread::UI, FROM_HERE,
-            base::Bind(&NativeDesktopMediaList::OnSourceThumbnail,
-                        media_list_, i, thumbnail));
-      }
+    if (!current_frame_)
+      continue;
+    stats.captured++;
+
+    gfx::Size frame_size(current_frame_->size().width(),
+                         current_frame_->size().height());
+    std::unique_ptr<webrtc::DesktopFrame> sampled =
+        SampleDesktopFrame(*current_frame_, thumbnail_size);
+    current_frame_.reset();
+    uint32_t frame_hash = GetFrameHash(sampled.get());
+    new_image_hashes[source.id] = frame_hash;
+    stats.hash_time += base::TimeTicks::Now() - capture_end;
+
+    // Scale the image only if it has changed.
+    ImageHashesMap::iterator it = image_hashes_.find(source.id);
+    if (it != image_hashes_.end() && it->second == frame_hash) {
+      stats.unchanged++;
+      continue;
+    }
+
+    SkBitmap thumbnail;
+    if (g_thumbnail_cache.Get().Get(source.id, frame_hash, thumbnail_size,
+                                    &thumbnail)) {
+      stats.cached++;
+      BrowserThread::PostTask(
+          BrowserThread::UI, FROM_HERE,
+          base::Bind(&NativeDesktopMediaList::OnSourceThumbnail,
+                     media_list_, i,
+                     gfx::ImageSkia::CreateFrom1xBitmap(thumbnail)));
+      continue;
     }
+
+    stats.scaled++;
+    BrowserThread::GetBlockingPool()->PostWorkerTaskWithShutdownBehavior(
+        FROM_HERE,
+        base::Bind(&RefreshJob::ScaleThumbnail, job, i, source.id,
+                   frame_hash, frame_size, thumbnail_size,
+                   base::Passed(&sampled)),
+        base::SequencedWorkerPool::CONTINUE_ON_SHUTDOWN);
   }
 
   image_hashes_.swap(new_image_hashes);
 
-  BrowserThread::PostTask(
-      BrowserThread::UI, FROM_HERE,
-      base::Bind(&NativeDesktopMediaList::OnRefreshFinished, media_list_));
+  // The list is told the refresh is finished once |job| is released by the
+  // last scaling task.
+  job->AddStats(stats);
 }
 
 void NativeDesktopMediaList::Worker::OnCaptureResult(
@@ -358,7 +533,9 @@ void NativeDesktopMediaList::OnSourceThumbnail(
   observer_->OnSourceThumbnailChanged(index);
 }
 
-void NativeDesktopMediaList::OnRefreshFinished() {
+void NativeDesktopMediaList::OnRefreshFinished(const RefreshStats& stats) {
+  last_refresh_stats_ = stats;
+
   // Give a chance to the observer to stop the refresh work.
   bool is_continue = observer_->OnRefreshFinished();
   if (is_continue) {
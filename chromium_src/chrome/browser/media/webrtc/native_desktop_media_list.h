@@ -7,6 +7,7 @@
 
 #include "base/memory/weak_ptr.h"
 #include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
 #include "chrome/browser/media/webrtc/desktop_media_list.h"
 #include "content/public/browser/desktop_media_id.h"
 #include "ui/gfx/image/image_skia.h"
@@ -19,6 +20,24 @@ class DesktopCapturer;
 // native windows.
 class NativeDesktopMediaList : public DesktopMediaList {
  public:
+  // What the last refresh cost, for tuning the update period and the
+  // thumbnail size.
+  struct RefreshStats {
+    int sources = 0;
+    int captured = 0;
+    // Thumbnails skipped because the frame did not change.
+    int unchanged = 0;
+    // Thumbnails taken from the cache of earlier lists.
+    int cached = 0;
+    int scaled = 0;
+    base::TimeDelta capture_time;
+    base::TimeDelta hash_time;
+    // Summed over the threads scaling the thumbnails.
+    base::TimeDelta scale_time;
+    // From the start of the refresh until the last thumbnail is ready.
+    base::TimeDelta total_time;
+  };
+
   // Caller may pass NULL for either of the arguments in case when only some
   // types of sources the model should be populated with (e.g. it will only
   // contain windows, if |screen_capturer| is NULL).
@@ -36,7 +55,12 @@ class NativeDesktopMediaList : public DesktopMediaList {
   std::vector<Source> GetSources() const override;
   void SetViewDialogWindowId(content::DesktopMediaID::Id dialog_id) override;
 
+  const RefreshStats& last_refresh_stats() const {
+    return last_refresh_stats_;
+  }
+
  private:
+  class RefreshJob;
   class Worker;
   friend class Worker;
 
@@ -58,10 +82,10 @@ class NativeDesktopMediaList : public DesktopMediaList {
   // Called by |worker_| to refresh the model. First it posts tasks for
   // OnSourcesList() with the fresh list of sources, then follows with
   // OnSourceThumbnail() for each changed thumbnail and then calls
-  // OnRefreshFinished() at the end.
+  // OnRefreshFinished() once all thumbnails are scaled.
   void OnSourcesList(const std::vector<SourceDescription>& sources);
   void OnSourceThumbnail(int index, const gfx::ImageSkia& thumbnail);
-  void OnRefreshFinished();
+  void OnRefreshFinished(const RefreshStats& stats);
 
   // Capturers specified in SetCapturers() and passed to the |worker_| later.
   std::unique_ptr<webrtc::DesktopCapturer> screen_capturer_;
@@ -90,6 +114,8 @@ class NativeDesktopMediaList : public DesktopMediaList {
   // Current list of sources.
   std::vector<Source> sources_;
 
+  RefreshStats last_refresh_stats_;
+
   base::WeakPtrFactory<NativeDesktopMediaList> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(NativeDesktopMediaList);
@@ -59,8 +59,9 @@ app.postMessage = function (message) {
   app.emit('app-post-message', {}, message)
 }
 
-function Worker (module_name) {
+function Worker (module_name, options) {
   this.module_name = module_name
+  this.options = options
   this.lastError = null
   this.__onerror = null
   this.onmessage = null
@@ -68,12 +69,15 @@ function Worker (module_name) {
 
 Worker.prototype.start = function (cb) {
   cb && this.once('start', cb)
-  this.id = app._startWorker(this.module_name)
+  this.id = app._startWorker(this.module_name, this.module_name + '_worker',
+    this.options.codeCachePath)
 }
 
-Worker.prototype.postMessage = function (message) {
+// ArrayBuffers in `transferList` are moved to the worker and can no longer
+// be used here. SharedArrayBuffers are always shared, not copied.
+Worker.prototype.postMessage = function (message, transferList) {
   const evt = {data: message}
-  app._postMessage(this.id, evt)
+  app._postMessage(this.id, evt, transferList)
 }
 
 Worker.prototype.terminate = function () {
@@ -90,8 +94,10 @@ Object.defineProperty(Worker.prototype, 'onerror', {
 
 Object.setPrototypeOf(Worker.prototype, EventEmitter.prototype)
 
-app.createWorker = function (module_name) {
-  const worker = new Worker(module_name)
+// `options.codeCachePath` is a file the compiled code of the module is kept
+// in between runs, so later workers skip parsing and compiling it.
+app.createWorker = function (module_name, options = {}) {
+  const worker = new Worker(module_name, options)
 
   // It is always safe to call the worker methods because
   // WorkerThreadRegistry will return a dummy task runner
@@ -125,6 +131,76 @@ app.createWorker = function (module_name) {
   return worker
 }
 
+function WorkerPool (module_name, options) {
+  this.module_name = module_name
+  this.options = options
+  this.workerIds = []
+  this.onerror = null
+}
+
+WorkerPool.prototype.start = function (cb) {
+  cb && this.once('start', cb)
+  this.id = app._startWorkerPool(this.module_name, this.options.size || 0,
+    this.options.maxQueueDepth || 0, this.options.codeCachePath)
+  this.workerIds = this.id === -1 ? [] : app._getWorkerPoolWorkers(this.id)
+}
+
+// Returns false when the message was not queued because the pool is
+// stopped or already holds `maxQueueDepth` messages.
+WorkerPool.prototype.postMessage = function (message, transferList) {
+  const evt = {data: message}
+  return app._postPoolMessage(this.id, evt, transferList)
+}
+
+WorkerPool.prototype.getStats = function () {
+  return app._getWorkerPoolStats(this.id)
+}
+
+WorkerPool.prototype.terminate = function () {
+  app._stopWorkerPool(this.id)
+}
+
+Object.setPrototypeOf(WorkerPool.prototype, EventEmitter.prototype)
+
+app.createWorkerPool = function (module_name, options = {}) {
+  const pool = new WorkerPool(module_name, options)
+  let started = 0
+
+  app.on('worker-start', (e, worker_id) => {
+    if (pool.workerIds.includes(worker_id)) {
+      pool.emit('worker-start', worker_id)
+      if (++started === pool.workerIds.length) {
+        pool.emit('start', {})
+      }
+    }
+  })
+  app.on('worker-stop', (e, worker_id) => {
+    if (pool.workerIds.includes(worker_id)) {
+      pool.emit('worker-stop', worker_id)
+    }
+  })
+  app.on('worker-post-message', (e, worker_id, message) => {
+    if (pool.workerIds.includes(worker_id)) {
+      pool.emit('message', {data: message, workerId: worker_id})
+    }
+  })
+  app.on('worker-onerror', (e, worker_id, message, stack) => {
+    if (pool.workerIds.includes(worker_id)) {
+      pool.onerror && pool.onerror(message, stack, worker_id)
+    }
+  })
+
+  return pool
+}
+
+// Connects two workers, or a worker and a webContents, with a channel that
+// does not go through the main process. Each worker end gets the port in
+// `onconnect` and a webContents gets it in an ipcRenderer `worker-port` event.
+app.createMessageChannel = function (a, b) {
+  const endpoint = (end) => end instanceof Worker ? end.id : end
+  return app._createMessageChannel(endpoint(a), endpoint(b))
+}
+
 app.allowNTLMCredentialsForAllDomains = function (allow) {
   if (!process.noDeprecations) {
     deprecate.warn('app.allowNTLMCredentialsForAllDomains', 'session.allowNTLMCredentialsForDomains')
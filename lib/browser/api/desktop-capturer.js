@@ -0,0 +1,6 @@
+const {EventEmitter} = require('events')
+const {desktopCapturer, DesktopCapturer} = process.atomBinding('desktop_capturer')
+
+Object.setPrototypeOf(DesktopCapturer.prototype, EventEmitter.prototype)
+
+module.exports = desktopCapturer
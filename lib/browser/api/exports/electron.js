@@ -41,6 +41,12 @@ Object.defineProperties(exports, {
       return require('../content-tracing')
     }
   },
+  desktopCapturer: {
+    enumerable: true,
+    get: function () {
+      return require('../desktop-capturer')
+    }
+  },
   dialog: {
     enumerable: true,
     get: function () {
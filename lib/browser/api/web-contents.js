@@ -105,6 +105,10 @@ WebContents.prototype.sendToAll = function (channel, ...args) {
   if (channel == null) throw new Error('Missing required channel argument')
   return this._send(true, channel, args)
 }
+WebContents.prototype.postMessage = function (channel, message, transfer) {
+  if (channel == null) throw new Error('Missing required channel argument')
+  return this._postMessage(false, channel, message, transfer)
+}
 
 WebContents.prototype.clone = function(...args) {
   if (args.length === 0) {
@@ -190,6 +194,18 @@ WebContents.prototype._init = function () {
     })
     ipcMain.emit(channel, event, ...args)
   })
+  this.on('ipc-post-message', function (event, channel, message) {
+    ipcMain.emit(channel, event, message)
+  })
+  this.on('ipc-post-message-sync', function (event, channel, message) {
+    Object.defineProperty(event, 'returnValue', {
+      set: function (value) {
+        return event.sendSerializedReply(value)
+      },
+      get: function () {}
+    })
+    ipcMain.emit(channel, event, message)
+  })
 
   // Handle context menu action request from pepper plugin.
   this.on('pepper-context-menu', function (event, params) {
@@ -54,7 +54,117 @@ let supportedWebViewEvents = [
   'did-block-run-insecure-content'
 ]
 
+// Events that only describe the latest state of the guest, a queued one is
+// dropped when the guest emits the same event again before the flush.
+const supersededWebViewEvents = [
+  'page-favicon-updated',
+  'update-target-url',
+  'did-change-theme-color',
+  'preferred-size-changed',
+  'security-style-changed'
+]
+
+// Events the embedder has to handle right away, they flush the queue.
+const immediateWebViewEvents = [
+  'will-detach',
+  'did-detach',
+  'crashed',
+  'destroyed',
+  'new-window',
+  'context-menu',
+  'set-active',
+  'enter-html-full-screen',
+  'leave-html-full-screen',
+  'show-autofill-popup',
+  'hide-autofill-popup'
+]
+
+// Events that end the guest, sent even after the guest is destroyed and
+// regardless of the embedder's event filter.
+const finalWebViewEvents = ['destroyed', 'crashed', 'did-detach', 'will-detach']
+
+// Guest events are queued per embedder and sent as one IPC message about
+// once per frame.
+const flushInterval = 16
+
 let guests = {}
+let dispatchers = {}
+
+const getDispatcher = function (embedder) {
+  const embedderId = embedder.getId()
+  let dispatcher = dispatchers[embedderId]
+  if (dispatcher) {
+    return dispatcher
+  }
+
+  dispatcher = {
+    embedder,
+    queue: [],
+    superseded: {},
+    filters: {},
+    timer: null
+  }
+  dispatchers[embedderId] = dispatcher
+  embedder.once('destroyed', function () {
+    if (dispatcher.timer) {
+      clearTimeout(dispatcher.timer)
+    }
+    delete dispatchers[embedderId]
+  })
+  return dispatcher
+}
+
+const flushEvents = function (dispatcher) {
+  if (dispatcher.timer) {
+    clearTimeout(dispatcher.timer)
+    dispatcher.timer = null
+  }
+  if (dispatcher.queue.length === 0) {
+    return
+  }
+
+  const events = []
+  for (const entry of dispatcher.queue) {
+    if (!entry.superseded) {
+      events.push([entry.tabId, entry.event, entry.args])
+    }
+  }
+  dispatcher.queue = []
+  dispatcher.superseded = {}
+
+  if (!dispatcher.embedder.isDestroyed()) {
+    dispatcher.embedder.send('ELECTRON_GUEST_VIEW_INTERNAL_DISPATCH_EVENTS', events)
+  }
+}
+
+const queueEvent = function (embedder, tabId, event, args) {
+  const dispatcher = getDispatcher(embedder)
+  const filter = dispatcher.filters[tabId]
+  if (filter && !filter.has(event) && !finalWebViewEvents.includes(event)) {
+    return
+  }
+
+  const entry = {tabId, event, args, superseded: false}
+  if (supersededWebViewEvents.includes(event)) {
+    const key = tabId + '-' + event
+    const previous = dispatcher.superseded[key]
+    if (previous) {
+      previous.superseded = true
+    }
+    dispatcher.superseded[key] = entry
+  }
+  dispatcher.queue.push(entry)
+
+  if (immediateWebViewEvents.includes(event)) {
+    flushEvents(dispatcher)
+  } else if (!dispatcher.timer) {
+    dispatcher.timer = setTimeout(function () {
+      dispatcher.timer = null
+      flushEvents(dispatcher)
+    }, flushInterval)
+  }
+}
+
 const registerGuest = function (guest, embedder) {
   const tabId = guest.getId()
 
@@ -66,6 +176,14 @@ const registerGuest = function (guest, embedder) {
 
   const oldEmbedder = guests[tabId]
   guests[tabId] = embedder
+  if (oldEmbedder) {
+    // Deliver what is queued for the old embedder before the new one gets
+    // events for this guest.
+    const dispatcher = dispatchers[oldEmbedder.getId()]
+    if (dispatcher) {
+      flushEvents(dispatcher)
+    }
+  }
   if (oldEmbedder !== undefined) {
     return
   }
@@ -79,7 +197,7 @@ const registerGuest = function (guest, embedder) {
         return
 
       let forceSend = false
-      if (['destroyed', 'crashed', 'did-detach', 'will-detach'].includes(event)) {
+      if (finalWebViewEvents.includes(event)) {
         delete guests[tabId]
         forceSend = true
       }
@@ -87,7 +205,10 @@ const registerGuest = function (guest, embedder) {
       if (guest.isDestroyed() && !forceSend)
         return
 
-      embedder.send.apply(embedder, ['ELECTRON_GUEST_VIEW_INTERNAL_DISPATCH_EVENT-' + tabId, event].concat(args))
+      queueEvent(embedder, tabId, event, args)
+      if (forceSend) {
+        delete getDispatcher(embedder).filters[tabId]
+      }
     })
   }
   for (const event of supportedWebViewEvents) {
@@ -100,8 +221,28 @@ const registerGuest = function (guest, embedder) {
     if (!embedder || embedder.isDestroyed() || guest.isDestroyed())
       return
 
+    // Keep the messages ordered with the queued events.
+    const dispatcher = dispatchers[embedder.getId()]
+    if (dispatcher) {
+      flushEvents(dispatcher)
+    }
     embedder.send.apply(embedder, ['ELECTRON_GUEST_VIEW_INTERNAL_IPC_MESSAGE-' + tabId, channel].concat(args))
   })
 }
 
+// The embedder only gets the events of the guest listed in |events|, or all
+// of them when |events| is null.
+ipcMain.on('ELECTRON_GUEST_VIEW_MANAGER_SET_EVENT_FILTER', function (event, tabId, events) {
+  const embedder = event.sender
+  if (guests[tabId] && guests[tabId] !== embedder)
+    return
+
+  const dispatcher = getDispatcher(embedder)
+  if (Array.isArray(events)) {
+    dispatcher.filters[tabId] = new Set(events)
+  } else {
+    delete dispatcher.filters[tabId]
+  }
+})
+
 exports.registerGuest = registerGuest
@@ -52,6 +52,61 @@ let getObjectPrototype = function (object) {
   }
 }
 
+// Descriptions of prototype chains, shared by all objects with the same
+// prototype. A prototype is described the first time an object inheriting
+// from it is sent, and again under a new id when the names of its members
+// change.
+// prototype => {id, names, proto}
+const prototypeShapes = new WeakMap()
+// The prototypes by shape id, held weakly so their descriptions go away with
+// them.
+// id => prototype
+const shapePrototypes = v8Util.createIDWeakMap()
+let nextShapeId = 0
+
+// The shapes that have been sent to each WebContents.
+// (webContentsId) => Set(shapeId)
+const sentShapes = {}
+
+// Return the names of the members along object's prototype chain.
+let getPrototypeNames = function (object) {
+  let names = []
+  let proto = Object.getPrototypeOf(object)
+  while (proto !== null && proto !== Object.prototype) {
+    names.push(Object.getOwnPropertyNames(proto).join())
+    proto = Object.getPrototypeOf(proto)
+  }
+  return names.join('|')
+}
+
+let getPrototypeShape = function (object) {
+  let proto = Object.getPrototypeOf(object)
+  if (proto === null || proto === Object.prototype) return null
+  let names = getPrototypeNames(object)
+  let shape = prototypeShapes.get(proto)
+  if (!shape || shape.names !== names) {
+    shape = {id: ++nextShapeId, names, proto: getObjectPrototype(object)}
+    prototypeShapes.set(proto, shape)
+    shapePrototypes.set(shape.id, proto)
+  }
+  return shape
+}
+
+// Remember that |sender| has the shape, returns false if it didn't before.
+let markShapeSent = function (sender, shapeId) {
+  let webContentsId = sender.getId()
+  let shapes = sentShapes[webContentsId]
+  if (!shapes) {
+    shapes = sentShapes[webContentsId] = new Set()
+    sender.once('will-destroy', () => {
+      delete sentShapes[webContentsId]
+    })
+  }
+  if (shapes.has(shapeId)) return false
+  shapes.add(shapeId)
+  return true
+}
+
 // Convert a real value into meta data.
 let valueToMeta = function (sender, value, optimizeSimpleObject = false) {
   // Determine the type of value.
@@ -90,7 +145,16 @@ let valueToMeta = function (sender, value, optimizeSimpleObject = false) {
     // it.
     meta.id = objectsRegistry.add(sender, value)
     meta.members = getObjectMembers(value)
-    meta.proto = getObjectPrototype(value)
+
+    // Only send the prototype description the first time, the renderer asks
+    // for shapes it doesn't have (e.g. after a reload).
+    let shape = getPrototypeShape(value)
+    if (shape === null) {
+      meta.proto = null
+    } else {
+      meta.shapeId = shape.id
+      if (markShapeSent(sender, shape.id)) meta.proto = shape.proto
+    }
   } else if (meta.type === 'buffer') {
     meta.value = Buffer.from(value)
   } else if (meta.type === 'promise') {
@@ -227,6 +291,61 @@ const callFunction = function (event, func, caller, args) {
   }
 }
 
+// Run the operations recorded by remote.batch in the renderer. Each
+// operation reads the result of an earlier one by index, and the results
+// listed in |chain.returns| are sent back.
+const runBatchChain = function (sender, chain) {
+  let values = []
+  let receivers = []
+  try {
+    for (let op of chain.ops) {
+      let value, receiver
+      switch (op.type) {
+        case 'root':
+          if (op.id != null) {
+            value = objectsRegistry.get(op.id)
+          } else if (op.name === 'currentWindow') {
+            value = sender.getOwnerBrowserWindow()
+          } else if (op.name === 'currentWebContents') {
+            value = sender
+          } else {
+            throw new TypeError(`Unknown batch root: ${op.name}`)
+          }
+          break
+        case 'get':
+          receiver = values[op.target]
+          value = receiver[op.name]
+          break
+        case 'set':
+          values[op.target][op.name] = unwrapArgs(sender, op.value)[0]
+          break
+        case 'call':
+          value = values[op.target].apply(receivers[op.target],
+                                          unwrapArgs(sender, op.args))
+          break
+        default:
+          throw new TypeError(`Unknown batch operation: ${op.type}`)
+      }
+      values.push(value)
+      receivers.push(receiver)
+    }
+    return chain.returns.map((index) => valueToMeta(sender, values[index], true))
+  } catch (error) {
+    return exceptionToMeta(error)
+  }
+}
+
+ipcMain.on('ELECTRON_BROWSER_BATCH', function (event, chains) {
+  event.returnValue = chains.map((chain) => runBatchChain(event.sender, chain))
+})
+
+ipcMain.on('ELECTRON_BROWSER_BATCH_ASYNC', function (event, requestId, chains) {
+  let results = chains.map((chain) => runBatchChain(event.sender, chain))
+  if (!event.sender.isDestroyed()) {
+    event.sender.send('ELECTRON_RENDERER_BATCH_RESPONSE', requestId, results)
+  }
+})
+
 ipcMain.on('ELECTRON_BROWSER_REQUIRE', function (event, module) {
   try {
     event.returnValue = valueToMeta(event.sender, process.mainModule.require(module))
@@ -346,6 +465,15 @@ ipcMain.on('ELECTRON_BROWSER_MEMBER_GET', function (event, id, name) {
   }
 })
 
+ipcMain.on('ELECTRON_BROWSER_SHAPE', function (event, shapeId) {
+  markShapeSent(event.sender, shapeId)
+  let shape = null
+  if (shapePrototypes.has(shapeId)) {
+    shape = prototypeShapes.get(shapePrototypes.get(shapeId))
+  }
+  event.returnValue = shape ? shape.proto : null
+})
+
 ipcMain.on('ELECTRON_BROWSER_DEREFERENCE', function (event, id) {
   objectsRegistry.remove(event.sender.getId(), id)
 })
@@ -483,9 +483,16 @@
         throw new TypeError('Bad arguments')
       }
       const {encoding} = options
+      const mapped = archive.readFile(filePath)
+      if (mapped) {
+        logASARAccess(asarPath, filePath, info.offset)
+        return process.nextTick(function () {
+          callback(null, encoding ? mapped.toString(encoding) : mapped)
+        })
+      }
       const buffer = new Buffer(info.size)
       const fd = archive.getFd()
-      if (!(fd >= 0)) {
+      if (!(fd >= 0) || info.compressed) {
         return notFoundError(asarPath, filePath, callback)
       }
       logASARAccess(asarPath, filePath, info.offset)
@@ -531,9 +538,14 @@
         throw new TypeError('Bad arguments')
       }
       const {encoding} = options
+      const mapped = archive.readFile(filePath)
+      if (mapped) {
+        logASARAccess(asarPath, filePath, info.offset)
+        return encoding ? mapped.toString(encoding) : mapped
+      }
       const buffer = new Buffer(info.size)
       const fd = archive.getFd()
-      if (!(fd >= 0)) {
+      if (!(fd >= 0) || info.compressed) {
         notFoundError(asarPath, filePath)
       }
       logASARAccess(asarPath, filePath, info.offset)
@@ -604,9 +616,14 @@
           encoding: 'utf8'
         })
       }
+      const source = archive.readFileUtf8(filePath)
+      if (source !== false) {
+        logASARAccess(asarPath, filePath, info.offset)
+        return source
+      }
       const buffer = new Buffer(info.size)
       const fd = archive.getFd()
-      if (!(fd >= 0)) {
+      if (!(fd >= 0) || info.compressed) {
         return
       }
       logASARAccess(asarPath, filePath, info.offset)
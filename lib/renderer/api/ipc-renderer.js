@@ -14,6 +14,14 @@ ipcRenderer.sendSync = function (...args) {
   return JSON.parse(binding.sendSync('ipc-message-sync', args))
 }
 
+ipcRenderer.postMessage = function (channel, message, transfer) {
+  return binding.postMessage(channel, message, transfer)
+}
+
+ipcRenderer.postMessageSync = function (channel, message, transfer) {
+  return binding.postMessageSync(channel, message, transfer)
+}
+
 ipcRenderer.sendToHost = function (...args) {
   return binding.send('ipc-message-host', args)
 }
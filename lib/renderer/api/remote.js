@@ -10,6 +10,13 @@ const callbacksRegistry = new CallbacksRegistry()
 
 const remoteObjectCache = v8Util.createIDWeakMap()
 
+// Prototype descriptions received from the browser.
+// shapeId => description
+const prototypeShapes = new Map()
+
+// Index of the operation whose result each batch recorder stands for.
+const recorderIndexes = new WeakMap()
+
 // Convert the arguments object into an array of meta data.
 const wrapArgs = function (args, visited) {
   if (visited == null) {
@@ -17,6 +24,11 @@ const wrapArgs = function (args, visited) {
   }
 
   const valueToMeta = function (value) {
+    // Values read in a remote.batch only exist in the main process.
+    if (recorderIndexes.has(value)) {
+      throw new TypeError('Values read in a batch can not be passed to it as arguments')
+    }
+
     // Check for circular reference.
     if (visited.has(value)) {
       return {
@@ -154,6 +166,22 @@ const setObjectPrototype = function (ref, object, metaId, descriptor) {
   Object.setPrototypeOf(object, proto)
 }
 
+// Get the prototype description of |meta|, which is only sent the first time
+// the browser sends an object with that shape.
+const getPrototypeShape = function (meta) {
+  if (meta.shapeId == null) return meta.proto
+  if (meta.proto !== undefined) {
+    prototypeShapes.set(meta.shapeId, meta.proto)
+    return meta.proto
+  }
+  let proto = prototypeShapes.get(meta.shapeId)
+  if (proto === undefined) {
+    proto = ipcRenderer.sendSync('ELECTRON_BROWSER_SHAPE', meta.shapeId)
+    prototypeShapes.set(meta.shapeId, proto)
+  }
+  return proto
+}
+
 // Wrap function in Proxy for accessing remote properties
 const proxyFunctionProperties = function (remoteMemberFunction, metaId, name) {
   let loaded = false
@@ -244,7 +272,7 @@ const metaToValue = function (meta) {
       // Populate delegate members.
       setObjectMembers(ret, ret, meta.id, meta.members)
       // Populate delegate prototype.
-      setObjectPrototype(ret, ret, meta.id, meta.proto)
+      setObjectPrototype(ret, ret, meta.id, getPrototypeShape(meta))
 
       // Set constructor.name to object's name.
       Object.defineProperty(ret.constructor, 'name', { value: meta.name })
@@ -279,6 +307,88 @@ const metaToPlainObject = function (meta) {
   return obj
 }
 
+// Pending remote.batchAsync calls, sent together in one message from a
+// microtask.
+let pendingBatches = []
+// requestId => batches
+const sentBatches = new Map()
+let nextBatchRequestId = 0
+
+// Create a stand-in for the result of operation |index| that records the
+// property gets, sets and calls made on it.
+const createBatchRecorder = function (ops, index) {
+  const recorder = new Proxy(function () {}, {
+    get: (target, property) => {
+      // keep the recorder from looking like a promise
+      if (typeof property !== 'string' || property === 'then') return undefined
+      ops.push({type: 'get', target: index, name: property})
+      return createBatchRecorder(ops, ops.length - 1)
+    },
+    set: (target, property, value) => {
+      ops.push({type: 'set', target: index, name: property, value: wrapArgs([value])})
+      return true
+    },
+    apply: (target, thisArg, args) => {
+      ops.push({type: 'call', target: index, args: wrapArgs(args)})
+      return createBatchRecorder(ops, ops.length - 1)
+    }
+  })
+  recorderIndexes.set(recorder, index)
+  return recorder
+}
+
+// Record the operations |fn| makes on |root|, which is a remote object,
+// 'currentWindow' or 'currentWebContents'.
+const recordBatch = function (root, fn) {
+  let ops = []
+  if (root === 'currentWindow' || root === 'currentWebContents') {
+    ops.push({type: 'root', name: root})
+  } else if (root != null && privates(root).atomId) {
+    ops.push({type: 'root', id: privates(root).atomId})
+  } else {
+    throw new TypeError('The batch root must be a remote object')
+  }
+
+  let result = fn(createBatchRecorder(ops, 0))
+  let many = Array.isArray(result)
+  let results = many ? result : (result === undefined ? [] : [result])
+  let returns = results.map((value) => {
+    if (!recorderIndexes.has(value)) {
+      throw new TypeError('A batch can only return values read from its root')
+    }
+    return recorderIndexes.get(value)
+  })
+  return {chain: {ops, returns}, many}
+}
+
+const batchResultToValue = function (batch, result) {
+  if (!Array.isArray(result)) return metaToValue(result)  // exception
+  let values = result.map(metaToValue)
+  return batch.many ? values : values[0]
+}
+
+const flushBatches = function () {
+  let batches = pendingBatches
+  pendingBatches = []
+  let requestId = ++nextBatchRequestId
+  sentBatches.set(requestId, batches)
+  ipcRenderer.send('ELECTRON_BROWSER_BATCH_ASYNC', requestId,
+                   batches.map((batch) => batch.chain))
+}
+
+ipcRenderer.on('ELECTRON_RENDERER_BATCH_RESPONSE', function (event, requestId, results) {
+  let batches = sentBatches.get(requestId)
+  if (!batches) return
+  sentBatches.delete(requestId)
+  batches.forEach((batch, i) => {
+    try {
+      batch.resolve(batchResultToValue(batch, results[i]))
+    } catch (error) {
+      batch.reject(error)
+    }
+  })
+})
+
 // Browser calls a callback in renderer.
 ipcRenderer.on('ELECTRON_RENDERER_CALLBACK', function (event, id, args) {
   callbacksRegistry.apply(id, metaToValue(args))
@@ -310,6 +420,26 @@ binding.getCurrentWebContents = function () {
   return metaToValue(ipcRenderer.sendSync('ELECTRON_BROWSER_CURRENT_WEB_CONTENTS'))
 }
 
+// Run the remote operations |fn| makes on |root| in one round trip.
+binding.batch = function (root, fn) {
+  let batch = recordBatch(root, fn)
+  let results = ipcRenderer.sendSync('ELECTRON_BROWSER_BATCH', [batch.chain])
+  return batchResultToValue(batch, results[0])
+}
+
+// Like batch but returns a promise, batches started before the next
+// microtask checkpoint share one message.
+binding.batchAsync = function (root, fn) {
+  return new Promise((resolve, reject) => {
+    let batch = recordBatch(root, fn)
+    batch.resolve = resolve
+    batch.reject = reject
+    if (pendingBatches.push(batch) === 1) {
+      Promise.resolve().then(flushBatches)
+    }
+  })
+}
+
 binding.getWebContents = function (tabId, cb) {
   const responseId = ipcRenderer.guid()
   ipcRenderer.on('ELECTRON_BROWSER_GET_WEB_CONTENTS_RESPONSE_' + responseId, (evt, res) => {
@@ -335,4 +465,6 @@ for (var i = 0, len = deprecatedRemoteAPIs.length; i < len; i++) {
 exports.$set('callAsyncWebContentsFunction', binding.callAsyncWebContentsFunction)
 exports.$set('getWebContents', binding.getWebContents)
 exports.$set('getCurrentWebContents', binding.getCurrentWebContents)
+exports.$set('batch', binding.batch)
+exports.$set('batchAsync', binding.batchAsync)
 exports.$set('binding', binding)
@@ -64,12 +64,30 @@ var dispatchEvent = function (webView, eventName, eventKey, ...args) {
   webView.dispatchEvent(domEvent)
 }
 
+// The browser sends the events of all guests of this page in batches.
+var webViews = {}
+var listening = false
+
+var dispatchEvents = function (event, events) {
+  for (var i = 0; i < events.length; i++) {
+    var tabId = events[i][0]
+    var eventName = events[i][1]
+    var webView = webViews[tabId]
+    if (webView) {
+      dispatchEvent.apply(null, [webView, eventName, eventName].concat(events[i][2]))
+    }
+  }
+}
+
 const GuestViewInternal = {
   registerEvents: function (webView, tabId) {
-    ipcRenderer.on('ELECTRON_GUEST_VIEW_INTERNAL_DISPATCH_EVENT-' + tabId, function (event, eventName, ...args) {
-      dispatchEvent.apply(null, [webView, eventName, eventName].concat(args))
-    })
+    webViews[tabId] = webView
+    if (!listening) {
+      ipcRenderer.on('ELECTRON_GUEST_VIEW_INTERNAL_DISPATCH_EVENTS', dispatchEvents)
+      listening = true
+    }
 
+    ipcRenderer.removeAllListeners('ELECTRON_GUEST_VIEW_INTERNAL_IPC_MESSAGE-' + tabId)
     ipcRenderer.on('ELECTRON_GUEST_VIEW_INTERNAL_IPC_MESSAGE-' + tabId, function (event, channel, ...args) {
       var domEvent = new Event('ipc-message')
       domEvent.channel = channel
@@ -79,8 +97,12 @@ const GuestViewInternal = {
 
   },
   deregisterEvents: function (tabId) {
-    ipcRenderer.removeAllListeners('ELECTRON_GUEST_VIEW_INTERNAL_DISPATCH_EVENT-' + tabId)
+    delete webViews[tabId]
     ipcRenderer.removeAllListeners('ELECTRON_GUEST_VIEW_INTERNAL_IPC_MESSAGE-' + tabId)
+  },
+  // Only the events in |events| are sent for |tabId|, all of them if null.
+  setEventFilter: function (tabId, events) {
+    ipcRenderer.send('ELECTRON_GUEST_VIEW_MANAGER_SET_EVENT_FILTER', tabId, events)
   }
 }
 
@@ -4,10 +4,34 @@ const https = require('https')
 const net = require('net')
 const fs = require('fs')
 const path = require('path')
-const {remote} = require('electron')
+const {ipcRenderer, remote} = require('electron')
 const {closeWindow} = require('./window-helpers')
 
 const {app, BrowserWindow, ipcMain} = remote
+const workerBenchmark = remote.require(path.join(__dirname, 'fixtures', 'module', 'worker-benchmark.js'))
+const workerPool = remote.require(path.join(__dirname, 'fixtures', 'module', 'worker-pool.js'))
+
+// Skips the specs of the calling describe unless a worker running
+// |moduleName| starts, worker modules are only found when running from a
+// source checkout. The worker runs until the describe is done.
+const skipUnlessWorkerStarts = function (moduleName) {
+  let skipped = false
+
+  before(function (done) {
+    workerBenchmark.start(moduleName, remote.getCurrentWebContents(), function (error) {
+      skipped = !!error
+      done()
+    })
+  })
+
+  beforeEach(function () {
+    if (skipped) this.skip()
+  })
+
+  after(function () {
+    workerBenchmark.stop()
+  })
+}
 
 describe('electron module', function () {
   it('does not expose internal modules to require', function () {
@@ -334,4 +358,201 @@ describe('app module', function () {
       assert.equal(typeof app.isAccessibilitySupportEnabled(), 'boolean')
     })
   })
+
+  describe('app.createWorker(moduleName, {codeCachePath})', function () {
+    const moduleName = 'spec/fixtures/workers/port_echo'
+    const codeCachePath = path.join(app.getPath('temp'),
+                                    `worker-code-cache-${process.pid}`)
+
+    const startWorker = function (callback) {
+      workerBenchmark.startTime(moduleName, codeCachePath, callback)
+    }
+
+    skipUnlessWorkerStarts(moduleName)
+
+    after(function () {
+      if (fs.existsSync(codeCachePath)) fs.unlinkSync(codeCachePath)
+    })
+
+    it('saves the code cache and times starts with and without it', function (done) {
+      this.timeout(60000)
+      startWorker(function (error, cold) {
+        assert.equal(error, null)
+        assert.ok(fs.existsSync(codeCachePath))
+        startWorker(function (error, warm) {
+          assert.equal(error, null)
+          console.log(`worker start to first message: ${cold}ms without ` +
+                      `a code cache file, ${warm}ms with it`)
+          done()
+        })
+      })
+    })
+  })
+
+  describe('worker.postMessage(message, transferList)', function () {
+    const moduleName = 'spec/fixtures/workers/shared_counter'
+
+    skipUnlessWorkerStarts(moduleName)
+
+    it('shares SharedArrayBuffers and moves transferred ArrayBuffers', function (done) {
+      const iterations = 100000
+      workerBenchmark.sharedBuffer(moduleName, iterations, function (error, result) {
+        assert.equal(error, null)
+        assert.equal(result.counter, iterations * 2)
+        assert.equal(result.returnedCounter, iterations * 2)
+        assert.equal(result.first, 7)
+        assert.ok(result.neutered)
+        assert.equal(result.returnedLength, 1024 * 1024)
+        done()
+      })
+    })
+  })
+
+  describe('app.createWorkerPool(moduleName, options)', function () {
+    const moduleName = 'spec/fixtures/workers/pool_task'
+
+    skipUnlessWorkerStarts(moduleName)
+
+    afterEach(function (done) {
+      workerPool.stop(function () {
+        done()
+      })
+    })
+
+    it('emits start once all workers run', function (done) {
+      workerPool.start(moduleName, {size: 3}, function (error, result) {
+        assert.equal(error, null)
+        assert.equal(result.workerStarts, 3)
+        assert.equal(result.workerIds.length, 3)
+        assert.equal(result.stats.workers, 3)
+        assert.equal(result.stats.idleWorkers, 3)
+        assert.equal(result.stats.queued, 0)
+        assert.equal(result.stats.completed, 0)
+        done()
+      })
+    })
+
+    it('spreads tasks over the workers and lets idle workers steal them', function (done) {
+      const rest = [{id: 1, wait: 100}]
+      for (let id = 2; id < 10; id++) {
+        rest.push({id: id})
+      }
+      workerPool.start(moduleName, {size: 2}, function (error) {
+        assert.equal(error, null)
+        // The second worker is done with its own tasks long before the first
+        // one is, and takes the tasks queued on the first.
+        workerPool.run({id: 0, wait: 500}, rest, function (result) {
+          assert.ok(result.accepted.every((ok) => ok))
+          assert.deepEqual(result.answers.map((answer) => answer.id).sort((a, b) => a - b),
+                           [0, 1, 2, 3, 4, 5, 6, 7, 8, 9])
+          assert.equal(new Set(result.answers.map((answer) => answer.workerId)).size, 2)
+          assert.equal(result.stats.completed, 10)
+          assert.equal(result.stats.queued, 0)
+          assert.equal(result.stats.rejected, 0)
+          assert.ok(result.stats.stolen > 0)
+          done()
+        })
+      })
+    })
+
+    it('rejects tasks once maxQueueDepth tasks are queued', function (done) {
+      workerPool.start(moduleName, {size: 1, maxQueueDepth: 2}, function (error) {
+        assert.equal(error, null)
+        workerPool.run({id: 0, wait: 300}, [{id: 1}, {id: 2}, {id: 3}], function (result) {
+          assert.deepEqual(result.accepted, [true, true, true, false])
+          assert.deepEqual(result.answers.map((answer) => answer.id), [0, 1, 2])
+          assert.equal(result.stats.completed, 3)
+          assert.equal(result.stats.rejected, 1)
+          assert.equal(result.stats.stolen, 0)
+          done()
+        })
+      })
+    })
+
+    it('stops the workers and rejects later tasks', function (done) {
+      workerPool.start(moduleName, {size: 2}, function (error) {
+        assert.equal(error, null)
+        workerPool.stop(function (result) {
+          assert.equal(result.workerStops, 2)
+          assert.equal(result.accepted, false)
+          assert.equal(result.stats, null)
+          done()
+        })
+      })
+    })
+  })
+
+  describe('app.createMessageChannel', function () {
+    const moduleName = 'spec/fixtures/workers/port_echo'
+    const rounds = 1000
+
+    skipUnlessWorkerStarts(moduleName)
+
+    it('passes messages between a worker and the renderer', function (done) {
+      const payload = 'x'.repeat(256 * 1024)
+      ipcRenderer.once('worker-port', function (event, port) {
+        port.onmessage = function (e) {
+          if (e.data.pong === 0) {
+            assert.equal(e.data.payload, undefined)
+            // large messages go through shared memory
+            port.postMessage({ping: 1, payload: payload})
+          } else {
+            assert.equal(e.data.pong, 1)
+            assert.equal(e.data.payload, payload)
+            port.close()
+          }
+        }
+        port.onclose = function () {
+          done()
+        }
+        port.postMessage({ping: 0})
+      })
+      assert.notEqual(workerBenchmark.connect(remote.getCurrentWebContents()), -1)
+    })
+
+    it('times round trips through the main process and through a port', function (done) {
+      this.timeout(60000)
+      let start = Date.now()
+      let mainProcess = 0
+
+      const onMainProcessPong = function (event, data) {
+        if (data.pong + 1 < rounds) {
+          ipcRenderer.send('benchmark-worker-message', {ping: data.pong + 1})
+          return
+        }
+        ipcRenderer.removeListener('benchmark-worker-message', onMainProcessPong)
+        mainProcess = Date.now() - start
+
+        ipcRenderer.once('worker-port', function (event, port) {
+          start = Date.now()
+          port.onmessage = function (e) {
+            if (e.data.pong + 1 < rounds) {
+              port.postMessage({ping: e.data.pong + 1})
+              return
+            }
+            console.log(`${rounds} renderer/worker round trips: ` +
+                        `${mainProcess}ms through the main process, ` +
+                        `${Date.now() - start}ms through a port`)
+            port.close()
+            done()
+          }
+          port.postMessage({ping: 0})
+        })
+        workerBenchmark.connect(remote.getCurrentWebContents())
+      }
+      ipcRenderer.on('benchmark-worker-message', onMainProcessPong)
+      ipcRenderer.send('benchmark-worker-message', {ping: 0})
+    })
+
+    it('connects workers without going through the main process', function (done) {
+      this.timeout(60000)
+      workerBenchmark.channels(moduleName, rounds, function (results) {
+        assert.equal(results.error, undefined)
+        console.log(`${rounds} worker/worker round trips: ` +
+                    `${results.mainProcess}ms through the main process, ` +
+                    `${results.port}ms through a port`)
+        done()
+      })
+    })
+  })
 })
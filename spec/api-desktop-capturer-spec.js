@@ -1,7 +1,7 @@
 const assert = require('assert')
-const desktopCapturer = require('electron').desktopCapturer
+const {desktopCapturer, remote} = require('electron')
 
-const isCI = require('electron').remote.getGlobal('isCi')
+const isCI = remote.getGlobal('isCi')
 
 describe('desktopCapturer', function () {
   if (isCI && process.platform === 'win32') {
@@ -49,4 +49,20 @@ describe('desktopCapturer', function () {
     desktopCapturer.getSources({types: ['window']}, callback)
     desktopCapturer.getSources({types: ['screen']}, callback)
   })
+
+  it('reports the cost of the last refresh', function (done) {
+    const capturer = remote.require('electron').desktopCapturer
+    const keys = ['sources', 'captured', 'unchanged', 'cached', 'scaled',
+      'captureTime', 'hashTime', 'scaleTime', 'totalTime']
+    capturer.once('finished', function (sources, stats) {
+      assert.deepEqual(Object.keys(stats).sort(), keys.slice().sort())
+      keys.forEach(function (key) {
+        assert.equal(typeof stats[key], 'number')
+      })
+      assert.equal(stats.sources, sources.length)
+      assert.deepEqual(capturer.getRefreshStats(), stats)
+      done()
+    })
+    capturer.startHandling(false, true, {width: 150, height: 150})
+  })
 })
@@ -282,6 +282,111 @@ describe('ipc module', function () {
     })
   })
 
+  describe('remote prototype shapes', function () {
+    it('only describes a prototype once per renderer', function () {
+      var first = ipcRenderer.sendSync('ELECTRON_BROWSER_CURRENT_WEB_CONTENTS')
+      var second = ipcRenderer.sendSync('ELECTRON_BROWSER_CURRENT_WEB_CONTENTS')
+      assert.equal(typeof second.shapeId, 'number')
+      assert.equal(second.shapeId, first.shapeId)
+      assert.equal(second.proto, undefined)
+      assert.notEqual(ipcRenderer.sendSync('ELECTRON_BROWSER_SHAPE', second.shapeId), null)
+    })
+
+    it('uses the cached description for the members of later objects', function () {
+      var shapes = remote.require(path.join(fixtures, 'module', 'shapes.js'))
+      var first = shapes.create()
+      var second = shapes.create()
+      assert.equal(first.name(), 'shape')
+      assert.equal(second.name(), 'shape')
+      assert.equal(Object.getPrototypeOf(second).hasOwnProperty('name'), true)
+    })
+
+    it('describes a prototype again when members are added to it', function () {
+      var shapes = remote.require(path.join(fixtures, 'module', 'shapes.js'))
+      assert.equal(shapes.create().name(), 'shape')
+      shapes.addMethod('added', 'added')
+      var later = shapes.create()
+      assert.equal(later.name(), 'shape')
+      assert.equal(later.added(), 'added')
+    })
+
+    it('reports bytes and latency per remote call', function () {
+      var count = 100
+      var bytes = JSON.stringify(ipcRenderer.sendSync('ELECTRON_BROWSER_CURRENT_WINDOW')).length
+      var start = Date.now()
+      for (var i = 0; i < count; i++) {
+        assert.equal(typeof remote.getCurrentWindow().getTitle, 'function')
+      }
+      var elapsed = Date.now() - start
+      console.log('remote.getCurrentWindow(): ' + bytes + ' bytes, ' +
+                  (elapsed / count).toFixed(2) + 'ms per call')
+    })
+  })
+
+  describe('remote.batch', function () {
+    it('resolves a chain in one round trip', function () {
+      var url = remote.batch('currentWindow', function (win) {
+        return win.webContents.getURL()
+      })
+      assert.equal(url, remote.getCurrentWebContents().getURL())
+    })
+
+    it('returns several values and applies sets', function () {
+      var a = remote.require(path.join(fixtures, 'module', 'id.js'))
+      var results = remote.batch(a, function (object) {
+        object.batched = 'yes'
+        return [object.id, object.batched]
+      })
+      assert.deepEqual(results, [1127, 'yes'])
+    })
+
+    it('throws errors from the main process', function () {
+      assert.throws(function () {
+        remote.batch('currentWebContents', function (contents) {
+          return contents.notAFunction()
+        })
+      })
+    })
+
+    it('rejects values read in the batch as arguments', function () {
+      assert.throws(function () {
+        remote.batch('currentWindow', function (win) {
+          win.setTitle(win.webContents.getURL())
+        })
+      }, /can not be passed to it as arguments/)
+      assert.throws(function () {
+        remote.batch('currentWindow', function (win) {
+          win.title = [win.webContents]
+        })
+      }, /can not be passed to it as arguments/)
+    })
+
+    it('sends batchAsync calls together', function () {
+      var count = 100
+      var start = Date.now()
+      for (var i = 0; i < count; i++) {
+        remote.getCurrentWindow().webContents.getURL()
+      }
+      var syncTime = Date.now() - start
+
+      start = Date.now()
+      var batches = []
+      for (i = 0; i < count; i++) {
+        batches.push(remote.batchAsync('currentWindow', function (win) {
+          return win.webContents.getURL()
+        }))
+      }
+      return Promise.all(batches).then(function (urls) {
+        var asyncTime = Date.now() - start
+        assert.equal(urls.length, count)
+        assert.equal(urls[0], remote.getCurrentWebContents().getURL())
+        console.log('getURL() chain: ' + (syncTime / count).toFixed(2) +
+                    'ms per sync call, ' + (asyncTime / count).toFixed(2) +
+                    'ms per batched call')
+      })
+    })
+  })
+
   describe('remote class', function () {
     let cl = remote.require(path.join(fixtures, 'module', 'class.js'))
     let base = cl.base
@@ -461,6 +566,75 @@ describe('ipc module', function () {
     })
   })
 
+  describe('ipcRenderer.postMessage', function () {
+    it('sends structured clones both ways', function (done) {
+      var message = {
+        date: new Date(0),
+        map: new Map([['a', 1]]),
+        bytes: new Uint8Array([1, 2, 3])
+      }
+      ipcRenderer.once('post-message', function (event, value) {
+        assert.equal(value.date.getTime(), 0)
+        assert.equal(value.map.get('a'), 1)
+        assert.deepEqual(Array.from(value.bytes), [1, 2, 3])
+        done()
+      })
+      ipcRenderer.postMessage('post-message', message)
+    })
+
+    it('sends transferred ArrayBuffers beside the message', function (done) {
+      var buffer = new Float64Array([1.5, 2.5]).buffer
+      ipcRenderer.once('post-message', function (event, value) {
+        assert.deepEqual(Array.from(new Float64Array(value.buffer)), [1.5, 2.5])
+        done()
+      })
+      ipcRenderer.postMessage('post-message', {buffer: buffer}, [buffer])
+    })
+
+    it('rejects transfer lists that are not ArrayBuffers', function () {
+      assert.throws(function () {
+        ipcRenderer.postMessage('post-message', {}, [{}])
+      }, /transferList/)
+    })
+
+    it('can be replied by setting event.returnValue', function () {
+      var value = ipcRenderer.postMessageSync('post-message-sync', new Set([1]))
+      assert.ok(value.has(1))
+    })
+
+    it('returns undefined when the reply cannot be serialized', function () {
+      var value = ipcRenderer.postMessageSync('post-message-sync-unserializable')
+      assert.equal(value, undefined)
+    })
+
+    it('reports its throughput against sendSync for large payloads', function () {
+      var count = 20
+      var numbers = []
+      for (var i = 0; i < 256 * 1024; i++) {
+        numbers.push(i / 3)
+      }
+      var bytes = new Float64Array(numbers)
+      var megabytes = count * bytes.byteLength / (1024 * 1024)
+
+      var start = Date.now()
+      for (i = 0; i < count; i++) {
+        ipcRenderer.sendSync('echo', numbers)
+      }
+      var jsonTime = Math.max(Date.now() - start, 1)
+
+      start = Date.now()
+      for (i = 0; i < count; i++) {
+        ipcRenderer.postMessageSync('post-message-sync', bytes.buffer,
+                                    [bytes.buffer])
+      }
+      var serializedTime = Math.max(Date.now() - start, 1)
+
+      console.log('sendSync: ' + (megabytes * 1000 / jsonTime).toFixed(1) +
+                  'MB/s, postMessageSync: ' +
+                  (megabytes * 1000 / serializedTime).toFixed(1) + 'MB/s')
+    })
+  })
+
   describe('ipcRenderer.sendTo', function () {
     let contents = null
     beforeEach(function () {
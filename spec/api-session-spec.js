@@ -179,6 +179,58 @@ describe('session module', function () {
         })
       })
     })
+
+    it('should set and remove cookies in batches', function (done) {
+      const cookies = session.defaultSession.cookies
+      const cookieUrl = 'http://batch.example.com'
+      cookies.setMany([
+        {url: cookieUrl, name: 'batch1', value: '1'},
+        {url: 'http://sub.batch.example.com', name: 'batch2', value: '2'},
+        {url: '', name: 'batch3', value: '3'}
+      ], function (error, count, failed) {
+        assert.ok(error)
+        assert.equal(count, 2)
+        assert.deepEqual(failed, [2])
+        cookies.get({domain: ['batch.example.com']}, function (error, list) {
+          if (error) return done(error)
+          assert.deepEqual(list.map((cookie) => cookie.name).sort(), ['batch1', 'batch2'])
+          cookies.removeMany([
+            {url: cookieUrl, name: 'batch1'},
+            {url: cookieUrl, name: 'missing'}
+          ], function (error, removed) {
+            if (error) return done(error)
+            assert.equal(removed, 1)
+            cookies.removeMatching({domain: 'batch.example.com'}, function (error, removed) {
+              if (error) return done(error)
+              assert.equal(removed, 1)
+              cookies.get({domain: 'batch.example.com'}, function (error, list) {
+                if (error) return done(error)
+                assert.equal(list.length, 0)
+                done()
+              })
+            })
+          })
+        })
+      })
+    })
+
+    it('handles large cookie jars', function (done) {
+      this.timeout(120000)
+      // The cookie monster keeps at most 3300 cookies.
+      const sizes = [300, 1000, 3000]
+      const cookieBenchmark = remote.require(path.join(fixtures, 'module', 'cookie-benchmark.js'))
+      const run = function () {
+        if (sizes.length === 0) return done()
+        cookieBenchmark.run(sizes.shift(), function (error, result) {
+          if (error) return done(error)
+          assert.equal(result.set, result.jarSize)
+          assert.equal(result.removed, result.jarSize)
+          console.log(`cookies (${result.jarSize}): ${JSON.stringify(result.times)}`)
+          run()
+        })
+      }
+      run()
+    })
   })
 
   describe('ses.clearStorageData(options)', function () {
@@ -402,4 +454,127 @@ describe('session module', function () {
       })
     })
   })
+
+  describe('content settings rules', function () {
+    var server = null
+    var imageCount = 200
+
+    before(function (done) {
+      var logo = fs.readFileSync(path.join(fixtures, 'assets', 'logo.png'))
+      server = http.createServer(function (req, res) {
+        if (req.url === '/') {
+          var body = ''
+          for (var i = 0; i < imageCount; i++) {
+            body += '<img src="/image/' + i + '.png">'
+          }
+          body += '<script>window.onload = function () {' +
+            'var loaded = Array.prototype.filter.call(document.images, function (image) {' +
+            '  return image.naturalWidth > 0 }).length;' +
+            'require("electron").ipcRenderer.send("images-loaded", loaded) }</script>'
+          res.end(body)
+        } else {
+          res.setHeader('Content-Type', 'image/png')
+          res.end(logo)
+        }
+      })
+      server.listen(0, '127.0.0.1', done)
+    })
+
+    after(function () {
+      server.close()
+      session.defaultSession.userPrefs.setDictionaryPref('content_settings', {})
+    })
+
+    it('evaluates a large rule set for every image', function (done) {
+      // a typical profile has site rules for many hosts and a few defaults
+      var images = [{primaryPattern: '*', setting: 'allow'}]
+      for (var i = 0; i < 2000; i++) {
+        images.push({
+          primaryPattern: 'https://[*.]site' + i + '.example.com',
+          secondaryPattern: i % 2 ? '[firstParty]' : '*',
+          setting: i % 3 ? 'allow' : 'block'
+        })
+      }
+      images.push({
+        primaryPattern: '[*.]127.0.0.1',
+        secondaryPattern: '[firstParty]',
+        setting: 'allow'
+      })
+      session.defaultSession.userPrefs.setDictionaryPref('content_settings', {
+        images: images,
+        javascript: images
+      })
+
+      w.destroy()
+      w = new BrowserWindow({show: false})
+      var start = Date.now()
+      ipcMain.once('images-loaded', function (event, loaded) {
+        var elapsed = Date.now() - start
+        console.log('loaded ' + loaded + ' images with ' + images.length +
+                    ' rules in ' + elapsed + 'ms')
+        assert.equal(loaded, imageCount)
+        done()
+      })
+      w.loadURL('http://127.0.0.1:' + server.address().port)
+    })
+
+    it('applies rule changes to running renderers', function (done) {
+      var images = []
+      for (var i = 0; i < 100; i++) {
+        images.push({
+          primaryPattern: 'https://[*.]site' + i + '.example.com',
+          setting: 'allow'
+        })
+      }
+      var rule = {
+        primaryPattern: '[*.]127.0.0.1',
+        secondaryPattern: '[firstParty]',
+        setting: 'block'
+      }
+      var setImageRules = function () {
+        session.defaultSession.userPrefs.setDictionaryPref('content_settings', {
+          images: images.concat([rule])
+        })
+      }
+      setImageRules()
+
+      ipcMain.once('images-loaded', function (event, loaded) {
+        assert.equal(loaded, 0)
+        rule.setting = 'allow'
+        setImageRules()
+        ipcMain.once('images-loaded', function (event, loaded) {
+          assert.equal(loaded, imageCount)
+          done()
+        })
+        w.webContents.reload()
+      })
+      w.loadURL('http://127.0.0.1:' + server.address().port)
+    })
+
+    it('sends only the changed rules to running renderers', function (done) {
+      var rule = {
+        primaryPattern: '[*.]127.0.0.1',
+        secondaryPattern: '[firstParty]',
+        setting: 'block'
+      }
+      var setImageRules = function () {
+        session.defaultSession.userPrefs.setDictionaryPref('content_settings', {
+          images: [rule]
+        })
+      }
+      setImageRules()
+
+      ipcMain.once('images-loaded', function (event, loaded) {
+        assert.equal(loaded, 0)
+        var before = session.defaultSession.getContentSettingsUpdateStats()
+        rule.setting = 'allow'
+        setImageRules()
+        var after = session.defaultSession.getContentSettingsUpdateStats()
+        assert.ok(after.deltas > before.deltas)
+        assert.equal(after.fullUpdates, before.fullUpdates)
+        done()
+      })
+      w.loadURL('http://127.0.0.1:' + server.address().port)
+    })
+  })
 })
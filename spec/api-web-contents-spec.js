@@ -48,6 +48,24 @@ describe('webContents module', function () {
     })
   })
 
+  describe('fromTabID() API', function () {
+    it('returns the web contents of a tab', function () {
+      const tabId = w.webContents.getId()
+      assert.equal(webContents.fromTabID(tabId).getId(), tabId)
+      assert.equal(webContents.fromTabID(-12345), null)
+    })
+
+    it('finds tabs and reports lookup times at growing tab counts', function () {
+      this.timeout(60000)
+      const tabLookupBenchmark = remote.require(path.join(fixtures, 'module', 'tab-lookup-benchmark.js'))
+      const results = tabLookupBenchmark.run([1, 10, 40], 10000)
+      results.forEach(function (result) {
+        assert.ok(result.found)
+        console.log(`fromTabID with ${result.count} tabs: ${result.microseconds.toFixed(2)}us`)
+      })
+    })
+  })
+
   describe('getFocusedWebContents() API', function () {
     it('returns the focused web contents', function (done) {
       if (isCi) return done()
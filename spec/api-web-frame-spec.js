@@ -61,4 +61,27 @@ describe('webFrame module', function () {
       })
     })
   })
+
+  describe('webFrame.setSpellCheckProvider', function () {
+    var w = null
+
+    afterEach(function () {
+      return closeWindow(w).then(function () { w = null })
+    })
+
+    it('checks the unknown words of an edit in one spellCheckWords call', function (done) {
+      w = new BrowserWindow({show: false})
+      ipcMain.once('spell-check-words', function (event, calls) {
+        // The first edit is checked in one batch, and "can't" is not split
+        // into its parts since it is spelled correctly.
+        assert.equal(calls.length, 2)
+        assert.deepEqual(calls[0], ["can't", 'spell', 'wrogn'])
+        // The first answer arrived asynchronously and was cached, so only
+        // the new word of the second edit is checked.
+        assert.deepEqual(calls[1], ['again'])
+        done()
+      })
+      w.loadURL('file://' + path.join(fixtures, 'pages', 'spell-check-words.html'))
+    })
+  })
 })
@@ -85,6 +85,48 @@ describe('webRequest module', function () {
       })
     })
 
+    it('can filter URLs against a large pattern list', function (done) {
+      var urls = []
+      for (var i = 0; i < 5000; i++) {
+        urls.push('*://*.blocked' + i + '.example.com/*')
+        urls.push('https://ads' + i + '.example.org/path/*')
+      }
+      urls.push('*://*/*/large-filter/*')
+      ses.webRequest.onBeforeRequest({urls: urls}, function (details, callback) {
+        callback({
+          cancel: true
+        })
+      })
+      var requests = 50
+      var start = Date.now()
+      var next = function (remaining) {
+        if (remaining === 0) {
+          console.log('webRequest filter: ' + ((Date.now() - start) / requests).toFixed(2) + 'ms per request with ' + urls.length + ' patterns')
+          $.ajax({
+            url: defaultURL + 'a/large-filter/test',
+            success: function () {
+              done('unexpected success')
+            },
+            error: function () {
+              done()
+            }
+          })
+          return
+        }
+        $.ajax({
+          url: defaultURL + 'nofilter/' + remaining,
+          success: function (data) {
+            assert.equal(data, '/nofilter/' + remaining)
+            next(remaining - 1)
+          },
+          error: function (xhr, errorType) {
+            done(errorType)
+          }
+        })
+      }
+      next(requests)
+    })
+
     it('receives details object', function (done) {
       ses.webRequest.onBeforeRequest(function (details, callback) {
         assert.equal(typeof details.id, 'number')
@@ -156,6 +198,71 @@ describe('webRequest module', function () {
     })
   })
 
+  describe('webRequest.setRules', function () {
+    afterEach(function () {
+      ses.webRequest.setRules(null)
+      ses.webRequest.onBeforeRequest(null)
+      ses.webRequest.onBeforeSendHeaders(null)
+    })
+
+    it('can cancel the request without calling the listener', function (done) {
+      ses.webRequest.setRules([{id: 'block', urls: [defaultURL + 'rules/*'], cancel: true}])
+      ses.webRequest.onBeforeRequest(function (details, callback) {
+        assert.notEqual(details.url, defaultURL + 'rules/test')
+        callback({})
+      })
+      $.ajax({
+        url: defaultURL + 'rules/test',
+        success: function () {
+          done('unexpected success')
+        },
+        error: function () {
+          ses.webRequest.getRuleHitCounts(function (hits) {
+            assert.equal(hits.block, 1)
+            done()
+          })
+        }
+      })
+    })
+
+    it('can redirect the request', function (done) {
+      ses.webRequest.setRules([{id: 'redirect', urls: [defaultURL + 'rules/*'], redirectURL: defaultURL + 'redirected'}])
+      $.ajax({
+        url: defaultURL + 'rules/test',
+        success: function (data) {
+          assert.equal(data, '/redirected')
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('rejects rules with invalid urls', function () {
+      assert.throws(function () {
+        ses.webRequest.setRules([{id: 'typo', urls: ['not a pattern'], cancel: true}])
+      }, /Must pass null or an Array of rules/)
+      assert.throws(function () {
+        ses.webRequest.setRules([{id: 'typo', urls: 'http://*/*', cancel: true}])
+      }, /Must pass null or an Array of rules/)
+    })
+
+    it('can set request headers', function (done) {
+      ses.webRequest.setRules([{id: 'header', requestHeaders: {Accept: '*/*;test/header'}}])
+      $.ajax({
+        url: defaultURL,
+        success: function (data) {
+          assert.equal(data, '/header/received')
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+  })
+
   describe('webRequest.onBeforeSendHeaders', function () {
     afterEach(function () {
       ses.webRequest.onBeforeSendHeaders(null)
@@ -409,6 +516,73 @@ describe('webRequest module', function () {
     })
   })
 
+  describe('webRequest filter options', function () {
+    afterEach(function () {
+      ses.webRequest.onCompleted(null)
+      ses.webRequest.onBeforeRequest(null)
+    })
+
+    it('only computes the requested fields', function (done) {
+      ses.webRequest.onBeforeRequest({fields: ['url']}, function (details, callback) {
+        assert.deepEqual(Object.keys(details), ['url'])
+        callback({})
+      })
+      $.ajax({
+        url: defaultURL,
+        success: function () {
+          done()
+        },
+        error: function (xhr, errorType) {
+          done(errorType)
+        }
+      })
+    })
+
+    it('throws for unknown fields', function () {
+      assert.throws(function () {
+        ses.webRequest.onCompleted({fields: ['notAField']}, function () {})
+      }, /Unknown field/)
+    })
+
+    it('delivers simple events in batches', function (done) {
+      var count = 3
+      var received = 0
+      var statusCodes = []
+      // The interval never elapses during the test, the batch is flushed
+      // when the listener is removed after all requests completed.
+      ses.webRequest.onCompleted({
+        urls: [defaultURL + 'batch/*'],
+        fields: ['url', 'statusCode'],
+        batchInterval: 60000
+      }, function (batch) {
+        assert.equal(batch.url.length, batch.length)
+        assert.equal(batch.statusCode.length, batch.length)
+        assert.equal(batch.method, undefined)
+        received += batch.length
+        statusCodes = statusCodes.concat(batch.statusCode)
+        if (received === count) {
+          assert.deepEqual(statusCodes, [200, 200, 200])
+          done()
+        }
+      })
+
+      var completed = 0
+      for (var i = 0; i < count; i++) {
+        $.ajax({
+          url: defaultURL + 'batch/' + i,
+          success: function () {
+            if (++completed === count) {
+              ses.webRequest.onCompleted(null)
+            }
+          },
+          error: function (xhr, errorType) {
+            done(errorType)
+          }
+        })
+      }
+    })
+  })
+
   describe('webRequest.onCompleted', function () {
     afterEach(function () {
       ses.webRequest.onCompleted(null)
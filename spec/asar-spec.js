@@ -688,6 +688,122 @@ describe('asar package', function () {
       })
     })
 
+    describe('compressed entries', function () {
+      var asar = process.binding('atom_common_asar')
+      var archivePath = path.join(fixtures, 'asar', 'compressed.asar')
+
+      it('inflates files read with fs', function (done) {
+        var raw = fs.readFileSync(path.join(archivePath, 'text-raw.txt'), 'utf8')
+        assert.equal(fs.readFileSync(path.join(archivePath, 'text.txt'), 'utf8'), raw)
+        assert.equal(fs.readFileSync(path.join(archivePath, 'index.html')).toString(), '<html><body>compressed</body></html>\n')
+        assert.equal(fs.readFileSync(path.join(archivePath, 'empty.txt')).length, 0)
+        assert.equal(fs.readFileSync(path.join(archivePath, 'plain.txt'), 'utf8'), 'plain\n')
+        fs.readFile(path.join(archivePath, 'text.txt'), 'utf8', function (error, content) {
+          assert.equal(error, null)
+          assert.equal(content, raw)
+          done()
+        })
+      })
+
+      it('reports the inflated size', function () {
+        var stats = fs.statSync(path.join(archivePath, 'text.txt'))
+        assert.equal(stats.size, 131076)
+        var archive = asar.createArchive(archivePath)
+        var info = archive.getFileInfo('text.txt')
+        assert.equal(info.compressed, true)
+        assert.equal(info.size, 131076)
+        assert.equal(archive.getFileInfo('plain.txt').compressed, false)
+        archive.destroy()
+      })
+
+      it('inflates files copied out of the archive', function () {
+        var archive = asar.createArchive(archivePath)
+        var copied = archive.copyFileOut('index.html')
+        assert.equal(fs.readFileSync(copied, 'utf8'), '<html><body>compressed</body></html>\n')
+        archive.destroy()
+      })
+
+      it('times inflating apart from reading the archive', function () {
+        var iterations = 200
+        var archive = asar.createArchive(archivePath)
+        var time = function (file) {
+          var start = process.hrtime()
+          for (var i = 0; i < iterations; i++) {
+            archive.readFile(file)
+          }
+          var elapsed = process.hrtime(start)
+          return (elapsed[0] * 1e3 + elapsed[1] / 1e6) / iterations
+        }
+        // The first reads fault the pages of the mapping in, the timed ones
+        // only differ in copying or inflating the entry.
+        assert.ok(archive.readFile('text.txt').equals(archive.readFile('text-raw.txt')))
+        var raw = time('text-raw.txt')
+        var compressed = time('text.txt')
+        var info = archive.getFileInfo('text.txt')
+        archive.destroy()
+        assert.ok(info.compressedSize < info.size)
+        console.log(`asar compression: ${info.size} bytes stored in ${info.compressedSize}, ` +
+                    `${raw.toFixed(3)}ms to copy the raw entry, ` +
+                    `${compressed.toFixed(3)}ms to inflate, from a warm mapping`)
+      })
+    })
+
+    describe('archive lookups', function () {
+      var asar = process.binding('atom_common_asar')
+
+      it('resolves paths through linked directories', function () {
+        var archive = asar.createArchive(path.join(fixtures, 'asar', 'a.asar'))
+        var file1 = archive.getFileInfo('file1')
+        assert.deepEqual(archive.getFileInfo('link2/link2/file1'), archive.getFileInfo(path.join('dir1', 'file1')))
+        assert.deepEqual(archive.getFileInfo('dir1/link1'), file1)
+        assert.deepEqual(archive.readdir('link2'), ['file1', 'file2', 'file3', 'link1', 'link2'])
+        assert.equal(archive.realpath('dir1/link2'), 'dir1')
+        assert.equal(archive.getFileInfo('dir1/file4'), false)
+        assert.equal(archive.getFileInfo('dir1'), false)
+        archive.destroy()
+      })
+
+      it('reads packed files from the archive mapping', function () {
+        var archive = asar.createArchive(path.join(fixtures, 'asar', 'a.asar'))
+        assert.equal(archive.readFile('link2/file1').toString().trim(), 'file1')
+        assert.equal(archive.readFileUtf8('file2').trim(), 'file2')
+        assert.equal(archive.readFile('not-exist'), false)
+        archive.destroy()
+      })
+
+      it('shares archives through the process cache', function () {
+        var p = path.join(fixtures, 'asar', 'logo.asar')
+        asar.invalidateArchive(p)
+        var before = asar.getArchiveCacheStats()
+        var archive1 = asar.createArchive(p)
+        var archive2 = asar.createArchive(p)
+        var after = asar.getArchiveCacheStats()
+        assert.equal(after.misses - before.misses, 1)
+        assert.equal(after.hits - before.hits, 1)
+        assert.equal(asar.invalidateArchive(p), true)
+        assert.equal(asar.invalidateArchive(p), false)
+        assert.equal(asar.getArchiveCacheStats().invalidations - after.invalidations, 1)
+        archive1.destroy()
+        archive2.destroy()
+      })
+
+      it('looks up entries quickly', function () {
+        var archive = asar.createArchive(path.join(fixtures, 'asar', 'a.asar'))
+        var paths = ['file1', 'dir1/file2', 'dir3/file3', 'link2/file1', 'link2/link2/file1', 'dir1/link1', 'not-exist']
+        var iterations = 20000
+        var start = process.hrtime()
+        for (var i = 0; i < iterations; i++) {
+          for (var j = 0; j < paths.length; j++) {
+            archive.stat(paths[j])
+          }
+        }
+        var elapsed = process.hrtime(start)
+        var nsPerLookup = (elapsed[0] * 1e9 + elapsed[1]) / (iterations * paths.length)
+        console.log('asar lookup: ' + nsPerLookup.toFixed(0) + 'ns per stat')
+        archive.destroy()
+      })
+    })
+
     describe('process.noAsar', function () {
       var errorName = process.platform === 'win32' ? 'ENOENT' : 'ENOTDIR'
 
@@ -766,6 +882,56 @@ describe('asar package', function () {
       })
     })
 
+    it('can request a range of a file in package', function (done) {
+      var p = path.resolve(fixtures, 'asar', 'a.asar', 'dir1', 'file2')
+      $.ajax({
+        url: 'file://' + p,
+        headers: {Range: 'bytes=1-3'},
+        success: function (data) {
+          assert.equal(data, 'ile')
+          done()
+        }
+      })
+    })
+
+    it('serves packed files from the archive mapping', function (done) {
+      this.timeout(30000)
+      var getArchiveCacheStats = require('electron').remote.require(path.join(fixtures, 'module', 'asar-cache-stats.js'))
+      var files = ['file1', 'file2', 'file3', 'dir1/file1', 'dir2/file2', 'dir3/file3']
+      var count = 200
+      var before = getArchiveCacheStats()
+      var start = performance.now()
+      var next = function (i) {
+        if (i === count) {
+          var elapsed = performance.now() - start
+          var after = getArchiveCacheStats()
+          var mapped = after.mappedRequests - before.mappedRequests
+          var streamed = after.streamedRequests - before.streamedRequests
+          assert.equal(mapped, count)
+          assert.equal(streamed, 0)
+          console.log(`asar protocol: ${(elapsed / count).toFixed(3)}ms per request, ` +
+                      `${mapped} mapped, ${streamed} streamed, ` +
+                      `archive cache ${after.hits - before.hits} hits ${after.misses - before.misses} misses`)
+          return done()
+        }
+        var file = files[i % files.length]
+        var p = path.resolve(fixtures, 'asar', 'a.asar', file)
+        $.get('file://' + p, function (data) {
+          assert.equal(data.trim(), path.basename(file))
+          next(i + 1)
+        })
+      }
+      next(0)
+    })
+
+    it('can request a compressed file in package', function (done) {
+      var p = path.resolve(fixtures, 'asar', 'compressed.asar', 'index.html')
+      $.get('file://' + p, function (data) {
+        assert.equal(data.trim(), '<html><body>compressed</body></html>')
+        done()
+      })
+    })
+
     it('can request a file in package with unpacked files', function (done) {
       var p = path.resolve(fixtures, 'asar', 'unpack.asar', 'a.txt')
       $.get('file://' + p, function (data) {
@@ -0,0 +1,5 @@
+// Returns the stats of the asar archive cache of the main process, which
+// serves the asar protocol.
+module.exports = function () {
+  return process.binding('atom_common_asar').getArchiveCacheStats()
+}
@@ -0,0 +1,47 @@
+const {session} = require('electron')
+
+// Fills a cookie jar of |jarSize| cookies, then reads and removes them,
+// and calls |callback| with the counts and the time of each step.
+exports.run = function (jarSize, callback) {
+  const cookies = session.fromPartition('cookie-benchmark').cookies
+  const domains = []
+  const details = []
+  for (let i = 0; i < jarSize; i++) {
+    const domain = `site${i % Math.max(1, jarSize / 10)}.test`
+    if (domains.length < 10 && !domains.includes(domain)) domains.push(domain)
+    details.push({url: `http://${domain}`, name: `cookie${i}`, value: String(i)})
+  }
+  const times = {}
+  let start = null
+  const mark = function (name) {
+    if (start) {
+      const diff = process.hrtime(start)
+      times[name] = diff[0] * 1e3 + diff[1] / 1e6
+    }
+    start = process.hrtime()
+  }
+
+  mark()
+  cookies.setMany(details, function (error, count) {
+    mark('setMany')
+    if (error) return callback(error.message)
+    cookies.get({domain: domains[0]}, function (error, list) {
+      mark('getDomain')
+      if (error) return callback(error.message)
+      cookies.removeMatching({domain: domains}, function (error, removed) {
+        mark('removeMatching')
+        if (error) return callback(error.message)
+        cookies.removeMatching({}, function (error, rest) {
+          mark('removeAll')
+          callback(error ? error.message : null, {
+            jarSize: jarSize,
+            set: count,
+            found: list.length,
+            removed: removed + rest,
+            times: times
+          })
+        })
+      })
+    })
+  })
+}
@@ -0,0 +1,30 @@
+// Emits events on a guest in one tick of the main process, as if the guest
+// had emitted them, and records the messages sent to its embedder.
+let embedder = null
+let sent = []
+
+exports.record = function (webContents) {
+  embedder = webContents
+  sent = []
+  embedder.send = function (...args) {
+    sent.push(args)
+    return Object.getPrototypeOf(embedder).send.apply(embedder, args)
+  }
+}
+
+// Emits each [name, ...args] of |events| on |guest| and returns the messages
+// sent to the embedder so far.
+exports.emit = function (guest, events) {
+  events.forEach(function ([name, ...args]) {
+    guest.emit(name, {}, ...args)
+  })
+  return sent
+}
+
+exports.stop = function () {
+  if (embedder) {
+    delete embedder.send
+    embedder = null
+  }
+  return sent
+}
@@ -0,0 +1,19 @@
+'use strict'
+
+// Objects sharing one prototype.
+class Shape {
+  name () {
+    return 'shape'
+  }
+}
+
+exports.create = function () {
+  return new Shape()
+}
+
+// Adds a method returning |value| to the prototype.
+exports.addMethod = function (name, value) {
+  Shape.prototype[name] = function () {
+    return value
+  }
+}
@@ -0,0 +1,29 @@
+const {BrowserWindow, webContents} = require('electron')
+
+// Times webContents.fromTabID with |counts| windows open, |lookups| times
+// each, and returns the lookup time per count.
+exports.run = function (counts, lookups) {
+  const windows = []
+  const results = []
+  for (const count of counts) {
+    while (windows.length < count) {
+      windows.push(new BrowserWindow({show: false}))
+    }
+    const tabIds = windows.map((w) => w.webContents.getId())
+    let found = true
+    const start = process.hrtime()
+    for (let i = 0; i < lookups; i++) {
+      const tabId = tabIds[i % tabIds.length]
+      const contents = webContents.fromTabID(tabId)
+      found = found && contents != null && contents.getId() === tabId
+    }
+    const diff = process.hrtime(start)
+    results.push({
+      count: count,
+      found: found,
+      microseconds: (diff[0] * 1e6 + diff[1] / 1e3) / lookups
+    })
+  }
+  windows.forEach((w) => w.destroy())
+  return results
+}
@@ -0,0 +1,65 @@
+const fs = require('fs')
+const net = require('net')
+
+// Measures fs and net callback latency in the main process while
+// `concurrency` other fs and net loops keep libuv busy, and calls |callback|
+// with the average latencies.
+exports.run = function (rounds, concurrency, callback) {
+  const latencies = {fs: [], net: []}
+  const elapsed = function (start) {
+    const diff = process.hrtime(start)
+    return diff[0] * 1e3 + diff[1] / 1e6
+  }
+  const average = function (values) {
+    return values.reduce((sum, value) => sum + value, 0) / values.length
+  }
+
+  const server = net.createServer(function (socket) {
+    socket.pipe(socket)
+  })
+  let running = 0
+  const loopDone = function () {
+    if (--running > 0) return
+    server.close()
+    callback({
+      // The switch is only used on Linux.
+      pollOnMainThread: process.platform === 'linux' &&
+                        process.argv.includes('--uv-poll-on-main-thread'),
+      fs: average(latencies.fs),
+      net: average(latencies.net)
+    })
+  }
+
+  const statLoop = function (remaining) {
+    if (remaining === 0) return loopDone()
+    const start = process.hrtime()
+    fs.stat(__filename, function () {
+      latencies.fs.push(elapsed(start))
+      statLoop(remaining - 1)
+    })
+  }
+  const echoLoop = function (port) {
+    const socket = net.connect(port, '127.0.0.1')
+    let remaining = rounds
+    let start = null
+    const ping = function () {
+      start = process.hrtime()
+      socket.write('x')
+    }
+    socket.on('connect', ping)
+    socket.on('data', function () {
+      latencies.net.push(elapsed(start))
+      if (--remaining > 0) return ping()
+      socket.end()
+      loopDone()
+    })
+  }
+
+  server.listen(0, '127.0.0.1', function () {
+    for (let i = 0; i < concurrency; i++) {
+      running += 2
+      statLoop(rounds)
+      echoLoop(server.address().port)
+    }
+  })
+}
@@ -0,0 +1,146 @@
+// Drives the worker specs from the main process. Messages between the
+// renderer and a started worker go through the main process unless they use
+// a port.
+const {app, ipcMain} = require('electron')
+
+let worker = null
+
+const relayToWorker = function (event, message) {
+  worker.postMessage(message)
+}
+
+// Starts a worker running |moduleName| whose messages are sent to
+// |webContents|, and calls |callback| with its start error, if any.
+exports.start = function (moduleName, webContents, callback) {
+  const started = app.createWorker(moduleName)
+  let error = null
+  started.onerror = function (message) {
+    error = error || message
+  }
+  started.on('message', function (e) {
+    webContents.send('benchmark-worker-message', e.data)
+  })
+  started.start(function () {
+    if (error) {
+      started.terminate()
+    } else {
+      worker = started
+      ipcMain.on('benchmark-worker-message', relayToWorker)
+    }
+    callback(error)
+  })
+}
+
+// Connects the started worker to |webContents| with a port.
+exports.connect = function (webContents) {
+  return app.createMessageChannel(worker, webContents)
+}
+
+exports.stop = function () {
+  if (!worker) return
+  ipcMain.removeListener('benchmark-worker-message', relayToWorker)
+  worker.terminate()
+  worker = null
+}
+
+// Times how long a worker takes from start() to answering its first
+// message, and calls |callback| with the start error or the elapsed time.
+exports.startTime = function (moduleName, codeCachePath, callback) {
+  const start = Date.now()
+  const worker = app.createWorker(moduleName, {codeCachePath: codeCachePath})
+  let error = null
+  worker.onerror = function (message) {
+    error = error || message
+  }
+  worker.once('message', function () {
+    const elapsed = Date.now() - start
+    worker.terminate()
+    callback(null, elapsed)
+  })
+  worker.start(function () {
+    if (error) {
+      worker.terminate()
+      callback(error)
+    }
+  })
+  worker.postMessage({ping: 0})
+}
+
+// Times round trips between two workers relayed by the main process, then
+// through a port connecting them.
+exports.channels = function (moduleName, rounds, callback) {
+  const workers = [app.createWorker(moduleName), app.createWorker(moduleName)]
+  const results = {}
+  let started = 0
+  let channel = -1
+
+  const finish = function () {
+    app.closeMessageChannel(channel)
+    workers.forEach((worker) => worker.terminate())
+    callback(results)
+  }
+
+  workers[0].on('message', function (e) {
+    if (!('elapsed' in e.data)) {
+      workers[1].postMessage(e.data)
+    } else if (!('mainProcess' in results)) {
+      results.mainProcess = e.data.elapsed
+      channel = app.createMessageChannel(workers[0], workers[1])
+      workers[0].postMessage({command: 'start', rounds: rounds, port: true})
+    } else {
+      results.port = e.data.elapsed
+      finish()
+    }
+  })
+  workers[1].on('message', function (e) {
+    workers[0].postMessage(e.data)
+  })
+  workers.forEach(function (worker) {
+    worker.onerror = function (message) {
+      results.error = results.error || message
+    }
+    worker.start(function () {
+      if (++started < workers.length) return
+      if (results.error) return finish()
+      workers[0].postMessage({command: 'start', rounds: rounds})
+    })
+  })
+}
+
+// Shares a counter with a worker and moves a buffer there and back, then
+// calls |callback| with the start error or what the worker saw.
+exports.sharedBuffer = function (moduleName, iterations, callback) {
+  const worker = app.createWorker(moduleName)
+  const counters = new Int32Array(new SharedArrayBuffer(4))
+  const transferred = new ArrayBuffer(1024 * 1024)
+  new Uint8Array(transferred)[0] = 7
+  let error = null
+  worker.onerror = function (message) {
+    error = error || message
+  }
+  worker.once('message', function (e) {
+    worker.terminate()
+    callback(null, {
+      counter: Atomics.load(counters, 0),
+      returnedCounter: Atomics.load(new Int32Array(e.data.shared), 0),
+      first: e.data.first,
+      neutered: transferred.byteLength === 0,
+      returnedLength: e.data.transferred.byteLength
+    })
+  })
+  worker.start(function () {
+    if (error) {
+      worker.terminate()
+      return callback(error)
+    }
+    worker.postMessage({
+      shared: counters.buffer,
+      transferred: transferred,
+      iterations: iterations
+    }, [transferred])
+    // The worker counts at the same time
+    for (let i = 0; i < iterations; i++) {
+      Atomics.add(counters, 0, 1)
+    }
+  })
+}
@@ -0,0 +1,83 @@
+// Drives the worker pool specs from the main process.
+const {app} = require('electron')
+
+let pool = null
+
+// Calls |callback| with the stats of the pool once |predicate| holds for
+// them.
+const whenStats = function (predicate, callback) {
+  const stats = pool.getStats()
+  if (predicate(stats)) {
+    callback(stats)
+  } else {
+    setTimeout(whenStats, 10, predicate, callback)
+  }
+}
+
+// Starts a pool running |moduleName| and calls |callback| with the start
+// error, if any, or with what the pool reported once all of its workers are
+// waiting for messages.
+exports.start = function (moduleName, options, callback) {
+  const started = app.createWorkerPool(moduleName, options)
+  let error = null
+  let workerStarts = 0
+  started.onerror = function (message) {
+    error = error || message
+  }
+  started.on('worker-start', function () {
+    workerStarts++
+  })
+  started.start(function () {
+    if (error) {
+      started.terminate()
+      return callback(error)
+    }
+    pool = started
+    whenStats((stats) => stats.idleWorkers === stats.workers, function (stats) {
+      callback(null, {
+        workerStarts: workerStarts,
+        workerIds: pool.workerIds,
+        stats: stats
+      })
+    })
+  })
+}
+
+// Posts |first| and, once a worker runs it, each of |rest|. Calls |callback|
+// with whether each task was accepted, the answers and the stats once all
+// accepted tasks are done.
+exports.run = function (first, rest, callback) {
+  const accepted = [pool.postMessage(first)]
+  const answers = []
+
+  const onMessage = function (e) {
+    answers.push({id: e.data.id, workerId: e.workerId})
+    if (answers.length < accepted.filter((ok) => ok).length) return
+    pool.removeListener('message', onMessage)
+    whenStats((stats) => stats.running === 0, function (stats) {
+      callback({accepted: accepted, answers: answers, stats: stats})
+    })
+  }
+  pool.on('message', onMessage)
+
+  whenStats((stats) => stats.running === 1, function () {
+    rest.forEach((task) => accepted.push(pool.postMessage(task)))
+  })
+}
+
+// Terminates the pool and calls |callback| with what it answers right after
+// and the number of workers that stopped.
+exports.stop = function (callback) {
+  if (!pool) return callback(null)
+  const stopping = pool
+  const result = {workerStops: 0}
+  pool = null
+  stopping.on('worker-stop', function () {
+    if (++result.workerStops === stopping.workerIds.length) {
+      callback(result)
+    }
+  })
+  stopping.terminate()
+  result.accepted = stopping.postMessage({id: 0})
+  result.stats = stopping.getStats()
+}
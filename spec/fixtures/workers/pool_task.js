@@ -0,0 +1,6 @@
+// Busy waits for `wait` milliseconds, then answers with the id of the task.
+onmessage = function (event) {
+  var end = Date.now() + (event.data.wait || 0)
+  while (Date.now() < end) {}
+  postMessage({id: event.data.id})
+}
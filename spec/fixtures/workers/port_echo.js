@@ -0,0 +1,48 @@
+// Answers every {ping} with a {pong}, either on the port it came from or
+// through the main process. When told to start it times `rounds` round
+// trips with the other end.
+var rounds = 0
+var start = 0
+
+function handle (data, reply) {
+  if ('ping' in data) {
+    reply({pong: data.ping, payload: data.payload})
+  } else if ('pong' in data) {
+    if (data.pong + 1 < rounds) {
+      reply({ping: data.pong + 1})
+    } else {
+      postMessage({elapsed: Date.now() - start, rounds: rounds})
+    }
+  }
+}
+
+function replyToMain (message) {
+  postMessage(message)
+}
+
+var ports = []
+
+onconnect = function (event) {
+  var port = event.ports[0]
+  ports.push(port)
+  port.onmessage = function (e) {
+    handle(e.data, function (message) {
+      port.postMessage(message)
+    })
+  }
+}
+
+onmessage = function (event) {
+  var data = event.data
+  if (data.command === 'start') {
+    rounds = data.rounds
+    start = Date.now()
+    if (data.port) {
+      ports[ports.length - 1].postMessage({ping: 0})
+    } else {
+      replyToMain({ping: 0})
+    }
+    return
+  }
+  handle(data, replyToMain)
+}
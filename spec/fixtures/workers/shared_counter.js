@@ -0,0 +1,15 @@
+// Counts up in the SharedArrayBuffer it is sent and moves the transferred
+// ArrayBuffer back to the main process.
+onmessage = function (event) {
+  var data = event.data
+  var counters = new Int32Array(data.shared)
+  for (var i = 0; i < data.iterations; i++) {
+    Atomics.add(counters, 0, 1)
+  }
+  var bytes = new Uint8Array(data.transferred)
+  postMessage({
+    shared: data.shared,
+    transferred: data.transferred,
+    first: bytes[0]
+  }, [data.transferred])
+}
@@ -173,6 +173,24 @@ describe('node feature', function () {
         })
       })
     })
+
+    describe('in the main process', function () {
+      it('dispatches fs and net callbacks under load', function (done) {
+        this.timeout(60000)
+        const uvLatencyBenchmark = remote.require(path.join(fixtures, 'module', 'uv-latency-benchmark.js'))
+        // Compare by running the specs with and without
+        // --uv-poll-on-main-thread on Linux.
+        uvLatencyBenchmark.run(2000, 16, function (result) {
+          assert.ok(result.fs > 0)
+          assert.ok(result.net > 0)
+          const mode = result.pollOnMainThread ? 'on the main thread'
+                                               : 'on the embed thread'
+          console.log(`libuv polled ${mode}: ${result.fs.toFixed(3)}ms per ` +
+                      `fs.stat, ${result.net.toFixed(3)}ms per tcp round trip`)
+          done()
+        })
+      })
+    })
   })
 
   describe('net.connect', function () {
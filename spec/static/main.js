@@ -70,6 +70,22 @@ ipcMain.on('echo', function (event, msg) {
   event.returnValue = msg
 })
 
+ipcMain.on('post-message', function (event, message) {
+  event.sender.postMessage('post-message', message)
+})
+
+ipcMain.on('post-message-sync', function (event, message) {
+  event.returnValue = message
+})
+
+ipcMain.on('post-message-sync-unserializable', function (event) {
+  try {
+    event.returnValue = function () {}
+  } catch (error) {
+    // functions can't be serialized, the renderer gets undefined
+  }
+})
+
 const coverage = new Coverage({
   outputPath: path.join(__dirname, '..', '..', 'out', 'coverage')
 })
@@ -2,7 +2,8 @@ const assert = require('assert')
 const path = require('path')
 const http = require('http')
 const url = require('url')
-const {app, session, ipcMain, BrowserWindow} = require('electron').remote
+const {remote} = require('electron')
+const {app, session, ipcMain, BrowserWindow} = remote
 
 describe('<webview> tag', function () {
   this.timeout(20000)
@@ -871,6 +872,32 @@ describe('<webview> tag', function () {
       setUpRequestHandler(webview, 'openExternal', done)
       document.body.appendChild(webview)
     })
+
+    it('reuses cached decisions', function (done) {
+      const ses = session.fromPartition('permissionCacheTest')
+      let requests = 0
+      let messages = 0
+      ses.setPermissionCacheTTL(60000)
+      ses.setPermissionRequestHandler(function (webContents, permission, callback) {
+        requests++
+        callback(false)
+      })
+      webview.addEventListener('ipc-message', function (e) {
+        if (++messages < 2) return
+        const stats = ses.getPermissionCacheStats()
+        assert.equal(requests, 1)
+        assert.ok(stats.hits >= 1)
+        assert.equal(stats.size, 1)
+        ses.clearPermissionCache()
+        assert.equal(ses.getPermissionCacheStats().size, 0)
+        ses.setPermissionCacheTTL(0)
+        done()
+      })
+      webview.src = 'file://' + fixtures + '/pages/permissions/geolocation-twice.html'
+      webview.partition = 'permissionCacheTest'
+      webview.setAttribute('nodeintegration', 'on')
+      document.body.appendChild(webview)
+    })
   })
 
   describe('<webview>.getWebContents', function () {
@@ -915,6 +942,135 @@ describe('<webview> tag', function () {
     })
   })
 
+  describe('<webview>.setEventFilter', function () {
+    it('only fires the events in the filter', function (done) {
+      var loads = 0
+      webview.addEventListener('did-get-response-details', function () {
+        if (loads > 0) {
+          done(new Error('did-get-response-details should be filtered'))
+        }
+      })
+      webview.addEventListener('did-finish-load', function () {
+        loads++
+        if (loads === 1) {
+          webview.setEventFilter(['did-finish-load'])
+          webview.reload()
+        } else {
+          webview.setEventFilter(null)
+          done()
+        }
+      })
+      webview.src = 'file://' + path.join(fixtures, 'pages', 'did-get-response-details.html')
+      document.body.appendChild(webview)
+    })
+  })
+
+  describe('guest event batching', function () {
+    const guestEvents = remote.require(path.join(fixtures, 'module', 'guest-events.js'))
+    const dispatchChannel = 'ELECTRON_GUEST_VIEW_INTERNAL_DISPATCH_EVENTS'
+    const ipcChannel = 'ELECTRON_GUEST_VIEW_INTERNAL_IPC_MESSAGE-'
+
+    // The messages sent to the embedder for the events the specs emitted,
+    // without the ones of loading the page.
+    const sentEvents = function (messages) {
+      return messages.map(function ([channel, events]) {
+        if (channel !== dispatchChannel) return [channel]
+        return [channel].concat(events.filter(function ([tabId, name, args]) {
+          return tabId === webview.getId() && /batch-/.test(JSON.stringify(args))
+        }).map(([tabId, name, args]) => [name].concat(args)))
+      }).filter(function (message) {
+        return message[0] === ipcChannel + webview.getId() ||
+               (message[0] === dispatchChannel && message.length > 1)
+      })
+    }
+
+    const load = function (callback) {
+      webview.addEventListener('did-finish-load', function () {
+        guestEvents.record(remote.getCurrentWebContents())
+        callback(webview.getWebContents())
+      })
+      webview.src = 'about:blank'
+      document.body.appendChild(webview)
+    }
+
+    afterEach(function () {
+      guestEvents.stop()
+    })
+
+    it('sends only the last of superseded events, in one message', function (done) {
+      const received = []
+      webview.addEventListener('page-favicon-updated', function (e) {
+        received.push(['page-favicon-updated', e.favicons])
+      })
+      webview.addEventListener('update-target-url', function (e) {
+        received.push(['update-target-url', e.url])
+      })
+      webview.addEventListener('console-message', function (e) {
+        if (e.message !== 'batch-end') return
+        assert.deepEqual(received, [
+          ['update-target-url', 'batch-b'],
+          ['page-favicon-updated', ['batch-c.ico']]
+        ])
+        assert.deepEqual(sentEvents(guestEvents.stop()), [[
+          dispatchChannel,
+          ['update-target-url', 'batch-b', 0, 0],
+          ['page-favicon-updated', ['batch-c.ico']],
+          ['console-message', 0, 'batch-end', 1, 'batch']
+        ]])
+        done()
+      })
+      load(function (guest) {
+        const sent = guestEvents.emit(guest, [
+          ['page-favicon-updated', ['batch-a.ico']],
+          ['update-target-url', 'batch-a', 0, 0],
+          ['page-favicon-updated', ['batch-b.ico']],
+          ['update-target-url', 'batch-b', 0, 0],
+          ['page-favicon-updated', ['batch-c.ico']],
+          ['console-message', 0, 'batch-end', 1, 'batch']
+        ])
+        // Nothing goes out before the flush
+        assert.deepEqual(sentEvents(sent), [])
+      })
+    })
+
+    it('flushes the queue for events handled right away', function (done) {
+      load(function (guest) {
+        const sent = guestEvents.emit(guest, [
+          ['update-target-url', 'batch-a', 0, 0],
+          ['leave-html-full-screen']
+        ])
+        // Sent before emit returns, without waiting for the flush
+        const [channel, events] = sent[sent.length - 1]
+        assert.equal(channel, dispatchChannel)
+        assert.deepEqual(events.slice(-2).map(([tabId, name]) => name),
+                         ['update-target-url', 'leave-html-full-screen'])
+        done()
+      })
+    })
+
+    it('sends ipc-message after the events queued before it', function (done) {
+      const received = []
+      webview.addEventListener('update-target-url', function (e) {
+        received.push(e.url)
+      })
+      webview.addEventListener('ipc-message', function (e) {
+        if (e.channel !== 'batch-channel') return
+        assert.deepEqual(received, ['batch-a'])
+        assert.deepEqual(sentEvents(guestEvents.stop()), [
+          [dispatchChannel, ['update-target-url', 'batch-a', 0, 0]],
+          [ipcChannel + webview.getId()]
+        ])
+        done()
+      })
+      load(function (guest) {
+        guestEvents.emit(guest, [
+          ['update-target-url', 'batch-a', 0, 0],
+          ['ipc-message-host', ['batch-channel', 'batch-ping']]
+        ])
+      })
+    })
+  })
+
   it('inherits the zoomFactor of the parent window', function (done) {
     w = new BrowserWindow({
       show: false,